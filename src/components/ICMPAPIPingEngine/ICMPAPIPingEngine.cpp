@@ -71,6 +71,7 @@ class Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngineData {
         Nedrysoft::Core::IPVersion m_ipVersion;
 
         QList<Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *> m_targetList;
+        QList<Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *> m_retiredTargets;
 
         int m_timeout;
         int m_interval;
@@ -85,6 +86,8 @@ Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngine::ICMPAPIPingEngine(Nedrysoft::Co
 Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngine::~ICMPAPIPingEngine() {
     doStop();
 
+    qDeleteAll(d->m_retiredTargets);
+
     d.reset();
 }
 
@@ -97,6 +100,10 @@ auto Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngine::addTarget(
 
     d->m_targetList.append(pingTarget);
 
+    if (d->m_transmitter) {
+        d->m_transmitter->addTarget(pingTarget);
+    }
+
     return(pingTarget);
 }
 
@@ -108,13 +115,31 @@ auto Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngine::addTarget(
 
     d->m_targetList.append(pingTarget);
 
+    if (d->m_transmitter) {
+        d->m_transmitter->addTarget(pingTarget);
+    }
+
     return(pingTarget);
 }
 
 auto Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingEngine::removeTarget(
         Nedrysoft::RouteAnalyser::IPingTarget *pingTarget) -> bool {
 
-    Q_UNUSED(pingTarget)
+    auto target = qobject_cast<Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *>(pingTarget);
+
+    if (!d->m_targetList.contains(target)) {
+        return false;
+    }
+
+    d->m_targetList.removeAll(target);
+
+    if (d->m_transmitter) {
+        d->m_transmitter->removeTarget(target);
+    }
+
+    // a ping worker may still be waiting for a reply for the target, so it is kept until the engine is destroyed.
+
+    d->m_retiredTargets.append(target);
 
     return true;
 }
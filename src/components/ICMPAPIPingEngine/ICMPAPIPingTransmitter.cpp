@@ -27,6 +27,7 @@
 #include "ICMPAPIPingTarget.h"
 #include "ICMPAPIPingWorker.h"
 
+#include <QMutexLocker>
 #include <QThread>
 #include <cstdint>
 
@@ -51,9 +52,19 @@ Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTransmitter::~ICMPAPIPingTransmitter()
 void Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTransmitter::addTarget(
         Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *target) {
 
+    QMutexLocker locker(&m_targetsMutex);
+
     m_targets.append(target);
 }
 
+auto Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTransmitter::removeTarget(
+        Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *target) -> void {
+
+    QMutexLocker locker(&m_targetsMutex);
+
+    m_targets.removeAll(target);
+}
+
 auto Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTransmitter::doWork() -> void {
     unsigned long sampleNumber = 0;
     QElapsedTimer timer;
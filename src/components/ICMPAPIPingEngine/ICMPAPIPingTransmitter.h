@@ -85,6 +85,15 @@ namespace Nedrysoft { namespace ICMPAPIPingEngine {
              */
             void addTarget(Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *target);
 
+            /**
+             * @brief       Removes a target so that it is no longer pinged.
+             *
+             * @note        A ping that is already in progress for the target still completes.
+             *
+             * @param[in]   target the target to remove.
+             */
+            auto removeTarget(Nedrysoft::ICMPAPIPingEngine::ICMPAPIPingTarget *target) -> void;
+
             friend class ICMPAPIPingEngine;
 
         private:
@@ -25,27 +25,38 @@
 
 #include "ICMPPingItem.h"
 #include "ICMPPingReceiverWorker.h"
+#include "ICMPPingRequestTable.h"
 #include "ICMPPingTarget.h"
-#include "ICMPPingTimeout.h"
+#include "ICMPPingTimerWheel.h"
 #include "ICMPPingTransmitter.h"
+#include "ICMPSocket/ICMPReceiveBatch.h"
 #include "ICMPSocket/ICMPSocket.h"
 #include "ICMPPacket/ICMPPacket.h"
 #include "Utils.h"
 
+#include <PingEngineStatisticsRecorder>
 #include <QElapsedTimer>
-#include <QMap>
 #include <QMutex>
-#include <QThread>
+#include <QTimer>
+#include <algorithm>
 #include <cstdint>
+#include <spdlog/spdlog.h>
+#include <vector>
 
 constexpr auto DefaultReceiveTimeout = 1000;
-constexpr auto DefaultTerminateThreadTimeout = 5000;
 constexpr auto DefaultTransmitInterval = 2500;
+constexpr auto DefaultSingleShotBatchSize = 8;
+constexpr auto DefaultResultsInterval = 50;
+constexpr auto RetiredTargetGracePeriod = 1000;
 
 constexpr auto SecondsToMs(double seconds) {
     return seconds*1000;
 }
 
+constexpr auto MsToNs(int milliseconds) -> int64_t {
+    return static_cast<int64_t>(milliseconds)*1000000;
+}
+
 /**
  * @brief       Private class to store the ping engines instance data.
  */
@@ -58,15 +69,15 @@ class Nedrysoft::ICMPPingEngine::ICMPPingEngineData {
          */
         ICMPPingEngineData(Nedrysoft::ICMPPingEngine::ICMPPingEngine *parent) :
                 m_pingEngine(parent),
-                m_transmitterWorker(nullptr),
-                m_timeoutWorker(nullptr),
-                m_transmitterThread(nullptr),
-                m_timeoutThread(nullptr),
+                m_isRunning(false),
                 m_timeout(DefaultReceiveTimeout),
                 m_epoch(QDateTime::currentDateTime()),
                 m_receiverWorker(nullptr),
                 m_interval(DefaultTransmitInterval) {
 
+            for (auto space = 0; space < Nedrysoft::ICMPPingEngine::ICMPPingTarget::SequenceSpaceCount; space++) {
+                m_freeSequenceSpaces.append(space);
+            }
         }
 
         friend class ICMPPingEngine;
@@ -75,26 +86,35 @@ class Nedrysoft::ICMPPingEngine::ICMPPingEngineData {
 
         Nedrysoft::ICMPPingEngine::ICMPPingEngine *m_pingEngine;
 
-        Nedrysoft::ICMPPingEngine::ICMPPingTransmitter *m_transmitterWorker;
-        Nedrysoft::ICMPPingEngine::ICMPPingTimeout *m_timeoutWorker;
+        bool m_isRunning;
 
-        QThread *m_transmitterThread;
-        QThread *m_timeoutThread;
+        Nedrysoft::ICMPPingEngine::ICMPPingRequestTable m_requests;
 
-        QMap<uint32_t, Nedrysoft::ICMPPingEngine::ICMPPingItem *> m_pingRequests;
-        QMutex m_requestsMutex;
+        Nedrysoft::RouteAnalyser::PingEngineStatisticsRecorder m_statistics;
+
+        QMutex m_resultsMutex;
+        Nedrysoft::RouteAnalyser::PingResultList m_pendingResults;
+        QTimer m_resultsTimer;
 
         QList<Nedrysoft::ICMPPingEngine::ICMPPingTarget *> m_targetList;
 
+        QList<QPair<Nedrysoft::ICMPPingEngine::ICMPPingTarget *, int64_t>> m_retiredTargets;
+
         int m_timeout;
 
         int m_interval;
 
+        QList<int> m_freeSequenceSpaces;
+
         QDateTime m_epoch;
 
         Nedrysoft::Core::IPVersion m_version;
 
         Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker *m_receiverWorker;
+
+        QList<uint16_t> m_identifiers;
+
+        std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket> m_datagramSocket;
 };
 
 Nedrysoft::ICMPPingEngine::ICMPPingEngine::ICMPPingEngine(Nedrysoft::Core::IPVersion version) :
@@ -102,190 +122,219 @@ Nedrysoft::ICMPPingEngine::ICMPPingEngine::ICMPPingEngine(Nedrysoft::Core::IPVer
 
     d->m_version = version;
 
-    qRegisterMetaType<QElapsedTimer>("QElapsedTimer");
+    // results are collected from the shared receiver and transmitter threads and delivered in batches from the thread
+    // that owns the engine, so consumers see one event per batch rather than one per result.
+
+    d->m_resultsTimer.setInterval(DefaultResultsInterval);
+
+    connect(&d->m_resultsTimer, &QTimer::timeout, this, &Nedrysoft::ICMPPingEngine::ICMPPingEngine::flushResults);
+
+    // prefer an unprivileged datagram socket, the kernel then routes replies to the engine by identifier.
+
+    if (Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable()) {
+        d->m_datagramSocket.reset(Nedrysoft::ICMPSocket::ICMPSocket::createDatagramSocket(
+            static_cast<Nedrysoft::ICMPSocket::IPVersion>(version)
+        ));
+    }
 }
 
 Nedrysoft::ICMPPingEngine::ICMPPingEngine::~ICMPPingEngine() {
     doStop();
 
+    qDeleteAll(d->m_targetList);
+
+    for (auto &retiredTarget : d->m_retiredTargets) {
+        delete retiredTarget.first;
+    }
+
     d.reset();
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::addTarget(
         QHostAddress hostAddress) -> Nedrysoft::RouteAnalyser::IPingTarget * {
 
-    auto target = new Nedrysoft::ICMPPingEngine::ICMPPingTarget(this, hostAddress);
-
-    d->m_transmitterWorker->addTarget(target);
-
-    return target;
+    return addTarget(hostAddress, 0);
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::addTarget(
         QHostAddress hostAddress,
         int ttl) -> Nedrysoft::RouteAnalyser::IPingTarget * {
 
+    // each target needs a block of sequence numbers to itself, a block is only reused once the target that had
+    // it has been deleted, so no request of the old target can be mistaken for one of the new target.
+
+    if (d->m_freeSequenceSpaces.isEmpty()) {
+        SPDLOG_WARN("Unable to add ping target for " + hostAddress.toString().toStdString() +
+                    ", the engine has no free sequence blocks.");
+
+        return nullptr;
+    }
+
     auto target = new Nedrysoft::ICMPPingEngine::ICMPPingTarget(this, hostAddress, ttl);
 
+    target->setSequenceSpace(d->m_freeSequenceSpaces.takeFirst());
+
     d->m_targetList.append(target);
 
+    // a running engine starts pinging the target from the next round of the transmitter.
+
+    if (d->m_isRunning) {
+        d->m_receiverWorker->addIdentifier(target->id(), this);
+
+        d->m_identifiers.append(target->id());
+
+        Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance()->addTarget(this, target);
+    }
+
     return target;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::removeTarget(Nedrysoft::RouteAnalyser::IPingTarget *target) -> bool {
-    Q_UNUSED(target)
+    auto pingTarget = qobject_cast<Nedrysoft::ICMPPingEngine::ICMPPingTarget *>(target);
 
-    return true;
-}
+    if ((!pingTarget) || (!d->m_targetList.removeOne(pingTarget))) {
+        return false;
+    }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::start() -> bool {
-    // timeout thread
+    if (d->m_isRunning) {
+        Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance()->removeTarget(this, pingTarget);
 
-    d->m_timeoutWorker = new Nedrysoft::ICMPPingEngine::ICMPPingTimeout(this);
+        d->m_receiverWorker->removeIdentifier(pingTarget->id(), this);
 
-    d->m_timeoutThread = new QThread();
+        d->m_identifiers.removeOne(pingTarget->id());
+    }
 
-    d->m_timeoutWorker->moveToThread(d->m_timeoutThread);
+    // the transmitter may be part way through a round that still pings the target and replies or timeouts may
+    // still be outstanding, so the target is retired rather than deleted.  Results for it are no longer
+    // delivered and it is deleted once every request it could have made has completed.
 
-    connect(d->m_timeoutThread, &QThread::started, d->m_timeoutWorker,
-            &Nedrysoft::ICMPPingEngine::ICMPPingTimeout::doWork);
+    auto retireTimestamp = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() +
+                           MsToNs(d->m_interval + d->m_timeout + RetiredTargetGracePeriod);
 
-    connect(d->m_timeoutWorker, &Nedrysoft::ICMPPingEngine::ICMPPingTimeout::result, this,
-            &Nedrysoft::ICMPPingEngine::ICMPPingEngine::result);
+    d->m_retiredTargets.append(qMakePair(pingTarget, retireTimestamp));
 
-    d->m_timeoutThread->start();
+    return true;
+}
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::start() -> bool {
     // connect to the receiver thread
 
     d->m_receiverWorker = Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::getInstance();
 
-    connect(d->m_receiverWorker,
-            &Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::packetReceived,
-            this,
-            &Nedrysoft::ICMPPingEngine::ICMPPingEngine::onPacketReceived,
-            Qt::DirectConnection
-    );
-
-    // transmitter thread
-
-    d->m_transmitterWorker = new Nedrysoft::ICMPPingEngine::ICMPPingTransmitter(this);
-
-    d->m_transmitterThread = new QThread();
-
-    d->m_transmitterWorker->moveToThread(d->m_transmitterThread);
+    if (d->m_datagramSocket) {
+        d->m_receiverWorker->addSocket(d->m_datagramSocket);
+    }
 
-    d->m_transmitterWorker->setInterval(d->m_interval);
+    // the receiver passes replies to the engine by identifier (and only replies to our targets should be passed up
+    // from the kernel), so register the identifiers before sending.
 
     for (auto target : d->m_targetList) {
-        d->m_transmitterWorker->addTarget(target);
+        d->m_receiverWorker->addIdentifier(target->id(), this);
+
+        d->m_identifiers.append(target->id());
     }
 
-    connect(d->m_transmitterThread, &QThread::started, d->m_transmitterWorker,
-            &Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::doWork);
+    // register with the transmitter thread, which is shared by every engine in the process.
 
-    connect(d->m_transmitterWorker, &Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::result, this,
-            &Nedrysoft::ICMPPingEngine::ICMPPingEngine::result);
+    d->m_resultsTimer.start();
 
-    d->m_transmitterThread->start();
+    Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance()->addEngine(
+        this,
+        d->m_interval,
+        std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTarget *>(d->m_targetList.begin(), d->m_targetList.end())
+    );
+
+    d->m_isRunning = true;
 
     return true;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::doStop() -> bool {
-    if (d->m_transmitterWorker) {
-        d->m_transmitterWorker->m_isRunning = false;
-    }
-
-    if (d->m_transmitterThread) {
-        d->m_transmitterThread->quit();
-    }
+    if (d->m_isRunning) {
+        // once removed, the shared transmitter will not send for (or call into) this engine again.
 
-    if (d->m_timeoutWorker) {
-        d->m_timeoutWorker->m_isRunning = false;
-    }
+        Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance()->removeEngine(this);
 
-    if (d->m_timeoutThread) {
-        d->m_timeoutThread->quit();
+        d->m_isRunning = false;
     }
 
-    if (d->m_transmitterThread) {
-        d->m_transmitterThread->wait(DefaultTerminateThreadTimeout);
+    // once its identifiers have been removed the receiver will not pass any further replies to the engine.
 
-        if (d->m_transmitterThread->isRunning()) {
-            d->m_transmitterThread->terminate();
+    if (d->m_receiverWorker) {
+        for (auto identifier : d->m_identifiers) {
+            d->m_receiverWorker->removeIdentifier(identifier, this);
         }
 
-        delete d->m_transmitterThread;
-
-        d->m_transmitterThread = nullptr;
-    }
-
-    if (d->m_timeoutThread) {
-        d->m_timeoutThread->wait(DefaultTerminateThreadTimeout);
-
-        if (d->m_timeoutThread->isRunning()) {
-            d->m_timeoutThread->terminate();
+        if (d->m_datagramSocket) {
+            d->m_receiverWorker->removeSocket(d->m_datagramSocket);
         }
 
-        delete d->m_timeoutThread;
-
-        d->m_timeoutThread = nullptr;
+        d->m_receiverWorker->timerWheel()->cancel(this);
     }
 
-    delete d->m_transmitterWorker;
-    delete d->m_timeoutWorker;
-
-    d->m_transmitterWorker = nullptr;
-    d->m_timeoutWorker = nullptr;
+    d->m_identifiers.clear();
 
-    for (auto request : d->m_pingRequests) {
-        delete request;
-    }
+    d->m_statistics.recordCancelled(d->m_requests.clear());
 
-    d->m_pingRequests.clear();
+    d->m_resultsTimer.stop();
 
     return true;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::stop() -> bool {
-    return doStop();
-}
+    auto stopped = doStop();
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::addRequest(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void {
-    QMutexLocker locker(&d->m_requestsMutex);
+    // deliver the results that completed before the engine was stopped.
 
-    auto id = Nedrysoft::Utils::fzMake32(pingItem->id(), pingItem->sequenceId());
+    flushResults();
 
-    d->m_pingRequests[id] = pingItem;
+    return stopped;
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::removeRequest(
-        Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem ) -> void {
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::datagramSocket() -> Nedrysoft::ICMPSocket::ICMPSocket * {
+    return d->m_datagramSocket.get();
+}
 
-    QMutexLocker locker(&d->m_requestsMutex);
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::acquireRequest() -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+    return d->m_requests.acquire();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::addRequest(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void {
+    auto previousItem = d->m_requests.insert(pingItem);
 
-    auto id = Nedrysoft::Utils::fzMake32(pingItem->id(), pingItem->sequenceId());
+    d->m_statistics.recordSent();
 
-    if (d->m_pingRequests.contains(id)) {
-        d->m_pingRequests.remove(id);
+    if (previousItem) {
+        // the sequence number has wrapped while the previous request was still outstanding.
 
-        delete pingItem;
+        expireItem(previousItem);
     }
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::getRequest(uint32_t id) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
-    QMutexLocker locker(&d->m_requestsMutex);
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::recordTransmitLag(int64_t lag) -> void {
+    d->m_statistics.recordTransmitLag(lag);
+}
 
-    if (d->m_pingRequests.contains(id)) {
-        return d->m_pingRequests[id];
-    }
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::releaseRequest(
+        Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem ) -> void {
 
-    return nullptr;
+    d->m_requests.release(pingItem);
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::takeRequest(
+        uint32_t id,
+        int generation) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+
+    return d->m_requests.take(id, generation);
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::setInterval(int interval) -> bool {
     d->m_interval = interval;
 
+    if (d->m_isRunning) {
+        Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance()->setInterval(this, interval);
+    }
+
     return true;
 }
 
@@ -295,44 +344,123 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::setTimeout(int timeout) -> bool
     return true;
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::timeoutRequests() -> void {
-    QMutexLocker locker(&d->m_requestsMutex);
-    QMutableMapIterator<uint32_t, Nedrysoft::ICMPPingEngine::ICMPPingItem *> i(d->m_pingRequests);
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::scheduleTimeout(
+        Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void {
 
-    while (i.hasNext()) {
-        i.next();
+    auto isFirstDue = d->m_receiverWorker->timerWheel()->schedule(
+        this,
+        Nedrysoft::Utils::fzMake32(pingItem->id(), pingItem->sequenceId()),
+        pingItem->monotonicTimestamp() + MsToNs(d->m_timeout)
+    );
 
-        auto pingItem = i.value();
+    // the receiver waits until the first deadline, so it is woken if this request is due before it.
 
-        auto elapsedTime = pingItem->elapsedTime();
+    if (isFirstDue) {
+        d->m_receiverWorker->wake();
+    }
+}
 
-        if (elapsedTime > d->m_timeout/1000.0) {
-            if (pingItem->lock()) {
-                if (!pingItem->serviced()) {
-                    QHostAddress hostAddress;
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::expireRequest(uint32_t id) -> int {
+    auto timeoutTimestamp = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() - MsToNs(d->m_timeout);
+    int64_t pendingTimestamp;
 
-                    pingItem->setServiced(true);
+    auto pingItem = d->m_requests.takeIfSentBefore(id, timeoutTimestamp, &pendingTimestamp);
 
-                    Nedrysoft::RouteAnalyser::PingResult pingResult(
-                            pingItem->sampleNumber(),
-                            Nedrysoft::RouteAnalyser::PingResult::ResultCode::NoReply,
-                            hostAddress,
-                            pingItem->transmitEpoch(),
-                            pingItem->elapsedTime()/1e9,
-                            pingItem->target(),
-                            -1);
+    if (pingItem) {
+        expireItem(pingItem);
 
-                    Q_EMIT result(pingResult);
-                }
+        return 0;
+    }
 
-                i.remove();
+    if (!pendingTimestamp) {
+        return 0;
+    }
+
+    // the timeout fired before the engine timeout had elapsed, the remainder is rounded up so that the request is
+    // due when it is next checked.
+
+    return static_cast<int>(std::max(
+        (pendingTimestamp - timeoutTimestamp + MsToNs(1) - 1) / MsToNs(1),
+        static_cast<int64_t>(1)
+    ));
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::expireItem(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void {
+    QHostAddress hostAddress;
+
+    Nedrysoft::RouteAnalyser::PingResult pingResult(
+            pingItem->sampleNumber(),
+            Nedrysoft::RouteAnalyser::PingResult::ResultCode::NoReply,
+            hostAddress,
+            pingItem->transmitEpoch(),
+            pingItem->elapsedTime()/1e9,
+            pingItem->target(),
+            -1);
+
+    d->m_statistics.recordTimeout();
+
+    d->m_requests.release(pingItem);
+
+    queueResult(pingResult);
+}
 
-                pingItem->unlock();
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::queueResult(
+        const Nedrysoft::RouteAnalyser::PingResult &pingResult) -> void {
+
+    QMutexLocker locker(&d->m_resultsMutex);
+
+    d->m_pendingResults.append(pingResult);
+}
+
+void Nedrysoft::ICMPPingEngine::ICMPPingEngine::flushResults() {
+    Nedrysoft::RouteAnalyser::PingResultList pingResults;
+
+    d->m_resultsMutex.lock();
+
+    pingResults.swap(d->m_pendingResults);
+
+    d->m_resultsMutex.unlock();
+
+    if (!d->m_retiredTargets.isEmpty()) {
+        auto isRetired = [this](Nedrysoft::RouteAnalyser::PingResult &pingResult) {
+            for (auto &retiredTarget : d->m_retiredTargets) {
+                if (pingResult.target() == retiredTarget.first) {
+                    return true;
+                }
             }
+
+            return false;
+        };
+
+        pingResults.erase(std::remove_if(pingResults.begin(), pingResults.end(), isRetired), pingResults.end());
+    }
+
+    if (!pingResults.isEmpty()) {
+        Q_EMIT results(pingResults);
+    }
+
+    // retired targets are deleted once their grace period has passed, any result that arrived for them before
+    // then has been discarded above.
+
+    auto currentTimestamp = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+
+    for (auto targetIndex = d->m_retiredTargets.count() - 1; targetIndex >= 0; targetIndex--) {
+        if (d->m_retiredTargets[targetIndex].second < currentTimestamp) {
+            auto retiredTarget = d->m_retiredTargets[targetIndex].first;
+
+            d->m_freeSequenceSpaces.append(retiredTarget->sequenceSpace());
+
+            delete retiredTarget;
+
+            d->m_retiredTargets.removeAt(targetIndex);
         }
     }
 }
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::timeout() -> int {
+    return d->m_timeout;
+}
+
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::saveConfiguration() -> QJsonObject {
     return QJsonObject();
 }
@@ -355,65 +483,86 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::version() -> Nedrysoft::Core::IP
     return d->m_version;
 }
 
-void Nedrysoft::ICMPPingEngine::ICMPPingEngine::onPacketReceived(
-        QElapsedTimer receiveTimer,
-        QByteArray receiveBuffer,
-        QHostAddress receiveAddress ) {
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::processReply(
+        const Nedrysoft::ICMPSocket::ICMPReceiveBatch &receiveBatch,
+        int packetIndex,
+        const Nedrysoft::ICMPPacket::ICMPParseResult &parseResult) -> void {
 
     Nedrysoft::RouteAnalyser::PingResult::ResultCode resultCode =
         Nedrysoft::RouteAnalyser::PingResult::ResultCode::NoReply;
 
-    auto responsePacket = Nedrysoft::ICMPPacket::ICMPPacket::fromData(
-        receiveBuffer,
-        static_cast<Nedrysoft::ICMPPacket::IPVersion>(this->version())
-    );
-
-    if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::Invalid) {
-        return;
-    }
-
-    if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::EchoReply) {
+    if (parseResult.resultCode == Nedrysoft::ICMPPacket::EchoReply) {
         resultCode = Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok;
     }
 
-    if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::TimeExceeded) {
+    if (parseResult.resultCode == Nedrysoft::ICMPPacket::TimeExceeded) {
         resultCode = Nedrysoft::RouteAnalyser::PingResult::ResultCode::TimeExceeded;
     }
 
-    auto pingItem = this->getRequest(Nedrysoft::Utils::fzMake32(responsePacket.id(), responsePacket.sequence()));
-
-    if (pingItem) {
-        auto elapsedTime = pingItem->elapsedTime();
+    // the request is retired by taking it out of the table, if a timeout got there first then it is
+    // no longer present and the reply is ignored.  The generation is only checked when the payload of the
+    // request was returned, a router may quote no more than the ICMP header.
 
-        pingItem->lock();
+    auto generation = Nedrysoft::ICMPPacket::ICMPPacket::payloadTag(
+        receiveBatch.data(packetIndex),
+        parseResult
+    );
 
-        if (!pingItem->serviced()) {
+    auto requestId = Nedrysoft::Utils::fzMake32(parseResult.id, parseResult.sequence);
 
-            auto pingResult = Nedrysoft::RouteAnalyser::PingResult(
-                pingItem->sampleNumber(),
-                resultCode,
-                receiveAddress,
-                pingItem->transmitEpoch(),
-                elapsedTime,
-                pingItem->target(),
-                -1
-            );
+    auto pingItem = takeRequest(requestId, generation);
 
-            pingItem->setServiced(true);
+    if (!pingItem) {
+        // the slot remembers how its last request was retired, which tells a second reply to an answered request
+        // apart from one that arrived after the request had timed out (or was sent from an older generation).
 
-            pingItem->unlock();
+        switch (d->m_requests.retiredState(requestId)) {
+            case Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::Answered: {
+                d->m_statistics.recordDuplicate();
+                break;
+            }
 
-            Q_EMIT Nedrysoft::ICMPPingEngine::ICMPPingEngine::result(pingResult);
+            case Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::Expired:
+            case Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::Outstanding: {
+                d->m_statistics.recordLate();
+                break;
+            }
 
-            removeRequest(pingItem);
-        } else {
-            pingItem->unlock();
+            default: {
+                break;
+            }
         }
+
+        return;
     }
+
+    auto pingResult = Nedrysoft::RouteAnalyser::PingResult(
+        pingItem->sampleNumber(),
+        resultCode,
+        receiveBatch.hostAddress(packetIndex),
+        pingItem->transmitEpoch(),
+        pingItem->roundTripTime(receiveBatch.timestamp(packetIndex)),
+        pingItem->target(),
+        -1
+    );
+
+    d->m_statistics.recordReply(pingResult.roundTripTime());
+
+    releaseRequest(pingItem);
+
+    queueResult(pingResult);
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::statistics() -> Nedrysoft::RouteAnalyser::PingEngineStatistics {
+    return d->m_statistics.statistics();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::resetStatistics() -> void {
+    d->m_statistics.reset();
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::interval() -> int {
-    return d->m_transmitterWorker->interval();
+    return d->m_interval;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::targets() -> QList<Nedrysoft::RouteAnalyser::IPingTarget *> {
@@ -431,30 +580,48 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::singleShot(
         int ttl,
         double timeout ) -> Nedrysoft::RouteAnalyser::PingResult {
 
-    Nedrysoft::ICMPSocket::ICMPSocket *writeSocket;
-    Nedrysoft::ICMPSocket::ICMPSocket *readSocket;
+    Nedrysoft::ICMPSocket::ICMPSocket *writeSocket = nullptr;
+    Nedrysoft::ICMPSocket::ICMPSocket *readSocket = nullptr;
 
     Nedrysoft::RouteAnalyser::PingResult pingResult;
 
-    if (hostAddress.protocol() == QAbstractSocket::IPv4Protocol) {
-        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(ttl, Nedrysoft::ICMPSocket::V4);
-    } else if (hostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
-        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(ttl, Nedrysoft::ICMPSocket::V6);
+    auto socketVersion = Nedrysoft::ICMPSocket::V4;
+
+    if (hostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
+        socketVersion = Nedrysoft::ICMPSocket::V6;
+    }
+
+    // a datagram socket sends the request and receives the reply (or error) for its own identifier.
+
+    if (Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable()) {
+        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createDatagramSocket(socketVersion);
+        readSocket = writeSocket;
     }
 
-    if (hostAddress.protocol() == QAbstractSocket::IPv4Protocol) {
-        readSocket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
-    } else if (hostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
-        readSocket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V6);
+    if (!writeSocket) {
+        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(ttl, socketVersion);
+        readSocket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(socketVersion);
     }
 
-    QByteArray receiveBuffer;
+    if ((!writeSocket) || (!readSocket)) {
+        if (readSocket != writeSocket) {
+            delete readSocket;
+        }
+
+        delete writeSocket;
+
+        return pingResult;
+    }
 
     // TODO: fix
 
     int id = 6666;
     int sequenceId = 5555 + ttl;
 
+    if (writeSocket->isDatagram()) {
+        id = writeSocket->identifier();
+    }
+
     auto buffer = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
         id,
         sequenceId,
@@ -463,76 +630,82 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngine::singleShot(
         static_cast<Nedrysoft::ICMPPacket::IPVersion>(version())
     );
 
+    std::vector<Nedrysoft::ICMPSocket::ICMPMessage> messages = {
+        {buffer.constData(), buffer.length(), hostAddress, ttl, -1}
+    };
+
     auto transmitEpoch = QDateTime::currentDateTime();
+    auto transmitTimestamp = Nedrysoft::ICMPSocket::ICMPSocket::timestamp();
 
-    writeSocket->sendto(buffer, hostAddress);
+    writeSocket->sendBatch(messages);
 
-    QHostAddress receiveAddress;
+    Nedrysoft::ICMPSocket::ICMPReceiveBatch receiveBatch(DefaultSingleShotBatchSize);
 
     QElapsedTimer timer;
 
     timer.start();
 
-    while(timer.elapsed()<(SecondsToMs(timeout))) {
-        auto remaining = DefaultReceiveTimeout-timer.elapsed();
+    auto replyReceived = false;
+
+    while ((!replyReceived) && (timer.elapsed() < SecondsToMs(timeout))) {
+        auto remaining = static_cast<int>(SecondsToMs(timeout) - timer.elapsed());
 
-        if (remaining<=0) {
-            return pingResult;
+        if (remaining <= 0) {
+            break;
         }
 
-        if (readSocket->recvfrom(receiveBuffer, receiveAddress, remaining)) {
-            auto responseTime = QDateTime::currentDateTime();
-            auto roundTripTime = timer.nsecsElapsed();
+        auto packetCount = readSocket->recvBatch(receiveBatch, remaining);
 
+        for (auto packetIndex = 0; packetIndex < packetCount; packetIndex++) {
             Nedrysoft::RouteAnalyser::PingResult::ResultCode resultCode;
 
-            if (!receiveBuffer.length()) {
-                continue;
-            }
-
-            auto responsePacket = Nedrysoft::ICMPPacket::ICMPPacket::fromData(
-                receiveBuffer,
+            auto responsePacket = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+                receiveBatch.data(packetIndex),
+                receiveBatch.length(packetIndex),
                 static_cast<Nedrysoft::ICMPPacket::IPVersion>(this->version())
             );
 
-            if ((responsePacket.id()!=id) || (responsePacket.sequence()!=sequenceId)) {
+            if ((responsePacket.id != id) || (responsePacket.sequence != sequenceId)) {
                 continue;
             }
 
-            if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::Invalid) {
+            if (responsePacket.resultCode == Nedrysoft::ICMPPacket::Invalid) {
                 continue;
             }
 
-            if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::EchoReply) {
+            if (responsePacket.resultCode == Nedrysoft::ICMPPacket::EchoReply) {
                 resultCode = Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok;
-            }
-
-            if (responsePacket.resultCode() == Nedrysoft::ICMPPacket::TimeExceeded) {
+            } else {
                 resultCode = Nedrysoft::RouteAnalyser::PingResult::ResultCode::TimeExceeded;
             }
 
             int hopsToTarget = -1;
 
-            if (responsePacket.ttl()!=-1) {
-                hopsToTarget = ttl-responsePacket.ttl();
+            if (responsePacket.ttl != -1) {
+                hopsToTarget = ttl - responsePacket.ttl;
             }
 
             pingResult = Nedrysoft::RouteAnalyser::PingResult(
                 0,
                 resultCode,
-                receiveAddress,
+                receiveBatch.hostAddress(packetIndex),
                 transmitEpoch,
-                roundTripTime/1e9,
+                static_cast<double>(receiveBatch.timestamp(packetIndex) - transmitTimestamp) / 1e9,
                 nullptr,
                 hopsToTarget
             );
 
+            replyReceived = true;
+
             break;
         }
     }
 
+    if (readSocket != writeSocket) {
+        delete readSocket;
+    }
+
     delete writeSocket;
-    delete readSocket;
 
     return pingResult;
 }
\ No newline at end of file
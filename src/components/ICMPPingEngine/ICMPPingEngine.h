@@ -27,10 +27,20 @@
 #include <IInterface>
 #include <IPingEngine>
 #include <IPingEngineFactory>
+#include <IPingEngineStatistics>
 #include <QElapsedTimer>
 #include <QDateTime>
 #include <memory>
 
+namespace Nedrysoft { namespace ICMPPacket {
+    struct ICMPParseResult;
+}}
+
+namespace Nedrysoft { namespace ICMPSocket {
+    class ICMPReceiveBatch;
+    class ICMPSocket;
+}}
+
 namespace Nedrysoft { namespace ICMPPingEngine {
     class ICMPPingEngineData;
     class ICMPPingTransitter;
@@ -40,12 +50,14 @@ namespace Nedrysoft { namespace ICMPPingEngine {
      * @brief       THe ICMPPingEngine provides a ICMP socket ping engine implementation.
      */
     class ICMPPingEngine :
-            public Nedrysoft::RouteAnalyser::IPingEngine {
+            public Nedrysoft::RouteAnalyser::IPingEngine,
+            public Nedrysoft::RouteAnalyser::IPingEngineStatistics {
 
         private:
             Q_OBJECT
 
             Q_INTERFACES(Nedrysoft::RouteAnalyser::IPingEngine)
+            Q_INTERFACES(Nedrysoft::RouteAnalyser::IPingEngineStatistics)
 
         public:
             /**
@@ -114,7 +126,8 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              *
              * @param[in]   hostAddress the host address of the ping target.
              *
-             * @returns     returns a pointer to the created ping target.
+             * @returns     returns a pointer to the created ping target; or nullptr if the engine already has the
+             *              maximum number of targets.
              */
             auto addTarget(QHostAddress hostAddress) -> Nedrysoft::RouteAnalyser::IPingTarget * override;
 
@@ -126,7 +139,8 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              * @param[in]   hostAddress the host address of the ping target.
              * @param[in]   ttl the time to live to use.
              *
-             * @returns     returns a pointer to the created ping target.
+             * @returns     returns a pointer to the created ping target; or nullptr if the engine already has the
+             *              maximum number of targets.
              */
             auto addTarget(QHostAddress hostAddress, int ttl) -> Nedrysoft::RouteAnalyser::IPingTarget * override;
 
@@ -174,6 +188,23 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             auto targets() -> QList<Nedrysoft::RouteAnalyser::IPingTarget *> override;
 
+        public:
+            /**
+             * @brief       Returns a snapshot of the statistics of the engine.
+             *
+             * @see         Nedrysoft::RouteAnalyser::IPingEngineStatistics::statistics
+             *
+             * @returns     the statistics.
+             */
+            auto statistics() -> Nedrysoft::RouteAnalyser::PingEngineStatistics override;
+
+            /**
+             * @brief       Resets the counters and histograms of the engine.
+             *
+             * @see         Nedrysoft::RouteAnalyser::IPingEngineStatistics::resetStatistics
+             */
+            auto resetStatistics() -> void override;
+
         public:
             /**
              * @brief       Saves the configuration to a JSON object.
@@ -197,30 +228,93 @@ namespace Nedrysoft { namespace ICMPPingEngine {
 
         private:
             /**
-             * @brief       Called when a ICMP packet is available for processing.
+             * @brief       Emits the results that have been queued since the last call as a single batch.
              *
-             * @param[in]   receiveTimer a timer started when the packet was received.
-             * @param[in]   receiveBuffer the actual packet data.
-             * @param[in]   receiveAddress the IP address that the response came from (may be different to target).
+             * @note        Called periodically by a timer in the thread that owns the engine.
              */
-            Q_SLOT void onPacketReceived(
-                QElapsedTimer receiveTimer,
-                QByteArray receiveBuffer,
-                QHostAddress receiveAddress
-            );
+            Q_SLOT void flushResults();
 
         protected:
             /**
-             * @brief       Checks for any timed out requests and removes and signals that a timeout occurred.
+             * @brief       Processes a reply that carries an identifier registered by this engine.
              *
-             * @see         Nedrysoft::ICMPPingEngine::ICMPPingTimeout
+             * @details     Called by the receiver thread, which has already decoded the packet, the reply is matched
+             *              against the outstanding requests of the engine and ignored if there is none.
+             *
+             * @note        The batch is owned by the receiver thread and is reused for the next read.
+             *
+             * @param[in]   receiveBatch the batch that the packet was read into.
+             * @param[in]   packetIndex the index of the packet in the batch.
+             * @param[in]   parseResult the decoded packet.
+             */
+            auto processReply(
+                const Nedrysoft::ICMPSocket::ICMPReceiveBatch &receiveBatch,
+                int packetIndex,
+                const Nedrysoft::ICMPPacket::ICMPParseResult &parseResult
+            ) -> void;
+
+            /**
+             * @brief       Queues a result to be delivered in the next batch.
+             *
+             * @note        May be called from any thread.
+             *
+             * @param[in]   pingResult the result.
              */
-            auto timeoutRequests(void) -> void;
+            auto queueResult(const Nedrysoft::RouteAnalyser::PingResult &pingResult) -> void;
+
+            /**
+             * @brief       Schedules the expiry of a request that has been sent.
+             *
+             * @details     The request is expired by the timer wheel of the receiver thread once the engine
+             *              timeout has elapsed from its monotonic transmit time.
+             *
+             * @see         Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel
+             *
+             * @param[in]   pingItem the request.
+             */
+            auto scheduleTimeout(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
+
+            /**
+             * @brief       Signals a timeout for a single request if it has not been answered.
+             *
+             * @details     Called by the timer wheel, or by the transmitter when it tracks reply expiry with kernel
+             *              timeouts.  A request is only expired once the engine timeout has elapsed, so a stale
+             *              timeout for a reused sequence number is ignored.
+             *
+             * @param[in]   id the id of the request, constructed in the same manner as for takeRequest.
+             *
+             * @returns     the time in milliseconds until the request is due to expire if it is still outstanding
+             *              but its timeout has not yet elapsed; otherwise 0.
+             */
+            auto expireRequest(uint32_t id) -> int;
+
+            /**
+             * @brief       Returns the reply timeout.
+             *
+             * @returns     the timeout in milliseconds.
+             */
+            auto timeout() -> int;
+
+            /**
+             * @brief       Signals a timeout for a retired request and returns it to the pool.
+             *
+             * @param[in]   pingItem the retired request.
+             */
+            auto expireItem(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
+
+            /**
+             * @brief       Returns an unused request item from the pool of the engine.
+             *
+             * @note        Must only be called from the transmitter thread.
+             *
+             * @returns     the item; otherwise nullptr if the pool is exhausted.
+             */
+            auto acquireRequest() -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
 
             /**
              * @brief       Adds a ping request to the engine so it can be tracked.
              *
-             * @details     Adds a ping request to the list of requests, the engine maintains a list of currently
+             * @details     Adds a ping request to the table of requests, the engine maintains a table of currently
              *              active requests and uses these to correlate responses and handle timeouts.
              *
              * @param[in]   pingItem the item being tracked.
@@ -228,17 +322,21 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             auto addRequest(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
 
             /**
-             * @brief       Removes a tracked request and deletes the item.
+             * @brief       Records how far behind its schedule the transmitter sent a request.
              *
-             * @details     Removes a tracked request and deletes the item, when a ping response (either an echo reply
-             *              or ttl exceeded) is received the request can be removed from the engine.
+             * @param[in]   lag the lag in nanoseconds.
+             */
+            auto recordTransmitLag(int64_t lag) -> void;
+
+            /**
+             * @brief       Returns a retired request item to the pool.
              *
-             * @param[in]   pingItem is the item to be removed.
+             * @param[in]   pingItem the item that was returned by takeRequest.
              */
-            auto removeRequest(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
+            auto releaseRequest(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
 
             /**
-             * @brief       Returns a tracked request by id.
+             * @brief       Retires a tracked request by id.
              *
              * @details     Finds the request by the id that was received in the packet, as the engine needs to
              *              figure out which response relates to a request to figure out the round trip time it uses
@@ -246,11 +344,14 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              *
              *                  (icmp_id<<16) | icmp_sequence_id
              *
+             *              The request is removed from the table, so only one caller can retire it.
+             *
              * @param[in]   id is the request to find.
+             * @param[in]   generation the generation carried in the payload of the reply; or -1 if it was not present.
              *
-             * @returns     returns the request if found; nullptr otherwise.
+             * @returns     returns the request if found, which must be passed to releaseRequest; nullptr otherwise.
              */
-            auto getRequest(uint32_t id) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+            auto takeRequest(uint32_t id, int generation = -1) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
 
             /**
              * @brief       Sets the transmission epoch.
@@ -283,8 +384,20 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             auto doStop() -> bool;
 
+            /**
+             * @brief       Returns the unprivileged datagram socket used by this engine.
+             *
+             * @details     When the process is allowed to create datagram ICMP sockets each engine owns one, the
+             *              kernel stamps every request sent from it with the identifier of the socket and only
+             *              delivers the matching replies, so all targets of the engine share that identifier.
+             *
+             * @returns     the datagram socket; otherwise nullptr if the engine uses the shared raw sockets.
+             */
+            auto datagramSocket() -> Nedrysoft::ICMPSocket::ICMPSocket *;
+
+            friend class ICMPPingTarget;
             friend class ICMPPingTransmitter;
-            friend class ICMPPingTimeout;
+            friend class ICMPPingTimerWheel;
             friend class ICMPPingReceiverWorker;
 
         protected:
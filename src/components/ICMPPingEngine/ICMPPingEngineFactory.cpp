@@ -24,6 +24,7 @@
 #include "ICMPPingEngineFactory.h"
 #include "ICMPPingEngine.h"
 #include "ICMPPingReceiverWorker.h"
+#include "ICMPPingTransmitter.h"
 
 /**
  * @brief       Private class to store the ping engines instance data.
@@ -62,6 +63,14 @@ Nedrysoft::ICMPPingEngine::ICMPPingEngineFactory::~ICMPPingEngineFactory() {
         delete receiverWorker;
     }
 
+    auto transmitter = Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance(true);
+
+    if (transmitter) {
+        delete transmitter;
+    }
+
+    Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::releaseSockets();
+
     d.reset();
 }
 
@@ -91,6 +100,12 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngineFactory::description() -> QString
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngineFactory::priority() -> double {
 #if defined(Q_OS_LINUX)
+    // either unprivileged datagram sockets or raw sockets (root or CAP_NET_RAW) are required.
+
+    if (Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable()) {
+        return 1;
+    }
+
     auto socket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
 
     if (socket) {
@@ -106,6 +121,12 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingEngineFactory::priority() -> double {
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingEngineFactory::available() -> bool {
 #if defined(Q_OS_LINUX)
+    // either unprivileged datagram sockets or raw sockets (root or CAP_NET_RAW) are required.
+
+    if (Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable()) {
+        return true;
+    }
+
     auto socket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
 
     if (socket) {
@@ -26,11 +26,14 @@
 #include <QTimer>
 
 Nedrysoft::ICMPPingEngine::ICMPPingItem::ICMPPingItem() :
+        m_transmitTimestamp(0),
+        m_monotonicTimestamp(0),
         m_id(0),
         m_sequenceId(0),
-        m_serviced(false),
+        m_generation(0),
         m_target(nullptr),
-        m_sampleNumber(0) {
+        m_sampleNumber(0),
+        m_poolIndex(0) {
 
 }
 
@@ -50,6 +53,14 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingItem::sequenceId() -> uint16_t {
     return m_sequenceId;
 }
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::setGeneration(uint16_t generation) -> void {
+    m_generation = generation;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::generation() -> uint16_t {
+    return m_generation;
+}
+
 auto Nedrysoft::ICMPPingEngine::ICMPPingItem::startTimer() -> void {
     m_elapsedTimer.restart();
     m_transmitEpoch = QDateTime::currentDateTime();
@@ -59,14 +70,6 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingItem::stopTimer() -> void {
     m_elapsedTime = m_elapsedTimer.nsecsElapsed();
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingItem::setServiced(bool serviced) -> void {
-    m_serviced = serviced;
-}
-
-auto Nedrysoft::ICMPPingEngine::ICMPPingItem::serviced() -> bool {
-    return m_serviced;
-}
-
 auto Nedrysoft::ICMPPingEngine::ICMPPingItem::id() -> uint16_t {
     return m_id;
 }
@@ -83,6 +86,32 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingItem::elapsedTime() -> double {
     return static_cast<double>(m_elapsedTimer.nsecsElapsed())/static_cast<double>(1e9);
 }
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::setTransmitTimestamp(int64_t timestamp) -> void {
+    m_transmitTimestamp = timestamp;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::transmitTimestamp() -> int64_t {
+    return m_transmitTimestamp;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::setMonotonicTimestamp(int64_t timestamp) -> void {
+    m_monotonicTimestamp = timestamp;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::monotonicTimestamp() -> int64_t {
+    return m_monotonicTimestamp;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingItem::roundTripTime(int64_t receiveTimestamp) -> double {
+    int64_t transmitTimestamp = m_transmitTimestamp;
+
+    if ((!transmitTimestamp) || (!receiveTimestamp) || (receiveTimestamp < transmitTimestamp)) {
+        return elapsedTime();
+    }
+
+    return static_cast<double>(receiveTimestamp - transmitTimestamp) / static_cast<double>(1e9);
+}
+
 auto Nedrysoft::ICMPPingEngine::ICMPPingItem::transmitEpoch() -> QDateTime {
     return m_transmitEpoch;
 }
@@ -94,11 +123,3 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingItem::setSampleNumber(unsigned long samp
 auto Nedrysoft::ICMPPingEngine::ICMPPingItem::sampleNumber() -> unsigned long {
     return m_sampleNumber;
 }
-
-auto Nedrysoft::ICMPPingEngine::ICMPPingItem::lock() -> bool {
-    return m_mutex.tryLock();
-}
-
-auto Nedrysoft::ICMPPingEngine::ICMPPingItem::unlock() -> void {
-    m_mutex.unlock();
-}
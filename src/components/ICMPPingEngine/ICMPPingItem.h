@@ -26,8 +26,9 @@
 
 #include <QDateTime>
 #include <QElapsedTimer>
-#include <QMutex>
 #include <QObject>
+#include <atomic>
+#include <cstdint>
 
 namespace Nedrysoft { namespace ICMPPingEngine {
     class ICMPPingTarget;
@@ -85,21 +86,18 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             auto sequenceId() -> uint16_t;
 
             /**
-             * @brief       Set whether this request has been serviced.
+             * @brief       Sets the generation of the sequence space that the sequence id was drawn from.
              *
-             * @details     Marks the request as being serviced, prevents a packet being flagged as both replied to
-             *              and timeout in race condition situations.
-             *
-             * @param[in]   serviced true if serviced; otherwise false.
+             * @param[in]   generation the generation.
              */
-            auto setServiced(bool serviced) -> void;
+            auto setGeneration(uint16_t generation) -> void;
 
             /**
-             * @brief       Returns the serviced status of the request.
+             * @brief       Returns the generation of the sequence space that the sequence id was drawn from.
              *
-             * @returns     true if request has been serviced; otherwise false.
+             * @returns     the generation.
              */
-            auto serviced() -> bool;
+            auto generation() -> uint16_t;
 
             /**
              * @brief       Sets the sample number for this request.
@@ -145,35 +143,66 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             /**
              * @brief       Returns the current time elapsed from transmission.
              *
-             * @returns     the time in milliseconds.
+             * @returns     the time in seconds.
              */
             auto elapsedTime(void) -> double;
 
             /**
-             * @brief       Returns the the round trip time from the request to response.
+             * @brief       Sets the time at which the request was handed to the socket.
              *
-             * @returns     the time in seconds.
+             * @see         Nedrysoft::ICMPSocket::ICMPSocket::timestamp
+             *
+             * @param[in]   timestamp the transmit timestamp in nanoseconds.
              */
-            auto roundTripTime() -> double;
+            auto setTransmitTimestamp(int64_t timestamp) -> void;
 
             /**
-             * @brief       Returns the epoch at which the request was transmitted.
+             * @brief       Returns the time at which the request was handed to the socket.
              *
-             * @returns     the epoch when the request was sent.
+             * @returns     the transmit timestamp in nanoseconds; or 0 if the request has not been sent.
              */
-            auto transmitEpoch() -> QDateTime;
+            auto transmitTimestamp() -> int64_t;
+
+            /**
+             * @brief       Sets the time at which the request was handed to the socket on the monotonic clock.
+             *
+             * @details     The timeout of a request is measured from this time rather than from the transmit
+             *              timestamp, so a change to the wall clock cannot expire requests early or hold them back.
+             *
+             * @see         Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp
+             *
+             * @param[in]   timestamp the monotonic transmit time in nanoseconds.
+             */
+            auto setMonotonicTimestamp(int64_t timestamp) -> void;
 
             /**
-             * @brief       Locks the item for exclusive access.
+             * @brief       Returns the time at which the request was handed to the socket on the monotonic clock.
              *
-             * @returns     returns true if the item was locked; otherwise false.
+             * @returns     the monotonic transmit time in nanoseconds; or 0 if the request has not been sent.
              */
-            auto lock(void) -> bool;
+            auto monotonicTimestamp() -> int64_t;
 
             /**
-             * @brief       Unlocks the item that was previous locked.
+             * @brief       Returns the the round trip time from the request to response.
+             *
+             * @details     The round trip time is calculated from the transmit timestamp and the receive timestamp
+             *              of the response so that any delay in processing the response is not included, if either
+             *              timestamp is unavailable then the time elapsed since transmission is used instead.
+             *
+             * @param[in]   receiveTimestamp the time the response was received in nanoseconds.
+             *
+             * @returns     the time in seconds.
+             */
+            auto roundTripTime(int64_t receiveTimestamp) -> double;
+
+            /**
+             * @brief       Returns the epoch at which the request was transmitted.
+             *
+             * @returns     the epoch when the request was sent.
              */
-            auto unlock(void) -> void;
+            auto transmitEpoch() -> QDateTime;
+
+            friend class ICMPPingRequestTable;
 
         private:
             //! @cond
@@ -182,17 +211,18 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             QDateTime m_transmitEpoch;
 
             int64_t m_elapsedTime;
+            std::atomic<int64_t> m_transmitTimestamp;
+            std::atomic<int64_t> m_monotonicTimestamp;
 
             uint16_t m_id;
             uint16_t m_sequenceId;
-
-            bool m_serviced;
+            uint16_t m_generation;
 
             Nedrysoft::ICMPPingEngine::ICMPPingTarget *m_target;
 
             unsigned long m_sampleNumber;
 
-            QMutex m_mutex;
+            uint32_t m_poolIndex;
 
             //! @endcond
     };
@@ -27,20 +27,35 @@
 #include "ICMPPingEngine.h"
 #include "ICMPPingItem.h"
 #include "ICMPPingTarget.h"
+#include "ICMPSocket/ICMPReceiveBatch.h"
+#include "ICMPSocket/ICMPRing.h"
 #include "ICMPSocket/ICMPSocket.h"
+#include "ICMPSocket/ICMPSocketSet.h"
 
+#include <ICore>
 #include <QHostAddress>
+#include <QMutexLocker>
 #include <QThread>
 #include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <spdlog/spdlog.h>
+#include <vector>
 
-constexpr auto DefaultReplyTimeout = 1000;
+constexpr auto DefaultReplyTimeout = 100;
+constexpr auto DefaultReceiveBatchSize = 64;
 
 Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::ICMPPingReceiverWorker() :
         m_engine(nullptr),
         m_receiveWorker(nullptr),
         m_receiverThread(nullptr),
-        m_socket(nullptr),
+        m_socketV4(nullptr),
+        m_socketV6(nullptr),
+        m_routes(std::make_shared<const RouteTable>()),
+        m_timerWheel([](Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine, uint32_t id) {
+            engine->expireRequest(id);
+        }),
         m_isRunning(false) {
 
 }
@@ -53,65 +68,422 @@ Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::~ICMPPingReceiverWorker() {
     if (m_receiveWorker) {
         m_receiveWorker->m_isRunning = false;
 
+        wake();
+
         m_receiverThread->quit();
         m_receiverThread->wait();
 
         delete m_receiverThread;
     }
 
-    if (m_socket) {
-        delete m_socket;
-    }
+    delete m_socketV4;
+    delete m_socketV6;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::getInstance(bool returnNull) -> Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker * {
-    static Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker *instance = nullptr;
+    static std::atomic<Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker *> instance(nullptr);
+    static std::once_flag instanceFlag;
 
-    if (instance) {
+    if (returnNull) {
         return instance;
     }
 
-    if (returnNull) {
-        return nullptr;
-    }
+    // targets are created, and engines started, from whichever thread owns them, so the receiver may be requested
+    // from several threads at once and must only be created by one of them.
 
-    instance = new Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker;
+    std::call_once(instanceFlag, []() {
+        auto receiverWorker = new Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker;
 
-    instance->m_receiverThread = new QThread;
+        receiverWorker->m_receiverThread = new QThread;
 
-    instance->moveToThread(instance->m_receiverThread);
+        receiverWorker->moveToThread(receiverWorker->m_receiverThread);
 
-    connect(instance->m_receiverThread, &QThread::started, instance, &Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::doWork);
+        connect(
+            receiverWorker->m_receiverThread,
+            &QThread::started,
+            receiverWorker,
+            &Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::doWork
+        );
 
-    instance->m_receiverThread->start();
+        receiverWorker->m_isRunning = true;
 
-    instance->m_receiveWorker = instance;
+        receiverWorker->m_receiverThread->start();
+
+        receiverWorker->m_receiveWorker = receiverWorker;
+
+        instance = receiverWorker;
+    });
 
     return instance;
 }
 
 void Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::doWork() {
-    QByteArray receiveBuffer;
+    Nedrysoft::ICMPSocket::ICMPReceiveBatch receiveBatch(DefaultReceiveBatchSize);
 
-    m_socket =  Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(
-        static_cast<Nedrysoft::ICMPSocket::IPVersion>(Nedrysoft::ICMPSocket::V4)
-    );
+    // a raw socket is opened for each address family, both are waited on by this thread so the replies of ipv4
+    // and ipv6 engines arrive through the same receiver.
+
+    auto socketV4 = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
+    auto socketV6 = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V6);
+
+    m_identifierMutex.lock();
+
+    m_socketV4 = socketV4;
+    m_socketV6 = socketV6;
+
+    updateFilter();
+
+    m_identifierMutex.unlock();
+
+    std::vector<std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket>> datagramSockets;
+    std::vector<std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket>> receiverSockets;
+    std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> readySockets;
+    std::vector<uint64_t> expiredKeys;
+
+    // when io_uring is available the sockets are read with multishot receives, otherwise they are registered with
+    // a socket set that waits on all of them (through a single epoll instance on linux).
+
+    m_wakeMutex.lock();
+
+    m_ring.reset(Nedrysoft::ICMPSocket::ICMPRing::create());
+
+    if (!m_ring) {
+        m_socketSet = std::make_unique<Nedrysoft::ICMPSocket::ICMPSocketSet>();
+    }
 
-    QHostAddress receiveAddress;
+    m_wakeMutex.unlock();
 
-    m_isRunning = true;
+    auto ring = m_ring.get();
+    auto socketSet = m_socketSet.get();
+
+    // the ring and the linux socket set can be woken by other threads, so the receiver blocks until there is work,
+    // otherwise the wait is bounded so that changes made by other threads are picked up.
+
+    auto maximumWaitTime = (ring || socketSet->isWakeable()) ? -1 : DefaultReplyTimeout;
+
+    auto addReceiver = [ring, socketSet](Nedrysoft::ICMPSocket::ICMPSocket *socket) {
+        return ring ? ring->addReceiver(socket) : socketSet->add(socket);
+    };
+
+    auto removeReceiver = [ring, socketSet](Nedrysoft::ICMPSocket::ICMPSocket *socket) {
+        if (ring) {
+            ring->removeReceiver(socket);
+        } else {
+            socketSet->remove(socket);
+        }
+    };
+
+    for (auto rawSocket : {socketV4, socketV6}) {
+        if (rawSocket) {
+            addReceiver(rawSocket);
+        }
+    }
 
     while (QThread::currentThread()->isRunning() && (m_isRunning)) {
-        QElapsedTimer receiveTimer;
+        // the datagram sockets are copied so that an engine can remove its socket while a read is in progress,
+        // the receiver is woken when the sockets change so that they are picked up straight away.
+
+        // the wait for packets ends in time for the next request to be expired.
 
-        auto result = m_socket->recvfrom(receiveBuffer, receiveAddress, DefaultReplyTimeout);
+        auto waitTime = m_timerWheel.waitTime(
+                Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp(),
+                maximumWaitTime
+        );
 
-        receiveTimer.restart();
+        m_socketsMutex.lock();
 
-        if (result!=-1) {
-            SPDLOG_TRACE("ICMP Packet Received");
+        datagramSockets = m_datagramSockets;
 
-            Q_EMIT packetReceived(receiveTimer, receiveBuffer, receiveAddress);
+        m_socketsMutex.unlock();
+
+        for (auto &receiverSocket : receiverSockets) {
+            if (std::find(datagramSockets.begin(), datagramSockets.end(), receiverSocket) == datagramSockets.end()) {
+                removeReceiver(receiverSocket.get());
+            }
         }
+
+        receiverSockets.erase(
+            std::remove_if(receiverSockets.begin(), receiverSockets.end(), [&datagramSockets](auto &receiverSocket) {
+                return std::find(datagramSockets.begin(), datagramSockets.end(), receiverSocket) ==
+                       datagramSockets.end();
+            }),
+            receiverSockets.end()
+        );
+
+        for (auto &datagramSocket : datagramSockets) {
+            if (std::find(receiverSockets.begin(), receiverSockets.end(), datagramSocket) == receiverSockets.end()) {
+                if (addReceiver(datagramSocket.get())) {
+                    receiverSockets.push_back(datagramSocket);
+                }
+            }
+        }
+
+        if (ring) {
+            auto result = ring->wait(receiveBatch, expiredKeys, waitTime);
+
+            if (result > 0) {
+                SPDLOG_TRACE(QString("%1 ICMP Packets Received").arg(result).toStdString());
+
+                dispatch(receiveBatch);
+            }
+        } else if (socketSet->wait(readySockets, waitTime) > 0) {
+            for (auto readySocket : readySockets) {
+                auto result = readySocket->recvBatch(receiveBatch, 0);
+
+                if (result > 0) {
+                    SPDLOG_TRACE(QString("%1 ICMP Packets Received").arg(result).toStdString());
+
+                    dispatch(receiveBatch);
+                }
+            }
+        }
+
+        // replies are processed before the wheel is advanced, so a reply that arrives just before its deadline
+        // is not reported as a timeout.
+
+        m_timerWheel.advance(Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp());
+    }
+
+    m_wakeMutex.lock();
+
+    m_ring.reset();
+    m_socketSet.reset();
+
+    m_wakeMutex.unlock();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::dispatch(
+        const Nedrysoft::ICMPSocket::ICMPReceiveBatch &receiveBatch) -> void {
+
+    // the routes are only looked at while the dispatch mutex is held, so once an engine has been removed from the
+    // published routes and the mutex has been acquired by the caller, the engine will not be called again.
+
+    QMutexLocker locker(&m_dispatchMutex);
+
+    auto routes = std::atomic_load(&m_routes);
+
+    for (auto packetIndex = 0; packetIndex < receiveBatch.count(); packetIndex++) {
+        // the packet is decoded in place in the receive arena, nothing is copied or allocated.
+
+        auto parseResult = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+            receiveBatch.data(packetIndex),
+            receiveBatch.length(packetIndex),
+            static_cast<Nedrysoft::ICMPPacket::IPVersion>(receiveBatch.version(packetIndex))
+        );
+
+        if (parseResult.resultCode == Nedrysoft::ICMPPacket::Invalid) {
+            continue;
+        }
+
+        auto route = routes->find(parseResult.id);
+
+        if (route == routes->end()) {
+            continue;
+        }
+
+        for (auto &registration : route->second) {
+            registration.first->processReply(receiveBatch, packetIndex, parseResult);
+        }
+    }
+}
+
+template <typename Function>
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::updateRoutes(Function modify) -> void {
+    auto routes = std::make_shared<RouteTable>(*std::atomic_load(&m_routes));
+
+    modify(*routes);
+
+    std::atomic_store(&m_routes, std::shared_ptr<const RouteTable>(std::move(routes)));
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::addIdentifier(
+        uint16_t identifier,
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void {
+
+    QMutexLocker locker(&m_identifierMutex);
+
+    auto isNewRegistration = false;
+
+    updateRoutes([&](RouteTable &routes) {
+        auto &registrations = routes[identifier];
+
+        auto registration = std::find_if(registrations.begin(), registrations.end(), [engine](auto &entry) {
+            return entry.first == engine;
+        });
+
+        if (registration != registrations.end()) {
+            registration->second++;
+        } else {
+            registrations.emplace_back(engine, 1);
+
+            isNewRegistration = true;
+        }
+    });
+
+    if (isNewRegistration) {
+        updateFilter();
     }
-}
\ No newline at end of file
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::removeIdentifier(
+        uint16_t identifier,
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void {
+
+    m_identifierMutex.lock();
+
+    auto isRemovedRegistration = false;
+
+    updateRoutes([&](RouteTable &routes) {
+        auto route = routes.find(identifier);
+
+        if (route == routes.end()) {
+            return;
+        }
+
+        auto &registrations = route->second;
+
+        auto registration = std::find_if(registrations.begin(), registrations.end(), [engine](auto &entry) {
+            return entry.first == engine;
+        });
+
+        if ((registration != registrations.end()) && (--registration->second == 0)) {
+            registrations.erase(registration);
+
+            isRemovedRegistration = true;
+        }
+
+        if (registrations.empty()) {
+            routes.erase(route);
+        }
+    });
+
+    if (isRemovedRegistration) {
+        updateFilter();
+    }
+
+    m_identifierMutex.unlock();
+
+    // wait for a dispatch that may have started with the previous routes to complete.
+
+    QMutexLocker locker(&m_dispatchMutex);
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::reserveIdentifier(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        uint16_t identifier) -> uint16_t {
+
+    QMutexLocker locker(&m_identifierMutex);
+
+    auto isAvailable = [this, engine](uint16_t candidate) {
+        auto reservation = m_reservations.find(candidate);
+
+        return (reservation == m_reservations.end()) || (reservation->second.first == engine);
+    };
+
+    if (!identifier) {
+        do {
+            identifier = static_cast<uint16_t>(Nedrysoft::Core::ICore::getInstance()->random(1.0, UINT16_MAX-1));
+        } while (!isAvailable(identifier));
+    } else if (!isAvailable(identifier)) {
+        return 0;
+    }
+
+    auto &reservation = m_reservations[identifier];
+
+    reservation.first = engine;
+    reservation.second++;
+
+    return identifier;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::releaseIdentifier(
+        uint16_t identifier,
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void {
+
+    QMutexLocker locker(&m_identifierMutex);
+
+    auto reservation = m_reservations.find(identifier);
+
+    if ((reservation != m_reservations.end()) && (reservation->second.first == engine)) {
+        if (--reservation->second.second == 0) {
+            m_reservations.erase(reservation);
+        }
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::updateFilter() -> void {
+    if ((!m_socketV4) && (!m_socketV6)) {
+        return;
+    }
+
+    std::vector<uint16_t> identifiers;
+
+    auto routes = std::atomic_load(&m_routes);
+
+    identifiers.reserve(routes->size());
+
+    // replies for engines that own a datagram socket are delivered on that socket, so they are left out of the
+    // filter to avoid reading them twice.
+
+    for (auto &route : *routes) {
+        for (auto &registration : route.second) {
+            if (!registration.first->datagramSocket()) {
+                identifiers.push_back(route.first);
+
+                break;
+            }
+        }
+    }
+
+    // the identifiers of both families share one set, a collision only lets through packets that the dispatcher
+    // then matches against the outstanding requests.
+
+    for (auto rawSocket : {m_socketV4, m_socketV6}) {
+        if (rawSocket) {
+            rawSocket->setIdentifierFilter(identifiers);
+        }
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::addSocket(
+        std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket> socket) -> void {
+
+    m_socketsMutex.lock();
+
+    m_datagramSockets.push_back(std::move(socket));
+
+    m_socketsMutex.unlock();
+
+    wake();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::removeSocket(
+        const std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket> &socket) -> void {
+
+    m_socketsMutex.lock();
+
+    m_datagramSockets.erase(
+        std::remove(m_datagramSockets.begin(), m_datagramSockets.end(), socket),
+        m_datagramSockets.end()
+    );
+
+    m_socketsMutex.unlock();
+
+    // the receiver holds a reference to the socket until it next wakes.
+
+    wake();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::timerWheel() -> Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel * {
+    return &m_timerWheel;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::wake() -> void {
+    QMutexLocker locker(&m_wakeMutex);
+
+    if (m_ring) {
+        m_ring->wake();
+    } else if (m_socketSet) {
+        m_socketSet->wake();
+    }
+}
@@ -24,14 +24,22 @@
 #ifndef PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGRECEIVERWORKER_H
 #define PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGRECEIVERWORKER_H
 
+#include "ICMPPingTimerWheel.h"
+
+#include <QMutex>
 #include <QObject>
-#include <QByteArray>
-#include <QElapsedTimer>
-#include <QHostAddress>
 #include <QThread>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Nedrysoft { namespace ICMPSocket {
+    class ICMPReceiveBatch;
+    class ICMPRing;
     class ICMPSocket;
+    class ICMPSocketSet;
 }}
 
 namespace Nedrysoft { namespace ICMPPingEngine {
@@ -41,8 +49,10 @@ namespace Nedrysoft { namespace ICMPPingEngine {
     /**
      * @brief       The ICMP packet receiver class.
      *
-     * @details     This is a singleton class, there is a single receive thread which reads packets as they arrive
-     *              and then signals that a packet is available, other objects can then process the packet.
+     * @details     This is a singleton class, there is a single receive thread which drains packets from the ICMPv4
+     *              and ICMPv6 sockets (and the datagram sockets of the engines) as they arrive.  Each packet is decoded once and then passed to the engines that registered its
+     *              ICMP identifier, which are found through a hash table, so the cost of a packet does not grow with
+     *              the number of engines.
      */
     class ICMPPingReceiverWorker :
             public QObject {
@@ -74,17 +84,92 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             static auto getInstance(bool returnNull=false) -> Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker *;
 
             /**
-             * @brief       This signal is emitted when an ICMP packet has been received.
+             * @brief       Routes the replies that carry an ICMP identifier to an engine.
+             *
+             * @details     Registrations are reference counted, as the targets of an engine may share an identifier
+             *              and targets in different engines may collide on one.  Identifiers of engines that use the
+             *              shared raw socket are also added to its filter, which is regenerated when the set changes.
+             *
+             * @param[in]   identifier the ICMP identifier.
+             * @param[in]   engine the engine that receives the replies.
+             */
+            auto addIdentifier(uint16_t identifier, Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void;
+
+            /**
+             * @brief       Stops routing the replies that carry an ICMP identifier to an engine.
+             *
+             * @details     Once the last registration of an engine has been removed, the receiver will not pass
+             *              any further replies to it.
+             *
+             * @param[in]   identifier the ICMP identifier.
+             * @param[in]   engine the engine.
+             */
+            auto removeIdentifier(uint16_t identifier, Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void;
+
+            /**
+             * @brief       Reserves an ICMP identifier for a target of an engine.
+             *
+             * @details     A reply is matched to its request by the identifier and sequence number alone, and every
+             *              engine numbers its requests from the same sequence blocks, so an identifier is only ever
+             *              used by the targets of one engine at a time.  Reservations are reference counted, the
+             *              targets of an engine may share an identifier.
+             *
+             * @param[in]   engine the engine that the target belongs to.
+             * @param[in]   identifier the identifier to reserve; or 0 to draw one that no other engine is using.
+             *
+             * @returns     the reserved identifier; otherwise 0 if the given identifier is in use by another engine.
+             */
+            auto reserveIdentifier(
+                    Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+                    uint16_t identifier = 0) -> uint16_t;
+
+            /**
+             * @brief       Releases an identifier that was reserved with reserveIdentifier.
+             *
+             * @param[in]   identifier the identifier.
+             * @param[in]   engine the engine that reserved the identifier.
+             */
+            auto releaseIdentifier(uint16_t identifier, Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void;
+
+            /**
+             * @brief       Adds a datagram socket to the set of sockets that the receiver reads from.
+             *
+             * @details     Datagram sockets only receive the replies for their own identifier, so each engine that
+             *              uses one registers it with the receiver while it is running.
+             *
+             * @param[in]   socket the datagram socket.
+             */
+            auto addSocket(std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket> socket) -> void;
+
+            /**
+             * @brief       Removes a datagram socket from the set of sockets that the receiver reads from.
+             *
+             * @note        The receiver holds a reference to the socket until its current read has completed.
+             *
+             * @param[in]   socket the datagram socket.
+             */
+            auto removeSocket(const std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket> &socket) -> void;
+
+            /**
+             * @brief       Returns the timer wheel that expires outstanding requests.
+             *
+             * @details     The receiver thread advances the wheel whenever it wakes and never waits for packets
+             *              beyond the next deadline, so requests are expired within a millisecond of timing out.
+             *
+             * @returns     the timer wheel.
+             */
+            auto timerWheel() -> Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel *;
+
+            /**
+             * @brief       Wakes the receiver thread so that it picks up changes made by another thread.
+             *
+             * @details     The receiver blocks until a packet arrives or the next request is due, so it is woken
+             *              when a socket is added or removed, when a request is scheduled ahead of the others and
+             *              when it is stopped.
              *
-             * @param[in]   receiveTimer a timer started from when the packet was received.
-             * @param[in]   receiveBuffer the packet data.
-             * @param[in]   receiveAddress the address the packet was received from (this may differ from the target).
+             * @note        May be called from any thread.
              */
-            Q_SIGNAL void packetReceived(
-                QElapsedTimer receiveTimer,
-                QByteArray receiveBuffer,
-                QHostAddress receiveAddress
-            );
+            auto wake() -> void;
 
             friend class ICMPPingEngine;
             friend class ICMPPingEngineFactory;
@@ -95,15 +180,65 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             auto doWork() -> void;
 
+            /**
+             * @brief       Decodes each packet of a batch and passes it to the engines registered for its identifier.
+             *
+             * @param[in]   receiveBatch the packets that were drained from the sockets in a single read.
+             */
+            auto dispatch(const Nedrysoft::ICMPSocket::ICMPReceiveBatch &receiveBatch) -> void;
+
+            /**
+             * @brief       Publishes a modified copy of the identifier routes.
+             *
+             * @note        The identifier mutex must be held by the caller.
+             *
+             * @param[in]   modify the function that modifies the copy.
+             */
+            template <typename Function>
+            auto updateRoutes(Function modify) -> void;
+
+            /**
+             * @brief       Attaches a filter for the current identifiers to the receive socket.
+             *
+             * @note        The identifier mutex must be held by the caller.
+             */
+            auto updateFilter() -> void;
+
         private:
             //! @cond
 
             Nedrysoft::ICMPPingEngine::ICMPPingEngine *m_engine;
             Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker *m_receiveWorker;
             QThread *m_receiverThread;
-            Nedrysoft::ICMPSocket::ICMPSocket *m_socket;
+            Nedrysoft::ICMPSocket::ICMPSocket *m_socketV4;
+            Nedrysoft::ICMPSocket::ICMPSocket *m_socketV6;
+
+            // each identifier maps to the engines that registered it, together with their reference counts.
+
+            typedef std::unordered_map<
+                uint16_t,
+                std::vector<std::pair<Nedrysoft::ICMPPingEngine::ICMPPingEngine *, int>>
+            > RouteTable;
+
+            QMutex m_identifierMutex;
+            std::shared_ptr<const RouteTable> m_routes;
+            std::unordered_map<uint16_t, std::pair<Nedrysoft::ICMPPingEngine::ICMPPingEngine *, int>> m_reservations;
+
+            QMutex m_dispatchMutex;
+
+            QMutex m_socketsMutex;
+            std::vector<std::shared_ptr<Nedrysoft::ICMPSocket::ICMPSocket>> m_datagramSockets;
+
+            Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel m_timerWheel;
+
+            // the ring or socket set that the receiver thread waits on, guarded by the wake mutex as other threads
+            // use them to wake the receiver.
+
+            QMutex m_wakeMutex;
+            std::unique_ptr<Nedrysoft::ICMPSocket::ICMPRing> m_ring;
+            std::unique_ptr<Nedrysoft::ICMPSocket::ICMPSocketSet> m_socketSet;
 
-            bool m_isRunning;
+            std::atomic<bool> m_isRunning;
 
             //! @endcond
     };
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ICMPPingRequestTable.h"
+
+#include "ICMPPingItem.h"
+
+constexpr auto ChunkSize = 256;
+constexpr auto SequenceMask = 0xffff;
+constexpr auto IndexMask = 0xffffffu;
+constexpr auto StateShift = 24;
+constexpr auto StateMask = 0xffu;
+constexpr auto IdShift = 32;
+
+/**
+ * @brief       Returns the slot value that records how the request with the given id was retired.
+ *
+ * @details     The pool index of a retired slot is zero, so the slot reads as empty to every other operation.
+ *
+ * @param[in]   id the request id.
+ * @param[in]   state how the request was retired.
+ *
+ * @returns     the slot value.
+ */
+constexpr auto retiredSlot(uint32_t id, Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::RetiredState state) {
+    return (static_cast<uint64_t>(id) << IdShift) | (static_cast<uint64_t>(state) << StateShift);
+}
+
+/**
+ * @brief       A block of pool items and the links of the free list that runs through them.
+ */
+class Nedrysoft::ICMPPingEngine::ICMPPingRequestChunk {
+    public:
+        std::array<Nedrysoft::ICMPPingEngine::ICMPPingItem, ChunkSize> m_items;
+        std::array<std::atomic<uint32_t>, ChunkSize> m_next;
+};
+
+Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::ICMPPingRequestTable() :
+        m_chunkCount(0),
+        m_freeHead(0) {
+
+    for (auto &slot : m_slots) {
+        slot.store(0, std::memory_order_relaxed);
+    }
+}
+
+Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::~ICMPPingRequestTable() = default;
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::item(
+        uint32_t index) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+
+    return &m_chunks[index / ChunkSize]->m_items[index % ChunkSize];
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::grow() -> bool {
+    if (m_chunkCount == MaximumChunks) {
+        return false;
+    }
+
+    auto chunk = std::make_unique<Nedrysoft::ICMPPingEngine::ICMPPingRequestChunk>();
+    auto firstIndex = static_cast<uint32_t>(m_chunkCount * ChunkSize);
+
+    for (auto itemIndex = 0; itemIndex < ChunkSize; itemIndex++) {
+        chunk->m_items[itemIndex].m_poolIndex = firstIndex + static_cast<uint32_t>(itemIndex);
+        chunk->m_next[itemIndex].store(0, std::memory_order_relaxed);
+    }
+
+    m_chunks[m_chunkCount++] = std::move(chunk);
+
+    for (auto itemIndex = 0; itemIndex < ChunkSize; itemIndex++) {
+        release(item(firstIndex + static_cast<uint32_t>(itemIndex)));
+    }
+
+    return true;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::acquire() -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+    // the free list is pushed to by any thread but only popped by this one, so a head that is seen here cannot
+    // be removed and pushed back before the exchange, which keeps the list free of the ABA problem.
+
+    auto head = m_freeHead.load(std::memory_order_acquire);
+
+    while (true) {
+        if (!head) {
+            if (!grow()) {
+                return nullptr;
+            }
+
+            head = m_freeHead.load(std::memory_order_acquire);
+
+            continue;
+        }
+
+        auto index = head - 1;
+        auto next = m_chunks[index / ChunkSize]->m_next[index % ChunkSize].load(std::memory_order_relaxed);
+
+        if (m_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+            auto pingItem = item(index);
+
+            pingItem->setTransmitTimestamp(0);
+            pingItem->setMonotonicTimestamp(0);
+
+            return pingItem;
+        }
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::release(
+        Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void {
+
+    auto index = pingItem->m_poolIndex;
+    auto &next = m_chunks[index / ChunkSize]->m_next[index % ChunkSize];
+    auto head = m_freeHead.load(std::memory_order_relaxed);
+
+    do {
+        next.store(head, std::memory_order_relaxed);
+    } while (!m_freeHead.compare_exchange_weak(head, index + 1, std::memory_order_release, std::memory_order_relaxed));
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::insert(
+        Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+
+    // the pool index is stored offset by one so that an empty slot is always zero.
+
+    auto id = (static_cast<uint32_t>(pingItem->id()) << 16) | pingItem->sequenceId();
+    auto value = (static_cast<uint64_t>(id) << IdShift) | (pingItem->m_poolIndex + 1);
+
+    auto previousValue = m_slots[id & SequenceMask].exchange(value, std::memory_order_acq_rel);
+
+    if (!(previousValue & IndexMask)) {
+        return nullptr;
+    }
+
+    return item(static_cast<uint32_t>(previousValue & IndexMask) - 1);
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::take(
+        uint32_t id,
+        int generation) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+
+    auto &slot = m_slots[id & SequenceMask];
+    auto value = slot.load(std::memory_order_acquire);
+
+    while ((value & IndexMask) && (static_cast<uint32_t>(value >> IdShift) == id)) {
+        // the generation is written before the item is inserted, so it is visible once the slot has been loaded.
+
+        if ((generation >= 0) && (item(static_cast<uint32_t>(value & IndexMask) - 1)->generation() != generation)) {
+            return nullptr;
+        }
+
+        if (slot.compare_exchange_weak(
+                value,
+                retiredSlot(id, Answered),
+                std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+
+            return item(static_cast<uint32_t>(value & IndexMask) - 1);
+        }
+    }
+
+    return nullptr;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::takeIfSentBefore(
+        uint32_t id,
+        int64_t timestamp,
+        int64_t *pendingTimestamp) -> Nedrysoft::ICMPPingEngine::ICMPPingItem * {
+
+    if (pendingTimestamp) {
+        *pendingTimestamp = 0;
+    }
+
+    auto &slot = m_slots[id & SequenceMask];
+    auto value = slot.load(std::memory_order_acquire);
+
+    while ((value & IndexMask) && (static_cast<uint32_t>(value >> IdShift) == id)) {
+        // an item that has not been stamped yet has not been sent, so it cannot have timed out.
+
+        auto pingItem = item(static_cast<uint32_t>(value & IndexMask) - 1);
+        auto transmitTimestamp = pingItem->monotonicTimestamp();
+
+        if ((!transmitTimestamp) || (transmitTimestamp >= timestamp)) {
+            if (pendingTimestamp) {
+                *pendingTimestamp = transmitTimestamp;
+            }
+
+            return nullptr;
+        }
+
+        if (slot.compare_exchange_weak(
+                value,
+                retiredSlot(id, Expired),
+                std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+
+            return pingItem;
+        }
+    }
+
+    return nullptr;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::retiredState(
+        uint32_t id) -> Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::RetiredState {
+
+    auto value = m_slots[id & SequenceMask].load(std::memory_order_acquire);
+
+    if (static_cast<uint32_t>(value >> IdShift) != id) {
+        return Unknown;
+    }
+
+    if (value & IndexMask) {
+        return Outstanding;
+    }
+
+    return static_cast<Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::RetiredState>(
+        (value >> StateShift) & StateMask
+    );
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::clear() -> int {
+    auto count = 0;
+
+    for (auto &slot : m_slots) {
+        auto value = slot.exchange(0, std::memory_order_acq_rel);
+
+        if (value & IndexMask) {
+            release(item(static_cast<uint32_t>(value & IndexMask) - 1));
+
+            count++;
+        }
+    }
+
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGREQUESTTABLE_H
+#define PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGREQUESTTABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Nedrysoft { namespace ICMPPingEngine {
+    class ICMPPingItem;
+    class ICMPPingRequestChunk;
+
+    /**
+     * @brief       The ICMPPingRequestTable class tracks the requests of an engine that are awaiting a reply.
+     *
+     * @details     There is one slot for every ICMP sequence number, a slot holds the request id (the ICMP id and
+     *              sequence number) together with the pool index of the item, so a reply is matched with a single
+     *              load and the request is retired by the thread that swaps the slot back to empty.  Whoever wins
+     *              that exchange owns the item, so a reply and a timeout for the same request can never both be
+     *              reported.
+     *
+     *              Replies that carry the generation of the sequence space they were sent from are only matched
+     *              against a request of the same generation, so a late reply is not attributed to a newer request
+     *              that has reused its sequence number.
+     *
+     *              A retired slot keeps the id of its request and how it was retired until the sequence number is
+     *              reused, so a reply that finds no request can be told apart as late or duplicated.
+     *
+     *              Items are drawn from a pool that grows in chunks and is never freed while the table exists, so
+     *              an item can be looked at by a thread that loses the race to retire it.
+     *
+     * @note        acquire must only be called from one thread (the transmitter of the engine), every other
+     *              function may be called from any thread.
+     */
+    class ICMPPingRequestTable {
+        public:
+            /**
+             * @brief       How the request that last used a slot was retired.
+             */
+            enum RetiredState {
+                Unknown = 0,
+                Answered = 1,
+                Expired = 2,
+                Outstanding = 3
+            };
+
+            /**
+             * @brief       Constructs a new ICMPPingRequestTable.
+             */
+            ICMPPingRequestTable();
+
+            /**
+             * @brief       Destroys the ICMPPingRequestTable.
+             */
+            ~ICMPPingRequestTable();
+
+            /**
+             * @brief       Returns an unused item from the pool.
+             *
+             * @returns     the item; otherwise nullptr if the pool is exhausted.
+             */
+            auto acquire() -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+
+            /**
+             * @brief       Returns an item to the pool.
+             *
+             * @param[in]   pingItem the item, which must have been retired from the table.
+             */
+            auto release(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> void;
+
+            /**
+             * @brief       Adds an item to the table using its id and sequence number.
+             *
+             * @param[in]   pingItem the item to add.
+             *
+             * @returns     the item that previously occupied the slot (the sequence number has wrapped while it
+             *              was outstanding) which is now owned by the caller; otherwise nullptr.
+             */
+            auto insert(Nedrysoft::ICMPPingEngine::ICMPPingItem *pingItem) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+
+            /**
+             * @brief       Retires the request with the given id.
+             *
+             * @param[in]   id the request id, constructed as (icmp_id<<16) | icmp_sequence_id.
+             * @param[in]   generation the generation carried by the reply; or -1 if the reply did not carry one.
+             *
+             * @returns     the item which is now owned by the caller; otherwise nullptr if the request is not in
+             *              the table, is from a different generation or was retired by another thread.
+             */
+            auto take(uint32_t id, int generation = -1) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+
+            /**
+             * @brief       Retires the request with the given id if it was sent before the given time.
+             *
+             * @param[in]   id the request id.
+             * @param[in]   timestamp the monotonic time in nanoseconds, requests sent after this are left in the table.
+             * @param[out]  pendingTimestamp if not nullptr, set to the monotonic transmit time of a request that was
+             *              left in the table because it was sent after the given time; otherwise set to 0.
+             *
+             * @returns     the item which is now owned by the caller; otherwise nullptr.
+             */
+            auto takeIfSentBefore(
+                uint32_t id,
+                int64_t timestamp,
+                int64_t *pendingTimestamp = nullptr
+            ) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+
+            /**
+             * @brief       Returns how the request with the given id was retired.
+             *
+             * @note        Intended for classifying replies that were not matched, the result is only advisory as
+             *              the slot may be reused at any time.
+             *
+             * @param[in]   id the request id.
+             *
+             * @returns     the state of the request; or Unknown if the slot has since been used by another request.
+             */
+            auto retiredState(uint32_t id) -> Nedrysoft::ICMPPingEngine::ICMPPingRequestTable::RetiredState;
+
+            /**
+             * @brief       Retires every request and returns the items to the pool.
+             *
+             * @returns     the number of requests that were outstanding.
+             */
+            auto clear() -> int;
+
+        private:
+            /**
+             * @brief       Returns the item at a pool index.
+             *
+             * @param[in]   index the pool index.
+             *
+             * @returns     the item.
+             */
+            auto item(uint32_t index) -> Nedrysoft::ICMPPingEngine::ICMPPingItem *;
+
+            /**
+             * @brief       Adds a chunk of items to the pool.
+             *
+             * @returns     true if the pool was grown; otherwise false if it has reached its maximum size.
+             */
+            auto grow() -> bool;
+
+        private:
+            //! @cond
+
+            static constexpr auto SlotCount = 65536;
+            static constexpr auto MaximumChunks = 256;
+
+            std::array<std::atomic<uint64_t>, SlotCount> m_slots;
+
+            std::array<std::unique_ptr<Nedrysoft::ICMPPingEngine::ICMPPingRequestChunk>, MaximumChunks> m_chunks;
+            int m_chunkCount;
+
+            std::atomic<uint32_t> m_freeHead;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGREQUESTTABLE_H
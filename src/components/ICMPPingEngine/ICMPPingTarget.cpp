@@ -23,10 +23,17 @@
 
 #include "ICMPPingTarget.h"
 #include "ICMPPingEngine.h"
+#include "ICMPPingReceiverWorker.h"
+#include "ICMPPacket/ICMPPacket.h"
 #include "ICMPSocket/ICMPSocket.h"
 
+#include <ICore>
 #include <QHostAddress>
 #include <cassert>
+#include <spdlog/spdlog.h>
+
+constexpr auto DefaultPayloadLength = 52;
+constexpr auto SequenceSpaceSize = 1024;
 
 /**
  * @brief       Private class to store the ping targets instance data.
@@ -41,10 +48,14 @@ class Nedrysoft::ICMPPingEngine::ICMPPingTargetData {
         ICMPPingTargetData(Nedrysoft::ICMPPingEngine::ICMPPingTarget *parent) :
                 m_pingTarget(parent),
                 m_engine(nullptr),
-                m_socket(nullptr),
                 m_userData(nullptr),
                 m_ttl(0),
-                m_id(Nedrysoft::Core::ICore::getInstance()->random(1.0, UINT16_MAX-1)) {
+                m_phaseOffset(-1),
+                m_sequenceSpace(0),
+                m_sequenceBase(0),
+                m_sequenceIndex(0),
+                m_generation(0),
+                m_id(0) {
 
         }
 
@@ -55,10 +66,15 @@ class Nedrysoft::ICMPPingEngine::ICMPPingTargetData {
 
         QHostAddress m_hostAddress;
         Nedrysoft::ICMPPingEngine::ICMPPingEngine *m_engine;
-        Nedrysoft::ICMPSocket::ICMPSocket *m_socket;
+        QByteArray m_echoRequest;
         uint16_t m_id;
         void *m_userData;
         int m_ttl;
+        int m_phaseOffset;
+        int m_sequenceSpace;
+        uint16_t m_sequenceBase;
+        uint16_t m_sequenceIndex;
+        uint16_t m_generation;
 };
 
 Nedrysoft::ICMPPingEngine::ICMPPingTarget::ICMPPingTarget(
@@ -71,18 +87,36 @@ Nedrysoft::ICMPPingEngine::ICMPPingTarget::ICMPPingTarget(
     d->m_hostAddress = std::move(hostAddress);
     d->m_engine = engine;
     d->m_ttl = ttl;
+
+    // the kernel overwrites the identifier of requests sent from a datagram socket with its own, which it keeps
+    // unique among datagram sockets but which a raw socket engine may already have drawn.  Otherwise an identifier
+    // that no other engine is using is drawn, so the requests of two engines can never be confused.
+
+    auto receiverWorker = Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::getInstance();
+
+    if (engine->datagramSocket()) {
+        d->m_id = engine->datagramSocket()->identifier();
+
+        if (!receiverWorker->reserveIdentifier(engine, d->m_id)) {
+            SPDLOG_WARN(QString("ICMP identifier %1 is already in use by another engine.").arg(d->m_id).toStdString());
+        }
+    } else {
+        d->m_id = receiverWorker->reserveIdentifier(engine);
+    }
 }
 
 Nedrysoft::ICMPPingEngine::ICMPPingTarget::~ICMPPingTarget() {
-    if (d->m_socket) {
-        delete d->m_socket;
-    }
+    Nedrysoft::ICMPPingEngine::ICMPPingReceiverWorker::getInstance()->releaseIdentifier(d->m_id, d->m_engine);
 
     d.reset();
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::setHostAddress(QHostAddress hostAddress) -> void {
     d->m_hostAddress = hostAddress;
+
+    // the ipv6 checksum covers the destination address, so the template must be rebuilt.
+
+    d->m_echoRequest.clear();
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::hostAddress() -> QHostAddress {
@@ -93,30 +127,60 @@ auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::engine() -> Nedrysoft::RouteAnal
     return d->m_engine;
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::socket() -> Nedrysoft::ICMPSocket::ICMPSocket * {
-    if (d->m_socket==nullptr) {
-        if (d->m_hostAddress.protocol() == QAbstractSocket::IPv4Protocol) {
-            d->m_socket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(
-                    d->m_ttl,
-                    Nedrysoft::ICMPSocket::V4 );
-        } else if (d->m_hostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
-            d->m_socket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(
-                    d->m_ttl,
-                    Nedrysoft::ICMPSocket::V6);
-        }
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::echoRequest() -> QByteArray & {
+    if (d->m_echoRequest.isEmpty()) {
+        d->m_echoRequest = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+                d->m_id,
+                0,
+                DefaultPayloadLength,
+                d->m_hostAddress,
+                static_cast<Nedrysoft::ICMPPacket::IPVersion>(d->m_engine->version()) );
     }
 
-    return d->m_socket;
+    return d->m_echoRequest;
 }
 
 auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::id() -> uint16_t {
     return d->m_id;
 }
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::setSequenceSpace(int space) -> void {
+    assert((space >= 0) && (space < SequenceSpaceCount));
+
+    d->m_sequenceSpace = space;
+    d->m_sequenceBase = static_cast<uint16_t>(space * SequenceSpaceSize);
+    d->m_sequenceIndex = 0;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::sequenceSpace() -> int {
+    return d->m_sequenceSpace;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::nextSequenceId(uint16_t &generation) -> uint16_t {
+    auto sequenceId = static_cast<uint16_t>(d->m_sequenceBase + d->m_sequenceIndex);
+
+    generation = d->m_generation;
+
+    if (++d->m_sequenceIndex == SequenceSpaceSize) {
+        d->m_sequenceIndex = 0;
+        d->m_generation++;
+    }
+
+    return sequenceId;
+}
+
 auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::ttl() -> uint16_t {
     return d->m_ttl;
 }
 
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::setPhaseOffset(int offset) -> void {
+    d->m_phaseOffset = offset;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::phaseOffset() -> int {
+    return d->m_phaseOffset;
+}
+
 auto Nedrysoft::ICMPPingEngine::ICMPPingTarget::userData() -> void * {
     return d->m_userData;
 }
@@ -25,6 +25,7 @@
 #define PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTARGET_H
 
 #include <IPingTarget>
+#include <QByteArray>
 
 #if defined(Q_OS_WIN)
 #include <WS2tcpip.h>
@@ -32,10 +33,6 @@
 #endif
 #include <memory>
 
-namespace Nedrysoft { namespace ICMPSocket {
-    class ICMPSocket;
-}}
-
 namespace Nedrysoft { namespace ICMPPingEngine {
     class ICMPPingTargetData;
 
@@ -55,6 +52,12 @@ namespace Nedrysoft { namespace ICMPPingEngine {
             Q_INTERFACES(Nedrysoft::RouteAnalyser::IPingTarget)
 
         public:
+            /**
+             * @brief       The number of blocks that the sequence numbers of an engine are divided into, which is
+             *              the maximum number of targets that an engine can have at once.
+             */
+            static constexpr auto SequenceSpaceCount = 64;
+
             /**
              * @brief       Constructs a ICMPPingTarget for the given engine with the supplied host and ttl.
              *
@@ -123,6 +126,25 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             auto ttl() -> uint16_t override;
 
+            /**
+             * @brief       Sets the point in each interval at which this target is pinged.
+             *
+             * @details     By default the targets of an engine are spread evenly across the interval, an offset
+             *              pins this target to a fixed point instead.  Targets that share an offset are sent together.
+             *
+             * @param[in]   offset the offset from the start of the interval in milliseconds; or -1 to use the
+             *              default spacing.
+             */
+            auto setPhaseOffset(int offset) -> void;
+
+            /**
+             * @brief       Returns the point in each interval at which this target is pinged.
+             *
+             * @returns     the offset from the start of the interval in milliseconds; or -1 if the default spacing
+             *              is used.
+             */
+            auto phaseOffset() -> int;
+
         public:
             /**
              * @brief       Saves the configuration to a JSON object.
@@ -143,11 +165,14 @@ namespace Nedrysoft { namespace ICMPPingEngine {
         protected:
 
             /**
-             * @brief       Returns socket to be used to send ICMP packets.
+             * @brief       Returns the echo request packet template for this target.
+             *
+             * @details     The packet is built the first time it is requested and then reused for every ping, the
+             *              transmitter patches the sequence (and checksum) in place before each send.
              *
-             * @returns     the socket.
+             * @returns     the echo request packet.
              */
-            auto socket() -> Nedrysoft::ICMPSocket::ICMPSocket *;
+            auto echoRequest() -> QByteArray &;
 
             /**
              * @brief       Returns the ICMP id used for this target.
@@ -156,6 +181,38 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             auto id() -> uint16_t;
 
+            /**
+             * @brief       Assigns the block of sequence numbers that this target sends from.
+             *
+             * @details     Each target of an engine draws its sequence numbers from its own block, so the rate at
+             *              which a target wraps depends only on its own send rate and the requests of different
+             *              targets can never occupy the same slot of the request table.
+             *
+             * @param[in]   space the index of the block, which must not be in use by another target of the engine.
+             */
+            auto setSequenceSpace(int space) -> void;
+
+            /**
+             * @brief       Returns the block of sequence numbers that this target sends from.
+             *
+             * @returns     the index of the block.
+             */
+            auto sequenceSpace() -> int;
+
+            /**
+             * @brief       Returns the next sequence number for this target.
+             *
+             * @details     The generation is incremented each time the sequence block wraps and is carried in the
+             *              payload of the request, a reply from an earlier generation is not matched against the
+             *              request that has reused its sequence number.
+             *
+             * @param[out]  generation the generation of the returned sequence number.
+             *
+             * @returns     the sequence number.
+             */
+            auto nextSequenceId(uint16_t &generation) -> uint16_t;
+
+            friend class ICMPPingEngine;
             friend class ICMPPingTransmitter;
 
         protected:
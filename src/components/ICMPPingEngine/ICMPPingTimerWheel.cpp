@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ICMPPingTimerWheel.h"
+
+#include "ICMPSocket/ICMPSocket.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+constexpr auto SlotCount = 4096;
+constexpr auto SlotMask = SlotCount - 1;
+constexpr auto TickLength = static_cast<int64_t>(1000000);
+constexpr auto NoTick = std::numeric_limits<int64_t>::max();
+
+Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel::ICMPPingTimerWheel(Nedrysoft::ICMPPingEngine::ExpireFunction expire) :
+        m_expire(std::move(expire)),
+        m_slots(SlotCount),
+        m_currentTick(Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() / TickLength),
+        m_nextTick(NoTick),
+        m_entryCount(0) {
+
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel::schedule(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        uint32_t id,
+        int64_t deadline) -> bool {
+
+    QMutexLocker locker(&m_mutex);
+
+    // the entry goes in the slot for the first tick that starts after the deadline, or the next tick if that
+    // has already passed.
+
+    auto tick = std::max(deadline / TickLength + 1, m_currentTick + 1);
+
+    m_slots[tick & SlotMask].push_back(Entry {engine, id, deadline});
+
+    m_entryCount++;
+
+    if (tick >= m_nextTick) {
+        return false;
+    }
+
+    m_nextTick = tick;
+
+    return true;
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel::cancel(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void {
+    QMutexLocker locker(&m_mutex);
+
+    for (auto &slot : m_slots) {
+        auto size = slot.size();
+
+        slot.erase(
+            std::remove_if(slot.begin(), slot.end(), [engine](const Entry &entry) {
+                return entry.engine == engine;
+            }),
+            slot.end()
+        );
+
+        m_entryCount -= static_cast<int>(size - slot.size());
+    }
+
+    if (!m_entryCount) {
+        m_nextTick = NoTick;
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel::advance(int64_t timestamp) -> void {
+    QMutexLocker locker(&m_mutex);
+
+    auto currentTick = timestamp / TickLength;
+
+    if (currentTick <= m_currentTick) {
+        return;
+    }
+
+    if (currentTick < m_nextTick) {
+        m_currentTick = currentTick;
+
+        return;
+    }
+
+    // no entry is due before the next tick, so the slots in between are skipped, and each slot is visited at
+    // most once however long it has been since the wheel was last advanced.
+
+    auto firstTick = std::max(m_currentTick + 1, std::max(m_nextTick, currentTick - SlotCount + 1));
+
+    for (auto tick = firstTick; tick <= currentTick; tick++) {
+        auto &slot = m_slots[tick & SlotMask];
+
+        for (size_t entryIndex = 0; entryIndex < slot.size();) {
+            if (slot[entryIndex].deadline < timestamp) {
+                m_expiredEntries.push_back(slot[entryIndex]);
+
+                slot[entryIndex] = slot.back();
+
+                slot.pop_back();
+            } else {
+                entryIndex++;
+            }
+        }
+    }
+
+    m_currentTick = currentTick;
+    m_entryCount -= static_cast<int>(m_expiredEntries.size());
+    m_nextTick = NoTick;
+
+    // find the tick at which the next entry is due, an entry further away than one revolution is due in a
+    // later pass over its slot, so the search stops at the first slot holding an entry due this revolution.
+
+    for (auto tick = currentTick + 1; (m_entryCount) && (tick <= currentTick + SlotCount); tick++) {
+        if (tick >= m_nextTick) {
+            break;
+        }
+
+        for (auto &entry : m_slots[tick & SlotMask]) {
+            auto dueTick = entry.deadline / TickLength + 1;
+
+            if (dueTick > tick) {
+                dueTick = tick + ((dueTick - tick + SlotMask) / SlotCount) * SlotCount;
+            } else {
+                dueTick = tick;
+            }
+
+            m_nextTick = std::min(m_nextTick, dueTick);
+        }
+    }
+
+    // the engines are called with the lock held so that an engine cannot be destroyed once cancel has returned.
+
+    for (auto &entry : m_expiredEntries) {
+        m_expire(entry.engine, entry.id);
+    }
+
+    m_expiredEntries.clear();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel::waitTime(int64_t timestamp, int maximumTime) -> int {
+    QMutexLocker locker(&m_mutex);
+
+    if (m_nextTick == NoTick) {
+        return maximumTime;
+    }
+
+    auto remainingTime = (m_nextTick * TickLength - timestamp + TickLength - 1) / TickLength;
+
+    if (maximumTime >= 0) {
+        remainingTime = std::min(remainingTime, static_cast<int64_t>(maximumTime));
+    }
+
+    remainingTime = std::min(remainingTime, static_cast<int64_t>(std::numeric_limits<int>::max()));
+
+    return static_cast<int>(std::max(remainingTime, static_cast<int64_t>(0)));
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTIMERWHEEL_H
+#define PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTIMERWHEEL_H
+
+#include <QMutex>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Nedrysoft { namespace ICMPPingEngine {
+    class ICMPPingEngine;
+
+    using ExpireFunction = std::function<void(Nedrysoft::ICMPPingEngine::ICMPPingEngine *, uint32_t)>;
+
+    /**
+     * @brief       The ICMPPingTimerWheel class expires outstanding requests when their reply timeout elapses.
+     *
+     * @details     A hashed timing wheel with a resolution of one millisecond, each request is placed in the slot
+     *              for the tick after its deadline, so scheduling is O(1) and advancing the wheel only visits the
+     *              slots for the ticks that have passed.  Deadlines further away than one revolution stay in their
+     *              slot until the revolution in which they fall.
+     *
+     *              The wheel is owned by the receiver thread, which advances it each time it wakes and limits the
+     *              time that it waits for packets to the next deadline.  Deadlines and the current time are given
+     *              on the monotonic clock, see Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp.
+     */
+    class ICMPPingTimerWheel {
+        public:
+            /**
+             * @brief       Constructs a new ICMPPingTimerWheel.
+             *
+             * @param[in]   expire the function that is called with the engine and id of each expired request.
+             */
+            ICMPPingTimerWheel(Nedrysoft::ICMPPingEngine::ExpireFunction expire);
+
+            /**
+             * @brief       Schedules the expiry of a request.
+             *
+             * @param[in]   engine the engine that the request belongs to.
+             * @param[in]   id the request id, constructed as (icmp_id<<16) | icmp_sequence_id.
+             * @param[in]   deadline the monotonic time in nanoseconds after which the request has timed out.
+             *
+             * @returns     true if the request is now the first due, in which case a thread that is waiting for the
+             *              previous first deadline must be woken; otherwise false.
+             */
+            auto schedule(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine, uint32_t id, int64_t deadline) -> bool;
+
+            /**
+             * @brief       Removes every scheduled expiry for an engine.
+             *
+             * @note        Once this returns the wheel will not call the engine again.
+             *
+             * @param[in]   engine the engine.
+             */
+            auto cancel(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void;
+
+            /**
+             * @brief       Expires every request whose deadline has passed.
+             *
+             * @details     The expire function is called for each expired request, the engine ignores the expiry
+             *              if a reply has already been received.
+             *
+             * @param[in]   timestamp the current monotonic time in nanoseconds.
+             */
+            auto advance(int64_t timestamp) -> void;
+
+            /**
+             * @brief       Returns the time until the next deadline.
+             *
+             * @param[in]   timestamp the current monotonic time in nanoseconds.
+             * @param[in]   maximumTime the value to return if there is no deadline sooner than this, or -1 if the
+             *              time is unbounded.
+             *
+             * @returns     the time in milliseconds; otherwise -1 if the time is unbounded and nothing is scheduled.
+             */
+            auto waitTime(int64_t timestamp, int maximumTime) -> int;
+
+        private:
+            /**
+             * @brief       A scheduled request expiry.
+             */
+            struct Entry {
+                Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine;
+                uint32_t id;
+                int64_t deadline;
+            };
+
+        private:
+            //! @cond
+
+            QMutex m_mutex;
+
+            Nedrysoft::ICMPPingEngine::ExpireFunction m_expire;
+
+            std::vector<std::vector<Entry>> m_slots;
+            std::vector<Entry> m_expiredEntries;
+
+            int64_t m_currentTick;
+            int64_t m_nextTick;
+            int m_entryCount;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTIMERWHEEL_H
@@ -28,109 +28,622 @@
 #include "ICMPPingItem.h"
 #include "ICMPPingTarget.h"
 #include "ICMPSocket/ICMPSocket.h"
+#include "Utils.h"
 
 #include <QThread>
 #include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <spdlog/spdlog.h>
+#include <thread>
 
-constexpr auto DefaultTransmitInterval = 10000;
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <ctime>
+#endif
+
+constexpr auto EngineSerialShift = 32;
+constexpr auto RequestIdMask = 0xffffffffu;
+constexpr auto NsPerMs = static_cast<int64_t>(1000000);
+constexpr auto NsPerSecond = static_cast<int64_t>(1000000000);
+constexpr auto MaximumSleepTime = 100 * NsPerMs;
 
 //! @cond
-uint16_t Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::m_sequenceId = 1;
-QMutex Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::m_sequenceMutex;
+QMutex Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::m_socketMutex;
+Nedrysoft::ICMPSocket::ICMPSocket *Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::m_writeSocketV4 = nullptr;
+Nedrysoft::ICMPSocket::ICMPSocket *Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::m_writeSocketV6 = nullptr;
 //! @endcond
 
-Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::ICMPPingTransmitter(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) :
-        m_interval(DefaultTransmitInterval),
-        m_engine(engine),
+/**
+ * @brief       The registration of an engine, held in the immutable snapshot that the transmitter sends from.
+ */
+class Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine {
+    public:
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *m_engine;
+        uint32_t m_serial;
+        int64_t m_interval;
+        int64_t m_startTime;
+        uint64_t m_firstRound;
+        std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTarget *> m_targets;
+};
+
+/**
+ * @brief       A target in the send schedule, ordered by the time that it is next due.
+ */
+class Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEntry {
+    public:
+        int64_t m_deadline;
+        uint64_t m_round;
+        Nedrysoft::ICMPPingEngine::ICMPPingTarget *m_target;
+        const Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine *m_engine;
+
+        /**
+         * @brief       Orders entries so that the heap is a min-heap on the deadline.
+         */
+        auto operator<(const Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEntry &other) const -> bool {
+            return m_deadline > other.m_deadline;
+        }
+};
+
+Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::ICMPPingTransmitter() :
+        m_transmitterThread(nullptr),
+        m_engines(std::make_shared<const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine>>()),
+        m_nextSerial(1),
+        m_ring(Nedrysoft::ICMPSocket::ICMPRing::create()),
         m_isRunning(false) {
 
 }
 
 Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::~ICMPPingTransmitter() {
-    qDeleteAll(m_targets);
+    if (m_transmitterThread) {
+        m_isRunning = false;
+
+        m_transmitterThread->quit();
+        m_transmitterThread->wait();
+
+        delete m_transmitterThread;
+    }
+
+    delete m_ring;
 }
 
-void Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::doWork() {
-    QElapsedTimer elapsedTimer;
-    unsigned long sampleNumber = 0;
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::getInstance(
+        bool returnNull) -> Nedrysoft::ICMPPingEngine::ICMPPingTransmitter * {
+
+    static std::atomic<Nedrysoft::ICMPPingEngine::ICMPPingTransmitter *> instance(nullptr);
+    static std::once_flag instanceFlag;
 
-    m_isRunning = true;
+    if (returnNull) {
+        return instance;
+    }
 
-    m_engine->setEpoch(QDateTime::currentDateTime());
+    // engines are started from whichever thread owns them, so the transmitter may be requested from several
+    // threads at once and must only be created by one of them.
 
+    std::call_once(instanceFlag, []() {
+        auto transmitter = new Nedrysoft::ICMPPingEngine::ICMPPingTransmitter;
+
+        transmitter->m_transmitterThread = new QThread;
+
+        transmitter->moveToThread(transmitter->m_transmitterThread);
+
+        connect(
+            transmitter->m_transmitterThread,
+            &QThread::started,
+            transmitter,
+            &Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::doWork
+        );
+
+        transmitter->m_isRunning = true;
+
+        transmitter->m_transmitterThread->start();
+
+        instance = transmitter;
+    });
+
+    return instance;
+}
+
+void Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::doWork() {
     while (m_isRunning) {
-        if (!m_targets.isEmpty()) {
-            SPDLOG_TRACE("Preparing ping set to " + m_targets.last()->hostAddress().toString().toStdString());
+        auto nextDeadline = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() + MaximumSleepTime;
+
+        m_workMutex.lock();
+
+        // the snapshot is only looked at while the work mutex is held, so once an engine has been removed from the
+        // published snapshot and the mutex has been acquired by the caller, the engine will not be called again.
+
+        auto engines = std::atomic_load(&m_engines);
+
+        auto currentTime = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+
+        if (engines != m_activeEngines) {
+            m_activeEngines = engines;
+
+            reschedule(currentTime);
+        }
+
+        if ((!m_schedule.empty()) && (m_schedule.front().m_deadline <= currentTime)) {
+            m_dueEntries.clear();
+
+            while ((!m_schedule.empty()) && (m_schedule.front().m_deadline <= currentTime)) {
+                std::pop_heap(m_schedule.begin(), m_schedule.end());
+
+                m_dueEntries.push_back(m_schedule.back());
+
+                m_schedule.pop_back();
+            }
+
+            transmit();
+
+            for (auto &entry : m_dueEntries) {
+                auto interval = entry.m_engine->m_interval;
+
+                entry.m_deadline += interval;
+                entry.m_round++;
+
+                // if the thread fell more than a round behind (for example the machine was suspended), the missed
+                // rounds are skipped rather than being sent in a burst to catch up.
+
+                if (entry.m_deadline <= currentTime) {
+                    auto missedRounds = ((currentTime - entry.m_deadline) / interval) + 1;
+
+                    entry.m_deadline += missedRounds * interval;
+                    entry.m_round += static_cast<uint64_t>(missedRounds);
+                }
+
+                m_nextRounds[entry.m_target] = {entry.m_engine->m_serial, entry.m_round};
+
+                m_schedule.push_back(entry);
+
+                std::push_heap(m_schedule.begin(), m_schedule.end());
+            }
+        }
+
+        if (!m_schedule.empty()) {
+            nextDeadline = std::min(nextDeadline, m_schedule.front().m_deadline);
+        }
+
+        m_workMutex.unlock();
+
+        waitUntil(nextDeadline);
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::reschedule(int64_t currentTime) -> void {
+    std::unordered_map<Nedrysoft::ICMPPingEngine::ICMPPingTarget *, std::pair<uint32_t, uint64_t>> nextRounds;
+
+    m_schedule.clear();
+
+    for (auto &engine : *m_activeEngines) {
+        auto interval = engine.m_interval;
+        auto targetCount = static_cast<int64_t>(engine.m_targets.size());
+
+        for (int64_t targetIndex = 0; targetIndex < targetCount; targetIndex++) {
+            auto target = engine.m_targets[targetIndex];
+            int64_t offset;
+
+            if (target->phaseOffset() >= 0) {
+                offset = (static_cast<int64_t>(target->phaseOffset()) * NsPerMs) % interval;
+            } else {
+                offset = (interval * targetIndex) / targetCount;
+            }
+
+            uint64_t round;
+
+            // the round is only carried over if the target is still registered with the same engine, a target
+            // that was freed may have its address reused by a new target of another engine.
+
+            auto nextRound = m_nextRounds.find(target);
+
+            if ((nextRound != m_nextRounds.end()) &&
+                (nextRound->second.first == engine.m_serial) &&
+                (nextRound->second.second >= engine.m_firstRound)) {
+
+                round = nextRound->second.second;
+            } else {
+                auto elapsedTime = currentTime - engine.m_startTime - offset;
+
+                round = engine.m_firstRound;
+
+                if (elapsedTime > 0) {
+                    round += static_cast<uint64_t>((elapsedTime + interval - 1) / interval);
+                }
+            }
+
+            auto deadline = engine.m_startTime +
+                            (static_cast<int64_t>(round - engine.m_firstRound) * interval) +
+                            offset;
+
+            m_schedule.push_back({deadline, round, target, &engine});
+
+            nextRounds[target] = {engine.m_serial, round};
+        }
+    }
+
+    std::make_heap(m_schedule.begin(), m_schedule.end());
+
+    m_nextRounds.swap(nextRounds);
+}
+
+template <typename Function>
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::updateEngines(Function modify) -> void {
+    // the mutex only serialises writers, the transmitter reads the published snapshot without waiting for them.
+
+    QMutexLocker locker(&m_enginesMutex);
+
+    auto engines = std::make_shared<std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine>>(
+        *std::atomic_load(&m_engines)
+    );
+
+    modify(*engines);
+
+    std::atomic_store(
+        &m_engines,
+        std::shared_ptr<const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine>>(std::move(engines))
+    );
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::addEngine(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        int interval,
+        const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTarget *> &targets) -> void {
+
+    engine->setEpoch(QDateTime::currentDateTime());
+
+    updateEngines([&](std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine> &engines) {
+        engines.push_back({
+            engine,
+            m_nextSerial++,
+            static_cast<int64_t>(std::max(interval, 1)) * NsPerMs,
+            Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp(),
+            0,
+            targets
+        });
+    });
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::removeEngine(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void {
+
+    updateEngines([&](std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine> &engines) {
+        engines.erase(
+            std::remove_if(engines.begin(), engines.end(), [engine](const auto &registeredEngine) {
+                return registeredEngine.m_engine == engine;
+            }),
+            engines.end()
+        );
+    });
+
+    // the transmitter picks up the new snapshot the next time it takes the work mutex, so once the mutex has been
+    // acquired here it can no longer be using the engine.
+
+    QMutexLocker locker(&m_workMutex);
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::setInterval(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        int interval) -> void {
+
+    updateEngines([&](std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine> &engines) {
+        for (auto &registeredEngine : engines) {
+            if (registeredEngine.m_engine != engine) {
+                continue;
+            }
+
+            // the rounds are restarted from now so that the sample numbers continue from where they were.
+
+            auto currentTime = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+            auto elapsedRounds = (currentTime - registeredEngine.m_startTime) / registeredEngine.m_interval;
+
+            registeredEngine.m_firstRound += static_cast<uint64_t>(std::max<int64_t>(elapsedRounds, 0)) + 1;
+            registeredEngine.m_interval = static_cast<int64_t>(std::max(interval, 1)) * NsPerMs;
+            registeredEngine.m_startTime = currentTime;
+        }
+    });
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::addTarget(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        Nedrysoft::ICMPPingEngine::ICMPPingTarget *target) -> void {
+
+    updateEngines([&](std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine> &engines) {
+        for (auto &registeredEngine : engines) {
+            if (registeredEngine.m_engine == engine) {
+                registeredEngine.m_targets.push_back(target);
+            }
+        }
+    });
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::removeTarget(
+        Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+        Nedrysoft::ICMPPingEngine::ICMPPingTarget *target) -> void {
+
+    updateEngines([&](std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine> &engines) {
+        for (auto &registeredEngine : engines) {
+            if (registeredEngine.m_engine == engine) {
+                auto &targets = registeredEngine.m_targets;
+
+                targets.erase(std::remove(targets.begin(), targets.end(), target), targets.end());
+            }
+        }
+    });
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::transmit() -> void {
+    SPDLOG_TRACE("Preparing ping set to " + m_dueEntries.back().m_target->hostAddress().toString().toStdString());
+
+    // the message, socket and item lists are members so that their storage is reused from round to round, and
+    // each target sends from its own prebuilt packet, so a steady state round does not allocate.
+
+    m_messages.clear();
+    m_messageSockets.clear();
+    m_pingItems.clear();
+    m_itemEngines.clear();
+
+    for (auto &entry : m_dueEntries) {
+        auto target = entry.m_target;
+        auto engine = entry.m_engine->m_engine;
+
+        auto pingItem = engine->acquireRequest();
+
+        if (!pingItem) {
+            SPDLOG_ERROR("Unable to allocate a request for " + target->hostAddress().toString().toStdString());
+
+            continue;
         }
 
-        elapsedTimer.restart();
+        // each target sends from its own sequence space, the generation distinguishes the requests that share
+        // a sequence number once the space has wrapped.
 
-        m_targetsMutex.lock();
+        uint16_t generation;
+        auto currentSequenceId = target->nextSequenceId(generation);
 
-        for (auto target : m_targets) {
-            auto socket = target->socket();
+        pingItem->setTarget(target);
+        pingItem->setId(target->id());
+        pingItem->setSequenceId(currentSequenceId);
+        pingItem->setGeneration(generation);
+        pingItem->setSampleNumber(static_cast<unsigned long>(entry.m_round));
 
-            auto pingItem = new Nedrysoft::ICMPPingEngine::ICMPPingItem();
+        pingItem->startTimer();
 
-            m_sequenceMutex.lock();
-            uint16_t currentSequenceId = m_sequenceId++;
-            m_sequenceMutex.unlock();
+        engine->addRequest(pingItem);
+
+        m_pingItems.push_back(pingItem);
+        m_itemEngines.push_back(entry.m_engine);
+
+        auto &echoRequest = target->echoRequest();
+
+        Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest(
+                echoRequest.data(),
+                echoRequest.length(),
+                target->id(),
+                currentSequenceId,
+                generation );
+
+        m_messages.push_back(Nedrysoft::ICMPSocket::ICMPMessage {
+            echoRequest.constData(),
+            echoRequest.length(),
+            target->hostAddress(),
+            target->ttl(),
+            -1
+        });
+
+        if (engine->datagramSocket()) {
+            m_messageSockets.push_back(engine->datagramSocket());
+        } else if (target->hostAddress().protocol() == QAbstractSocket::IPv6Protocol) {
+            m_messageSockets.push_back(writeSocket(Nedrysoft::ICMPSocket::V6));
+        } else {
+            m_messageSockets.push_back(writeSocket(Nedrysoft::ICMPSocket::V4));
+        }
+    }
+
+    // the send timestamps are recorded before the packets are handed to the kernel, so a reply can never be
+    // processed before its request has been stamped.  The wall clock timestamp gives the round trip time against
+    // the receive timestamp of the reply, the monotonic one is what the timeout of the request is measured from.
+
+    auto transmitTimestamp = Nedrysoft::ICMPSocket::ICMPSocket::timestamp();
+    auto sendTime = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+
+    for (auto pingItem : m_pingItems) {
+        pingItem->setTransmitTimestamp(transmitTimestamp);
+        pingItem->setMonotonicTimestamp(sendTime);
+    }
+
+    // the lag between the deadline of each target and the actual send shows how well the transmitter is keeping
+    // up, it grows when the host rather than the network is the bottleneck.
+
+    for (auto &entry : m_dueEntries) {
+        entry.m_engine->m_engine->recordTransmitLag(sendTime - entry.m_deadline);
+    }
+
+    auto messageCount = static_cast<int>(m_messages.size());
+
+    if (m_ring) {
+        // every send and a timeout for each request is queued on the ring and handed to the kernel in a single
+        // call, the kernel serialises the sends so the shared sockets do not need to be locked.  The key of each
+        // timeout carries the serial number of the engine, so an expiry for an engine that has since been removed
+        // is ignored.
+
+        for (auto messageIndex = 0; messageIndex < messageCount; messageIndex++) {
+            auto &message = m_messages[messageIndex];
+
+            if ((!m_messageSockets[messageIndex]) || (!m_ring->queueSend(m_messageSockets[messageIndex], message))) {
+                SPDLOG_ERROR("Unable to send packet to "+message.hostAddress.toString().toStdString());
+            }
+
+            auto pingItem = m_pingItems[messageIndex];
+            auto itemEngine = m_itemEngines[messageIndex];
+
+            m_ring->queueTimeout(
+                (static_cast<uint64_t>(itemEngine->m_serial) << EngineSerialShift) |
+                    Nedrysoft::Utils::fzMake32(pingItem->id(), pingItem->sequenceId()),
+                itemEngine->m_engine->timeout()
+            );
+        }
 
-            pingItem->setTarget(target);
-            pingItem->setId(target->id());
-            pingItem->setSequenceId(currentSequenceId);
-            pingItem->setSampleNumber(sampleNumber);
+        m_ring->wait(m_expiredKeys, 0);
 
-            m_engine->addRequest(pingItem);
+        // the sends complete asynchronously, a failure is reported when the ring collects its completion rather
+        // than here.
 
-            auto buffer = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
-                    target->id(),
-                    currentSequenceId,
-                    52,
-                    target->hostAddress(),
-                    static_cast<Nedrysoft::ICMPPacket::IPVersion>(m_engine->version()) );
+        reportFailedSends();
+    } else {
+        // consecutive messages that share a socket are sent as a single batch.  This is the only thread that sends,
+        // the lock only stops the shared write sockets from being closed by releaseSockets while they are in use.
 
-            auto result = socket->sendto(buffer, target->hostAddress());
+        auto batchStart = 0;
 
-            pingItem->startTimer();
+        m_socketMutex.lock();
+
+        for (auto messageIndex = 1; messageIndex <= messageCount; messageIndex++) {
+            if ((messageIndex == messageCount) ||
+                (m_messageSockets[messageIndex] != m_messageSockets[batchStart])) {
+
+                if (m_messageSockets[batchStart]) {
+                    m_messageSockets[batchStart]->sendBatch(&m_messages[batchStart], messageIndex - batchStart);
+                }
+
+                batchStart = messageIndex;
+            }
+        }
+
+        m_socketMutex.unlock();
+
+        for (auto itemIndex = 0; itemIndex < static_cast<int>(m_pingItems.size()); itemIndex++) {
+            m_itemEngines[itemIndex]->m_engine->scheduleTimeout(m_pingItems[itemIndex]);
+        }
+
+        for (auto messageIndex = 0; messageIndex < messageCount; messageIndex++) {
+            auto &message = m_messages[messageIndex];
 
             SPDLOG_TRACE(
                     QString("Sent ping to %1 (TTL=%2, Result=%3)")
-                    .arg(target->hostAddress().toString())
-                    .arg(socket->ttl()).arg(result)
+                    .arg(message.hostAddress.toString())
+                    .arg(message.ttl).arg(message.result)
                     .toStdString() );
 
-            if (result != buffer.length()) {
-                SPDLOG_ERROR("Unable to send packet to "+target->hostAddress().toString().toStdString());
+            if (message.result != message.length) {
+                SPDLOG_ERROR("Unable to send packet to "+message.hostAddress.toString().toStdString());
+            }
+        }
+    }
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::reportFailedSends() -> void {
+    m_ring->takeFailedSends(m_failedSends);
+
+    for (auto &message : m_failedSends) {
+        SPDLOG_ERROR(
+                QString("Unable to send packet to %1 (TTL=%2, Result=%3)")
+                .arg(message.hostAddress.toString())
+                .arg(message.ttl).arg(message.result)
+                .toStdString() );
+    }
+
+    m_failedSends.clear();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::expireRequests() -> void {
+    if (m_expiredKeys.empty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_workMutex);
+
+    // the engine is found by its serial number in the current snapshot, an engine that has been removed is no
+    // longer present so its expiries are dropped.  A kernel timeout can fire slightly before the engine considers
+    // the request to have timed out, in which case the timeout is queued again for the time that remains.
+
+    auto engines = std::atomic_load(&m_engines);
+
+    for (auto key : m_expiredKeys) {
+        auto serial = static_cast<uint32_t>(key >> EngineSerialShift);
+
+        for (auto &engine : *engines) {
+            if (engine.m_serial == serial) {
+                auto remainingTime = engine.m_engine->expireRequest(static_cast<uint32_t>(key & RequestIdMask));
+
+                if (remainingTime) {
+                    m_ring->queueTimeout(key, remainingTime);
+                }
+
+                break;
             }
         }
+    }
+
+    m_expiredKeys.clear();
+}
+
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::waitUntil(int64_t deadline) -> void {
+    while (m_isRunning) {
+        auto remaining = deadline - Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+
+        if (remaining <= 0) {
+            break;
+        }
+
+        remaining = std::min(remaining, MaximumSleepTime);
+
+        if ((m_ring) && (remaining >= NsPerMs)) {
+            // whole milliseconds are spent waiting on the ring so that requests are expired as their timeouts
+            // fire, the remainder is slept below.
 
-        m_targetsMutex.unlock();
+            m_ring->wait(m_expiredKeys, static_cast<int>(remaining / NsPerMs));
 
-        auto elapsedTime = elapsedTimer.elapsed();
+            reportFailedSends();
+            expireRequests();
 
-        if (elapsedTime < m_interval) {
-            QThread::msleep(m_interval - elapsedTime);
+            continue;
         }
 
-        sampleNumber++;
+        sleepUntil(std::min(deadline, Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() + remaining));
     }
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::setInterval(int interval) -> bool {
-    m_interval = interval;
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::sleepUntil(int64_t deadline) -> void {
+#if defined(Q_OS_LINUX)
+    struct timespec wakeTime = {};
 
-    return true;
+    wakeTime.tv_sec = static_cast<time_t>(deadline / NsPerSecond);
+    wakeTime.tv_nsec = static_cast<long>(deadline % NsPerSecond);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, nullptr) == EINTR) {
+        // restart the sleep, the deadline is absolute so an interruption does not stretch it.
+    }
+#else
+    std::this_thread::sleep_until(
+            std::chrono::steady_clock::time_point(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(deadline))));
+#endif
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::addTarget(Nedrysoft::ICMPPingEngine::ICMPPingTarget *target) -> void {
-    QMutexLocker locker(&m_targetsMutex);
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::writeSocket(
+        Nedrysoft::ICMPSocket::IPVersion version) -> Nedrysoft::ICMPSocket::ICMPSocket * {
+
+    QMutexLocker locker(&m_socketMutex);
 
-    m_targets.append(target);
+    auto &socket = (version == Nedrysoft::ICMPSocket::V6) ? m_writeSocketV6 : m_writeSocketV4;
+
+    if (!socket) {
+        socket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(0, version);
+    }
+
+    return socket;
 }
 
-auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::interval() -> int {
-    return m_interval;
+auto Nedrysoft::ICMPPingEngine::ICMPPingTransmitter::releaseSockets() -> void {
+    QMutexLocker locker(&m_socketMutex);
+
+    delete m_writeSocketV4;
+    delete m_writeSocketV6;
+
+    m_writeSocketV4 = nullptr;
+    m_writeSocketV6 = nullptr;
 }
\ No newline at end of file
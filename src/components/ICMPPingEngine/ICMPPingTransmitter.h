@@ -24,19 +24,41 @@
 #ifndef PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTRANSMITTER_H
 #define PINGNOO_COMPONENTS_ICMPPINGENGINE_ICMPPINGTRANSMITTER_H
 
-#include <PingResult>
+#include "ICMPSocket/ICMPRing.h"
+#include "ICMPSocket/ICMPSocket.h"
 
 #include <QMutex>
 #include <QObject>
+#include <QThread>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Nedrysoft { namespace ICMPPingEngine {
     class ICMPPingEngine;
     class ICMPPingTarget;
     class ICMPPingItem;
+    class ICMPPingTransmitterEngine;
+    class ICMPPingTransmitterEntry;
 
     /**
-     * @brief       The ICMPPingTransmitter class sends pings to the target (and intermediate nodes) at a prescribed
-     *              interval.
+     * @brief       The ICMPPingTransmitter class sends pings to the targets (and intermediate nodes) of every engine
+     *              at their prescribed intervals.
+     *
+     * @details     A single transmitter thread is shared by every engine in the process, engines register their
+     *              targets with it when they are started and receive their results through the shared receiver,
+     *              so the number of threads does not grow with the number of engines.
+     *
+     *              Rather than sending every target in a single burst, the pings of each engine are spread evenly
+     *              across its interval (or sent at the phase offset of each target) so that routers which rate
+     *              limit ICMP are not tripped.  Each send is made at an absolute deadline on the monotonic clock,
+     *              so the sample cadence does not drift over long sessions.
+     *
+     *              The registered engines and targets are published as an immutable snapshot that the transmitter
+     *              picks up between sends, so engines and targets can be added and removed at any time without
+     *              the transmitter having to wait for the caller.
      */
     class ICMPPingTransmitter :
             public QObject {
@@ -44,41 +66,104 @@ namespace Nedrysoft { namespace ICMPPingEngine {
         private:
             Q_OBJECT
 
-        public:
-
+        private:
             /**
-             * @brief       Constructs a new ICMPPingTransmitter for the given engine.
+             * @brief       Constructs the ICMPPingTransmitter.
              *
-             * @param[in]   engine the owner engine.
+             * @note        Hidden as this is a singleton class and should be accessed through getInstance().
              */
-            explicit ICMPPingTransmitter(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine);
+            ICMPPingTransmitter();
 
+        public:
             /**
              * @brief       Destroys the ICMPPingTransmitter.
              */
             ~ICMPPingTransmitter();
 
             /**
-             * @brief       Sets the interval between a set of pings.
+             * @brief       Returns the transmitter, creating and starting its thread on first use.
              *
-             * @param[in]   interval the interval in milliseconds.
+             * @param[in]   returnNull if true then nullptr is returned if the transmitter has not been created.
+             *
+             * @returns     the transmitter.
+             */
+            static auto getInstance(bool returnNull=false) -> Nedrysoft::ICMPPingEngine::ICMPPingTransmitter *;
+
+            /**
+             * @brief       Starts pinging the targets of an engine.
+             *
+             * @param[in]   engine the engine.
+             * @param[in]   interval the interval between a set of pings in milliseconds.
+             * @param[in]   targets the targets to ping.
+             */
+            auto addEngine(
+                Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+                int interval,
+                const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTarget *> &targets
+            ) -> void;
+
+            /**
+             * @brief       Stops pinging the targets of an engine.
+             *
+             * @details     Once this returns the transmitter will not call the engine again, although a request
+             *              that has already been sent may still be answered through the receiver.
+             *
+             * @param[in]   engine the engine.
              */
-            auto setInterval(int interval) -> bool;
+            auto removeEngine(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine) -> void;
 
             /**
-             * @brief       Returns the ping interval.
+             * @brief       Sets the interval between a set of pings for an engine.
              *
-             * @returns     the interval in milliseconds.
+             * @param[in]   engine the engine.
+             * @param[in]   interval the interval in milliseconds.
              */
-            auto interval() -> int;
+            auto setInterval(Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine, int interval) -> void;
 
             /**
-             * @brief       Adds a ping target to the transmitter.
+             * @brief       Adds a ping target to an engine.
              *
+             * @param[in]   engine the engine.
              * @param[in]   target the target to ping.
+             */
+            auto addTarget(
+                Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+                Nedrysoft::ICMPPingEngine::ICMPPingTarget *target
+            ) -> void;
+
+            /**
+             * @brief       Removes a ping target from an engine.
+             *
+             * @note        A send that is in progress may still ping the target, the caller must keep the target
+             *              alive until its outstanding requests have completed.
+             *
+             * @param[in]   engine the engine.
+             * @param[in]   target the target to remove.
+             */
+            auto removeTarget(
+                Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine,
+                Nedrysoft::ICMPPingEngine::ICMPPingTarget *target
+            ) -> void;
+
+            /**
+             * @brief       Returns the shared write socket for the given IP version.
+             *
+             * @details     A single raw socket per address family is shared by every target of every engine, the
+             *              TTL of each ping is carried by the packet rather than the socket.  The socket is created
+             *              on first use.
+             *
+             * @param[in]   version the IP version of the socket.
+             *
+             * @returns     the socket; or nullptr if the socket could not be created.
+             */
+            static auto writeSocket(Nedrysoft::ICMPSocket::IPVersion version) -> Nedrysoft::ICMPSocket::ICMPSocket *;
+
+            /**
+             * @brief       Closes the shared write sockets.
              *
+             * @note        Must only be called once all engines have been stopped.
              */
-            auto addTarget(Nedrysoft::ICMPPingEngine::ICMPPingTarget *target) -> void;
+            static auto releaseSockets() -> void;
 
         private:
 
@@ -87,31 +172,87 @@ namespace Nedrysoft { namespace ICMPPingEngine {
              */
             Q_SLOT void doWork();
 
-        public:
             /**
-             * @brief       This signal is emitted when a transmission result is available.
+             * @brief       Publishes a modified copy of the engine snapshot.
+             *
+             * @param[in]   modify the function that modifies the copy.
+             */
+            template <typename Function>
+            auto updateEngines(Function modify) -> void;
+
+            /**
+             * @brief       Rebuilds the send schedule from the current engine snapshot.
+             *
+             * @details     Targets that were already scheduled continue from the round that they were due to send
+             *              next, new targets join at the next round of their engine.
+             *
+             * @param[in]   currentTime the current time of the monotonic clock in nanoseconds.
+             */
+            auto reschedule(int64_t currentTime) -> void;
+
+            /**
+             * @brief       Sends a ping to each of the targets that are due.
+             */
+            auto transmit() -> void;
+
+            /**
+             * @brief       Passes the requests whose kernel timeouts have expired to their engines.
+             */
+            auto expireRequests() -> void;
+
+            /**
+             * @brief       Logs the sends that the ring has reported as failed.
+             */
+            auto reportFailedSends() -> void;
+
+            /**
+             * @brief       Waits until the monotonic clock reaches the given time or the transmitter is stopped.
              *
-             * @param[in]   result the result.
+             * @details     When the ring is in use the wait is spent collecting expired requests.
+             *
+             * @param[in]   deadline the time in nanoseconds, as returned by ICMPSocket::monotonicTimestamp().
              */
-            Q_SIGNAL void result(Nedrysoft::RouteAnalyser::PingResult result);
+            auto waitUntil(int64_t deadline) -> void;
 
-            friend class ICMPPingEngine;
+            /**
+             * @brief       Sleeps until the monotonic clock reaches the given time.
+             *
+             * @param[in]   deadline the time in nanoseconds, as returned by ICMPSocket::monotonicTimestamp().
+             */
+            static auto sleepUntil(int64_t deadline) -> void;
 
         private:
             //! @cond
 
-            int m_interval;
-            Nedrysoft::ICMPPingEngine::ICMPPingEngine *m_engine;
+            QThread *m_transmitterThread;
+
+            std::shared_ptr<const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine>> m_engines;
+            QMutex m_enginesMutex;
+            uint32_t m_nextSerial;
+
+            std::shared_ptr<const std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine>> m_activeEngines;
+            QMutex m_workMutex;
+
+            std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEntry> m_schedule;
+            std::vector<Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEntry> m_dueEntries;
+            std::unordered_map<
+                Nedrysoft::ICMPPingEngine::ICMPPingTarget *,
+                std::pair<uint32_t, uint64_t>
+            > m_nextRounds;
 
-            QList<Nedrysoft::ICMPPingEngine::ICMPPingTarget *> m_targets;
-            QMutex m_targetsMutex;
+            std::vector<Nedrysoft::ICMPSocket::ICMPMessage> m_messages;
+            std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> m_messageSockets;
+            std::vector<Nedrysoft::ICMPPingEngine::ICMPPingItem *> m_pingItems;
+            std::vector<const Nedrysoft::ICMPPingEngine::ICMPPingTransmitterEngine *> m_itemEngines;
+            std::vector<uint64_t> m_expiredKeys;
+            std::vector<Nedrysoft::ICMPSocket::ICMPMessage> m_failedSends;
 
-            QDateTime m_epoch;
+            Nedrysoft::ICMPSocket::ICMPRing *m_ring;
 
-            static QMutex m_sequenceMutex;
-            static uint16_t m_sequenceId;
+            static QMutex m_socketMutex;
+            static Nedrysoft::ICMPSocket::ICMPSocket *m_writeSocketV4;
+            static Nedrysoft::ICMPSocket::ICMPSocket *m_writeSocketV6;
 
-        protected:
             bool m_isRunning;
 
             //! @endcond
@@ -44,7 +44,21 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::PingCommandPingEngine(N
 }
 
 Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::~PingCommandPingEngine() {
+    // every target is told to stop first so that their pings wind down together, deleting a target then waits
+    // for its worker thread, which in turn waits for the pings it started.  removed targets that have not yet
+    // deleted themselves are included, they take themselves off the list as they are destroyed.
 
+    auto targets = m_pingTargets + m_removedTargets;
+
+    for (auto target : targets) {
+        target->m_quitThread = true;
+    }
+
+    m_pingTargets.clear();
+
+    for (auto target : targets) {
+        delete target;
+    }
 }
 
 auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::addTarget(
@@ -71,7 +85,20 @@ auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::addTarget(
 auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::removeTarget(
         Nedrysoft::RouteAnalyser::IPingTarget *target ) -> bool {
 
-    Q_UNUSED(target)
+    auto pingTarget = qobject_cast<Nedrysoft::PingCommandPingEngine::PingCommandPingTarget *>(target);
+
+    if (!m_pingTargets.contains(pingTarget)) {
+        return false;
+    }
+
+    // the worker thread of the target finishes after its current ping and deletes the target once the pings that
+    // are still in progress have completed.
+
+    m_pingTargets.removeAll(pingTarget);
+    m_removedTargets.append(pingTarget);
+
+    pingTarget->m_isRemoved = true;
+    pingTarget->m_quitThread = true;
 
     return true;
 }
@@ -114,6 +141,16 @@ auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::loadConfiguration(
     return true;
 }
 
+auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::statistics() ->
+        Nedrysoft::RouteAnalyser::PingEngineStatistics {
+
+    return m_statistics.statistics();
+}
+
+auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::resetStatistics() -> void {
+    m_statistics.reset();
+}
+
 auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngine::emitResult(
         Nedrysoft::RouteAnalyser::PingResult pingResult) -> void {
 
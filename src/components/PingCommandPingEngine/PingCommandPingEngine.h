@@ -27,6 +27,8 @@
 #include <IInterface>
 #include <IPingEngine>
 #include <IPingEngineFactory>
+#include <IPingEngineStatistics>
+#include <PingEngineStatisticsRecorder>
 
 namespace Nedrysoft { namespace PingCommandPingEngine {
     class PingCommandPingTarget;
@@ -35,12 +37,14 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
      * @brief       THe PingCommandPingEngine provides a command based ping engine implementation.
      */
     class PingCommandPingEngine :
-            public Nedrysoft::RouteAnalyser::IPingEngine {
+            public Nedrysoft::RouteAnalyser::IPingEngine,
+            public Nedrysoft::RouteAnalyser::IPingEngineStatistics {
 
         private:
             Q_OBJECT
 
             Q_INTERFACES(Nedrysoft::RouteAnalyser::IPingEngine)
+            Q_INTERFACES(Nedrysoft::RouteAnalyser::IPingEngineStatistics)
 
         public:
             /**
@@ -50,6 +54,9 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
 
             /**
              * @brief       Destroys the PingCommandPingEngine.
+             *
+             * @note        The ping threads of the targets refer to the engine, so the destructor blocks until the
+             *              pings that are in progress have completed.
              */
             ~PingCommandPingEngine();
 
@@ -190,6 +197,23 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
              */
             auto loadConfiguration(QJsonObject configuration) -> bool override;
 
+        public:
+            /**
+             * @brief       Returns a snapshot of the statistics of the engine.
+             *
+             * @see         Nedrysoft::RouteAnalyser::IPingEngineStatistics::statistics
+             *
+             * @returns     the statistics.
+             */
+            auto statistics() -> Nedrysoft::RouteAnalyser::PingEngineStatistics override;
+
+            /**
+             * @brief       Resets the counters and histograms of the engine.
+             *
+             * @see         Nedrysoft::RouteAnalyser::IPingEngineStatistics::resetStatistics
+             */
+            auto resetStatistics() -> void override;
+
         private:
             auto emitResult(Nedrysoft::RouteAnalyser::PingResult pingResult) -> void;
 
@@ -199,9 +223,12 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
             //! @cond
 
             QList<PingCommandPingTarget *> m_pingTargets;
+            QList<PingCommandPingTarget *> m_removedTargets;
 
             int m_interval;
 
+            Nedrysoft::RouteAnalyser::PingEngineStatisticsRecorder m_statistics;
+
             //! @endcond
     };
 }}
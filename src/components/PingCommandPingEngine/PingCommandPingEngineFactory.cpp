@@ -75,5 +75,14 @@ auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngineFactory::available()
 auto Nedrysoft::PingCommandPingEngine::PingCommandPingEngineFactory::deleteEngine(
         Nedrysoft::RouteAnalyser::IPingEngine *engine) -> bool {
 
+    auto pingEngine = qobject_cast<Nedrysoft::PingCommandPingEngine::PingCommandPingEngine *>(engine);
+
+    if (!pingEngine) {
+        return false;
+    }
+
+    pingEngine->stop();
+    pingEngine->deleteLater();
+
     return true;
 }
@@ -39,6 +39,7 @@
 
 constexpr auto ReplyTimeout = 3;
 constexpr auto NanosecondsInMillisecond = 1.0e6;
+constexpr auto ActivePingsPollInterval = 50;
 constexpr auto PacketLostRegularExpression = R"(100% packet loss)";
 constexpr auto TtlExceededRegularExpression = R"(From\ (?<ip>[\d\.]*)\ .*exceeded)";
 
@@ -48,6 +49,8 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
         int ttl) :
             m_userdata(nullptr),
             m_quitThread(false),
+            m_isRemoved(false),
+            m_activePings(0),
             m_engine(engine),
             m_ttl(ttl),
             m_hostAddress(hostAddress) {
@@ -66,7 +69,21 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
 
         int sampleNumber = 0;
 
+        QElapsedTimer scheduleTimer;
+
+        scheduleTimer.start();
+
         while(!m_quitThread) {
+            // the lag is how much longer than the interval it took to get round to the next ping.
+
+            if (sampleNumber) {
+                auto intervalTime = static_cast<qint64>(engine->interval() * NanosecondsInMillisecond);
+
+                engine->m_statistics.recordTransmitLag(scheduleTimer.nsecsElapsed() - intervalTime);
+
+                scheduleTimer.restart();
+            }
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
             QThread *pingThread = QThread::create([sampleNumber, pingArguments, engine, pingThread, this]() {
 #else
@@ -79,6 +96,8 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
 
                // pingProcess = new QProcess();
 
+                engine->m_statistics.recordSent();
+
                 pingProcess.start("ping", pingArguments);
 
                 pingProcess.waitForStarted();
@@ -99,6 +118,8 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
                 QRegularExpression packetLostRegEx(PacketLostRegularExpression);
 
                 if (pingProcess.exitCode() == 0) {
+                    engine->m_statistics.recordReply(roundTripTime);
+
                     auto pingResult = Nedrysoft::RouteAnalyser::PingResult(
                         sampleNumber,
                         Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok,
@@ -114,6 +135,8 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
                     auto packetLostMatch = packetLostRegEx.match(commandOutput);
 
                     if (ttlExceededMatch.hasMatch()) {
+                        engine->m_statistics.recordReply(roundTripTime);
+
                         auto pingResult = Nedrysoft::RouteAnalyser::PingResult(
                             sampleNumber,
                             Nedrysoft::RouteAnalyser::PingResult::ResultCode::TimeExceeded,
@@ -125,6 +148,8 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
 
                         engine->emitResult(pingResult);
                     } else if (packetLostMatch.hasMatch()) {
+                        engine->m_statistics.recordTimeout();
+
                         auto pingResult = Nedrysoft::RouteAnalyser::PingResult(
                             sampleNumber,
                             Nedrysoft::RouteAnalyser::PingResult::ResultCode::NoReply,
@@ -137,14 +162,20 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
                         engine->emitResult(pingResult);
                     } else {
                         // some other error
+
+                        engine->m_statistics.recordCancelled(1);
                     }
                 }
+
+                m_activePings--;
 #if QT_VERSION < QT_VERSION_CHECK(5, 10, 0)
                 QTimer::singleShot(0, [=]() {
                     delete pingThread;
                 });
 #endif
             });
+
+            m_activePings++;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
             QObject::connect(pingThread, &QThread::finished, pingThread, &QThread::deleteLater);
 
@@ -156,6 +187,21 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
 #endif
             sampleNumber++;
         }
+
+        // pings that are still in progress refer to the target, so a removed target is only deleted once they
+        // have finished.
+
+        while (m_activePings) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+            QThread::msleep(ActivePingsPollInterval);
+#else
+            std::this_thread::sleep_for(std::chrono::milliseconds(ActivePingsPollInterval));
+#endif
+        }
+
+        if (m_isRemoved) {
+            deleteLater();
+        }
     });
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
@@ -164,7 +210,19 @@ Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::PingCommandPingTarget(
 }
 
 Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::~PingCommandPingTarget() {
+    m_quitThread = true;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    m_workerThread->wait();
+#else
+    m_workerThread->join();
+#endif
+
+    delete m_workerThread;
 
+    if (m_isRemoved) {
+        m_engine->m_removedTargets.removeAll(this);
+    }
 }
 
 auto Nedrysoft::PingCommandPingEngine::PingCommandPingTarget::setHostAddress(QHostAddress hostAddress) -> void {
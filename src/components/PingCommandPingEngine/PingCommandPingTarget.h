@@ -26,6 +26,8 @@
 
 #include <IPingTarget>
 
+#include <atomic>
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
 #include <QThread>
 #else
@@ -138,6 +140,8 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
              */
             auto loadConfiguration(QJsonObject configuration) -> bool override;
 
+            friend class PingCommandPingEngine;
+
         private:
             //! @cond
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
@@ -146,7 +150,9 @@ namespace Nedrysoft { namespace PingCommandPingEngine {
             std::thread *m_workerThread;
 #endif
             void *m_userdata;
-            bool m_quitThread;
+            std::atomic<bool> m_quitThread;
+            std::atomic<bool> m_isRemoved;
+            std::atomic<int> m_activePings;
             PingCommandPingEngine *m_engine;
             int m_ttl;
             QHostAddress m_hostAddress;
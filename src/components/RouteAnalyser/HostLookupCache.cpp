@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostLookupCache.h"
+
+Nedrysoft::RouteAnalyser::HostLookupCache::HostLookupCache(
+        int maximumEntries,
+        int maximumActiveLookups,
+        qint64 resolvedTimeToLive,
+        qint64 unresolvedTimeToLive,
+        Nedrysoft::RouteAnalyser::HostInfoResolvedFunction isResolved ) :
+            m_maximumEntries(maximumEntries),
+            m_maximumActiveLookups(maximumActiveLookups),
+            m_resolvedTimeToLive(resolvedTimeToLive),
+            m_unresolvedTimeToLive(unresolvedTimeToLive),
+            m_isResolved(isResolved) {
+
+}
+
+Nedrysoft::RouteAnalyser::HostLookupCache::~HostLookupCache() {
+    for (auto lookupId : m_activeLookups.keys()) {
+        QHostInfo::abortHostLookup(lookupId);
+    }
+}
+
+auto Nedrysoft::RouteAnalyser::HostLookupCache::lookup(
+        const QString &host,
+        QObject *context,
+        Nedrysoft::RouteAnalyser::HostInfoFunction function ) -> void {
+
+    auto entry = m_cache.find(host);
+
+    if (entry != m_cache.end()) {
+        auto timeToLive = entry->m_isResolved ? m_resolvedTimeToLive : m_unresolvedTimeToLive;
+
+        if (entry->m_age.elapsed() < timeToLive) {
+            m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, entry->m_recentlyUsed);
+
+            function(entry->m_hostInfo, entry->m_isResolved);
+
+            return;
+        }
+
+        m_recentlyUsed.erase(entry->m_recentlyUsed);
+        m_cache.erase(entry);
+    }
+
+    // a request for a host that is already queued or being looked up waits for that lookup.
+
+    auto &requests = m_requests[host];
+
+    if (requests.isEmpty()) {
+        m_queue.enqueue(host);
+    }
+
+    requests.append(HostLookupRequest{context, function});
+
+    startLookups();
+}
+
+auto Nedrysoft::RouteAnalyser::HostLookupCache::clear() -> void {
+    m_cache.clear();
+    m_recentlyUsed.clear();
+}
+
+auto Nedrysoft::RouteAnalyser::HostLookupCache::startLookups() -> void {
+    while ((m_activeLookups.count() < m_maximumActiveLookups) && (!m_queue.isEmpty())) {
+        auto host = m_queue.dequeue();
+
+        auto lookupId = QHostInfo::lookupHost(host, this, SLOT(onLookupFinished(QHostInfo)));
+
+        m_activeLookups[lookupId] = host;
+    }
+}
+
+auto Nedrysoft::RouteAnalyser::HostLookupCache::onLookupFinished(const QHostInfo &hostInfo) -> void {
+    if (!m_activeLookups.contains(hostInfo.lookupId())) {
+        return;
+    }
+
+    auto host = m_activeLookups.take(hostInfo.lookupId());
+    auto isResolved = m_isResolved(host, hostInfo);
+
+    insert(host, hostInfo, isResolved);
+
+    auto requests = m_requests.take(host);
+
+    for (auto &request : requests) {
+        if (request.m_context) {
+            request.m_function(hostInfo, isResolved);
+        }
+    }
+
+    startLookups();
+}
+
+auto Nedrysoft::RouteAnalyser::HostLookupCache::insert(
+        const QString &host,
+        const QHostInfo &hostInfo,
+        bool isResolved ) -> void {
+
+    auto entry = m_cache.find(host);
+
+    if (entry != m_cache.end()) {
+        m_recentlyUsed.erase(entry->m_recentlyUsed);
+    } else {
+        entry = m_cache.insert(host, HostLookupCacheEntry());
+    }
+
+    m_recentlyUsed.push_front(host);
+
+    entry->m_hostInfo = hostInfo;
+    entry->m_isResolved = isResolved;
+    entry->m_age.start();
+    entry->m_recentlyUsed = m_recentlyUsed.begin();
+
+    while (m_cache.count() > m_maximumEntries) {
+        m_cache.remove(m_recentlyUsed.back());
+        m_recentlyUsed.pop_back();
+    }
+}
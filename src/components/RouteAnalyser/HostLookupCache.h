@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTLOOKUPCACHE_H
+#define PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTLOOKUPCACHE_H
+
+#include "RouteAnalyserSpec.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostInfo>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <functional>
+#include <list>
+
+namespace Nedrysoft { namespace RouteAnalyser {
+    using HostInfoFunction = std::function<void(const QHostInfo &, bool)>;
+    using HostInfoResolvedFunction = std::function<bool(const QString &, const QHostInfo &)>;
+
+    /**
+     * @brief       The HostLookupCache class performs and caches host lookups for the resolvers.
+     *
+     * @details     Lookups are queued and at most a fixed number are in progress at any time, a request for a host
+     *              that is already queued or being looked up waits for that lookup rather than starting another.
+     *
+     *              Answers are kept in a least recently used cache, hosts that could not be resolved are cached
+     *              too (for a shorter time) so that they are not looked up again straight away.  Lookups that are
+     *              still in progress are aborted when the cache is destroyed.
+     *
+     * @note        The cache must only be used from the thread that created it.
+     */
+    class NEDRYSOFT_ROUTEANALYSER_DLLSPEC HostLookupCache :
+            public QObject {
+
+        private:
+            Q_OBJECT
+
+        public:
+            /**
+             * @brief       Constructs a new HostLookupCache.
+             *
+             * @param[in]   maximumEntries the number of answers that are kept.
+             * @param[in]   maximumActiveLookups the number of lookups that may be in progress at once.
+             * @param[in]   resolvedTimeToLive the time in milliseconds that a resolved answer is kept.
+             * @param[in]   unresolvedTimeToLive the time in milliseconds that an unresolved answer is kept.
+             * @param[in]   isResolved the function that decides whether the answer for a host resolved it.
+             */
+            HostLookupCache(
+                int maximumEntries,
+                int maximumActiveLookups,
+                qint64 resolvedTimeToLive,
+                qint64 unresolvedTimeToLive,
+                Nedrysoft::RouteAnalyser::HostInfoResolvedFunction isResolved
+            );
+
+            /**
+             * @brief       Destroys the HostLookupCache.
+             */
+            ~HostLookupCache();
+
+            /**
+             * @brief       Looks up a host.
+             *
+             * @details     If the answer is cached then the function is called before this returns; otherwise
+             *              it is called once the lookup has completed.
+             *
+             * @param[in]   host the host name or address to look up, this is also the key of the answer.
+             * @param[in]   context the function is not called if this object has been destroyed.
+             * @param[in]   function the function called with the answer and whether it resolved the host.
+             */
+            auto lookup(
+                const QString &host,
+                QObject *context,
+                Nedrysoft::RouteAnalyser::HostInfoFunction function
+            ) -> void;
+
+            /**
+             * @brief       Removes every answer from the cache.
+             */
+            auto clear() -> void;
+
+        private:
+            /**
+             * @brief       Called when a lookup has completed.
+             *
+             * @param[in]   hostInfo the result of the lookup.
+             */
+            Q_SLOT void onLookupFinished(const QHostInfo &hostInfo);
+
+            /**
+             * @brief       Starts the queued lookups while there are free lookup slots.
+             */
+            auto startLookups() -> void;
+
+            /**
+             * @brief       Adds or replaces a cached answer, removing the least recently used answer if full.
+             *
+             * @param[in]   host the host the answer is for.
+             * @param[in]   hostInfo the answer.
+             * @param[in]   isResolved true if the answer resolved the host; otherwise false.
+             */
+            auto insert(const QString &host, const QHostInfo &hostInfo, bool isResolved) -> void;
+
+        private:
+            /**
+             * @brief       A cached answer.
+             */
+            struct HostLookupCacheEntry {
+                QHostInfo m_hostInfo;
+                bool m_isResolved;
+                QElapsedTimer m_age;
+                std::list<QString>::iterator m_recentlyUsed;
+            };
+
+            /**
+             * @brief       A caller waiting for a lookup.
+             */
+            struct HostLookupRequest {
+                QPointer<QObject> m_context;
+                Nedrysoft::RouteAnalyser::HostInfoFunction m_function;
+            };
+
+        private:
+            //! @cond
+
+            int m_maximumEntries;
+            int m_maximumActiveLookups;
+            qint64 m_resolvedTimeToLive;
+            qint64 m_unresolvedTimeToLive;
+            Nedrysoft::RouteAnalyser::HostInfoResolvedFunction m_isResolved;
+
+            QHash<QString, HostLookupCacheEntry> m_cache;
+            std::list<QString> m_recentlyUsed;
+
+            QHash<QString, QList<HostLookupRequest>> m_requests;
+            QQueue<QString> m_queue;
+            QHash<int, QString> m_activeLookups;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTLOOKUPCACHE_H
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostNameResolver.h"
+
+#include <QHostInfo>
+
+constexpr auto MaximumActiveLookups = 4;
+constexpr auto MaximumEntries = 1024;
+constexpr auto ResolvedTimeToLive = 3600*1000;
+constexpr auto UnresolvedTimeToLive = 300*1000;
+
+Nedrysoft::RouteAnalyser::HostNameResolver::HostNameResolver() :
+        m_lookupCache(
+            MaximumEntries,
+            MaximumActiveLookups,
+            ResolvedTimeToLive,
+            UnresolvedTimeToLive,
+            [](const QString &host, const QHostInfo &hostInfo) {
+                // the resolver returns the address itself when there is no name for it, which is cached as a
+                // negative answer.
+
+                auto hostName = hostInfo.hostName();
+
+                return (hostInfo.error() == QHostInfo::NoError) && (!hostName.isEmpty()) && (hostName != host);
+            } ) {
+
+}
+
+Nedrysoft::RouteAnalyser::HostNameResolver::~HostNameResolver() {
+
+}
+
+auto Nedrysoft::RouteAnalyser::HostNameResolver::getInstance() -> Nedrysoft::RouteAnalyser::HostNameResolver * {
+    static auto instance = new Nedrysoft::RouteAnalyser::HostNameResolver;
+
+    return instance;
+}
+
+auto Nedrysoft::RouteAnalyser::HostNameResolver::lookup(
+        const QHostAddress &hostAddress,
+        QObject *context,
+        Nedrysoft::RouteAnalyser::HostNameFunction function ) -> void {
+
+    m_lookupCache.lookup(
+        hostAddress.toString(),
+        context,
+        [hostAddress, function](const QHostInfo &hostInfo, bool isResolved) {
+            function(hostAddress, isResolved ? hostInfo.hostName() : hostAddress.toString());
+        }
+    );
+}
+
+auto Nedrysoft::RouteAnalyser::HostNameResolver::clear() -> void {
+    m_lookupCache.clear();
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTNAMERESOLVER_H
+#define PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTNAMERESOLVER_H
+
+#include "HostLookupCache.h"
+
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <functional>
+
+namespace Nedrysoft { namespace RouteAnalyser {
+    using HostNameFunction = std::function<void(const QHostAddress &, const QString &)>;
+
+    /**
+     * @brief       The HostNameResolver class looks up the host names of addresses without blocking the caller.
+     *
+     * @details     Reverse lookups are queued and at most a small number are in progress at any time, so a long
+     *              route (or many routes opened at once) does not flood the system resolver.  Requests for an
+     *              address that is already being looked up wait for that lookup rather than starting another.
+     *
+     *              Answers are kept in a least recently used cache, addresses that have no host name are cached
+     *              too (for a shorter time) so that unnamed routers are not looked up again for every route.
+     *
+     * @see         Nedrysoft::RouteAnalyser::HostLookupCache
+     *
+     * @note        The resolver must only be used from the main thread.
+     */
+    class HostNameResolver :
+            public QObject {
+
+        private:
+            Q_OBJECT
+
+        private:
+            /**
+             * @brief       Constructs a new HostNameResolver.
+             *
+             * @note        Hidden as this is a singleton class and should be accessed through getInstance().
+             */
+            HostNameResolver();
+
+        public:
+            /**
+             * @brief       Destroys the HostNameResolver.
+             */
+            ~HostNameResolver();
+
+            /**
+             * @brief       Returns the resolver, creating it on first use.
+             *
+             * @returns     the resolver.
+             */
+            static auto getInstance() -> Nedrysoft::RouteAnalyser::HostNameResolver *;
+
+            /**
+             * @brief       Looks up the host name of an address.
+             *
+             * @details     If the answer is cached then the function is called before this returns; otherwise
+             *              it is called once the lookup has completed.
+             *
+             * @param[in]   hostAddress the address to look up.
+             * @param[in]   context the function is not called if this object has been destroyed.
+             * @param[in]   function the function called with the address and its host name, the host name is the
+             *              address itself if it has no name.
+             */
+            auto lookup(
+                const QHostAddress &hostAddress,
+                QObject *context,
+                Nedrysoft::RouteAnalyser::HostNameFunction function
+            ) -> void;
+
+            /**
+             * @brief       Removes every answer from the cache.
+             */
+            auto clear() -> void;
+
+        private:
+            //! @cond
+
+            Nedrysoft::RouteAnalyser::HostLookupCache m_lookupCache;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEANALYSER_HOSTNAMERESOLVER_H
@@ -104,7 +104,7 @@ namespace Nedrysoft { namespace RouteAnalyser {
              *
              * @param[in]   hostAddress the host address of the ping target.
              *
-             * @returns     returns a pointer to the created ping target.
+             * @returns     returns a pointer to the created ping target; or nullptr if the target could not be added.
              */
             virtual auto addTarget(QHostAddress hostAddress) -> IPingTarget * = 0;
 
@@ -114,7 +114,7 @@ namespace Nedrysoft { namespace RouteAnalyser {
              * @param[in]   hostAddress the host address of the ping target.
              * @param[in]   ttl the time to live to use.
              *
-             * @returns     returns a pointer to the created ping target.
+             * @returns     returns a pointer to the created ping target; or nullptr if the target could not be added.
              */
             virtual auto addTarget(QHostAddress hostAddress, int ttl) -> IPingTarget * = 0;
 
@@ -154,10 +154,23 @@ namespace Nedrysoft { namespace RouteAnalyser {
             /**
              * @brief       Signal emitted to indicate the state of a ping request.
              *
+             * @note        An engine delivers each result through either this signal or the results signal, never
+             *              both, so a consumer should connect to both.
+             *
              * @param[in]   result the result of a ping request.
              */
             Q_SIGNAL void result(Nedrysoft::RouteAnalyser::PingResult result);
 
+            /**
+             * @brief       Signal emitted with the results of the ping requests that completed since the last batch.
+             *
+             * @details     Engines that produce results at a high rate collect them and emit a batch periodically,
+             *              so a consumer in another thread receives one event per batch rather than one per result.
+             *
+             * @param[in]   results the results, in the order that they completed.
+             */
+            Q_SIGNAL void results(Nedrysoft::RouteAnalyser::PingResultList results);
+
             /**
              * @brief       Returns the list of ping targets for the engine.
              *
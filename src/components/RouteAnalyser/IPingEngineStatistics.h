@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEANALYSER_IPINGENGINESTATISTICS_H
+#define PINGNOO_COMPONENTS_ROUTEANALYSER_IPINGENGINESTATISTICS_H
+
+#include "RouteAnalyserSpec.h"
+
+#include <QObject>
+#include <array>
+#include <cstdint>
+
+namespace Nedrysoft { namespace RouteAnalyser {
+    /**
+     * @brief       The number of buckets in the latency histogram of an engine.
+     */
+    constexpr auto LatencyBucketCount = 13;
+
+    /**
+     * @brief       The upper bound (exclusive) of each latency bucket in milliseconds, the final bucket holds every
+     *              round trip time from the last bound upwards.
+     */
+    constexpr std::array<int, LatencyBucketCount - 1> LatencyBucketLimits = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+    };
+
+    /**
+     * @brief       The PingEngineStatistics structure is a snapshot of the counters of a ping engine.
+     *
+     * @details     Times are in nanoseconds.  The transmit lag is how far behind its schedule the engine sent each
+     *              probe, a lag that grows while replies stay fast points at an overloaded host rather than at the
+     *              network.
+     */
+    struct PingEngineStatistics {
+        uint64_t sent;
+        uint64_t replies;
+        uint64_t timeouts;
+        uint64_t late;
+        uint64_t duplicates;
+        int64_t inFlight;
+        int64_t averageTransmitLag;
+        int64_t maximumTransmitLag;
+        std::array<uint64_t, LatencyBucketCount> latencyHistogram;
+    };
+
+    /**
+     * @brief       The IPingEngineStatistics interface is implemented by ping engines that can report their internal
+     *              counters.
+     *
+     * @details     The interface is implemented alongside Nedrysoft::RouteAnalyser::IPingEngine, so it is obtained
+     *              by calling qobject_cast on the engine, which returns nullptr if the engine does not provide
+     *              statistics.
+     *
+     * @class       Nedrysoft::RouteAnalyser::IPingEngineStatistics IPingEngineStatistics.h <IPingEngineStatistics>
+     */
+    class NEDRYSOFT_ROUTEANALYSER_DLLSPEC IPingEngineStatistics {
+        public:
+            /**
+             * @brief       Returns a snapshot of the statistics of the engine.
+             *
+             * @note        May be called from any thread, the counters are read without locking so the fields of
+             *              the snapshot may be a few events apart from each other.
+             *
+             * @returns     the statistics.
+             */
+            virtual auto statistics() -> Nedrysoft::RouteAnalyser::PingEngineStatistics = 0;
+
+            /**
+             * @brief       Resets the counters and histograms of the engine.
+             *
+             * @note        The number of requests in flight is not reset.
+             */
+            virtual auto resetStatistics() -> void = 0;
+
+            // Classes with virtual functions should not have a public non-virtual destructor:
+            virtual ~IPingEngineStatistics() = default;
+    };
+}}
+
+Q_DECLARE_INTERFACE(Nedrysoft::RouteAnalyser::IPingEngineStatistics, "com.nedrysoft.routeanalyser.IPingEngineStatistics/1.0.0")
+
+#endif // PINGNOO_COMPONENTS_ROUTEANALYSER_IPINGENGINESTATISTICS_H
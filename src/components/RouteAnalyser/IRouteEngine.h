@@ -69,6 +69,16 @@ namespace Nedrysoft { namespace RouteAnalyser {
                     QString host,
                     Nedrysoft::Core::IPVersion ipVersion ) -> void = 0;
 
+            /**
+             * @brief       Sets how often the route is discovered again once the initial discovery has completed.
+             *
+             * @details     Each rediscovery runs in the background at low priority, the routeChanged signal is
+             *              emitted if it finds a route that differs from the one last reported.
+             *
+             * @param[in]   interval the interval in milliseconds; or 0 to disable rediscovery (the default).
+             */
+            virtual auto setRefreshInterval(int interval) -> void = 0;
+
             /**
              * @brief       Signal emitted when the route discovery is completed.
              *
@@ -86,6 +96,19 @@ namespace Nedrysoft { namespace RouteAnalyser {
                 const int totalHops,
                 const int maximumHops
             );
+
+            /**
+             * @brief       Signal emitted when a rediscovery finds that the route to the host has changed.
+             *
+             * @note        Only emitted after the result signal has reported a completed route.
+             *
+             * @param[in]   hostAddress the address of the host that was the target.
+             * @param[in]   route the new route to the host.
+             */
+            Q_SIGNAL void routeChanged(
+                const QHostAddress hostAddress,
+                const Nedrysoft::RouteAnalyser::RouteList route
+            );
     };
 }}
 
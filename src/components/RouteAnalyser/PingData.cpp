@@ -292,6 +292,10 @@ auto Nedrysoft::RouteAnalyser::PingData::setPlots(QList<Nedrysoft::RouteAnalyser
     m_plots = plots;
 }
 
+auto Nedrysoft::RouteAnalyser::PingData::plots() -> QList<Nedrysoft::RouteAnalyser::IPlot *> {
+    return m_plots;
+}
+
 auto Nedrysoft::RouteAnalyser::PingData::setMaximum(
         Nedrysoft::RouteAnalyser::PingData::Fields field,
         bool isMaximum ) -> void {
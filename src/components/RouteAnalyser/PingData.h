@@ -252,6 +252,13 @@ namespace Nedrysoft { namespace RouteAnalyser {
              */
             auto setPlots(QList<Nedrysoft::RouteAnalyser::IPlot *> plots) -> void;
 
+            /**
+             * @brief       Returns the plots associated with this.
+             *
+             * @returns     the plots.
+             */
+            auto plots() -> QList<Nedrysoft::RouteAnalyser::IPlot *>;
+
             /**
              * @brief       Returns whether this item for the given field is the maximum value.
              *
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PingEngineDiagnosticsWidget.h"
+
+#include "IPingEngine.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QVBoxLayout>
+
+constexpr auto DefaultUpdateInterval = 1000;
+constexpr auto NanosecondsInMillisecond = 1.0e6;
+
+Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget::PingEngineDiagnosticsWidget(QWidget *parent) :
+        QWidget(parent),
+        m_updateTimer(new QTimer(this)) {
+
+    auto countersLayout = new QFormLayout;
+
+    auto addRow = [](QFormLayout *layout, const QString &text) -> QLabel * {
+        auto valueLabel = new QLabel;
+
+        valueLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        layout->addRow(text, valueLabel);
+
+        return valueLabel;
+    };
+
+    m_sentLabel = addRow(countersLayout, tr("Sent"));
+    m_repliesLabel = addRow(countersLayout, tr("Replies"));
+    m_timeoutsLabel = addRow(countersLayout, tr("Timeouts"));
+    m_lateLabel = addRow(countersLayout, tr("Late replies"));
+    m_duplicatesLabel = addRow(countersLayout, tr("Duplicate replies"));
+    m_inFlightLabel = addRow(countersLayout, tr("In flight"));
+    m_transmitLagLabel = addRow(countersLayout, tr("Transmit lag (average/maximum)"));
+
+    auto histogramLayout = new QFormLayout;
+
+    for (auto bucket = 0; bucket < LatencyBucketCount; bucket++) {
+        QString text;
+
+        if (bucket < LatencyBucketCount - 1) {
+            text = tr("< %1 ms").arg(LatencyBucketLimits[bucket]);
+        } else {
+            text = tr(">= %1 ms").arg(LatencyBucketLimits[bucket - 1]);
+        }
+
+        m_latencyLabels[bucket] = addRow(histogramLayout, text);
+    }
+
+    auto resetButton = new QPushButton(tr("Reset"));
+
+    connect(resetButton, &QPushButton::clicked, [=]() {
+        auto statistics = engineStatistics();
+
+        if (statistics) {
+            statistics->resetStatistics();
+        }
+
+        updateStatistics();
+    });
+
+    countersLayout->addRow(QString(), resetButton);
+
+    auto horizontalLayout = new QHBoxLayout;
+
+    horizontalLayout->addLayout(countersLayout);
+    horizontalLayout->addLayout(histogramLayout);
+    horizontalLayout->addStretch();
+
+    auto verticalLayout = new QVBoxLayout;
+
+    verticalLayout->addLayout(horizontalLayout);
+    verticalLayout->addStretch();
+
+    setLayout(verticalLayout);
+
+    m_updateTimer->setInterval(DefaultUpdateInterval);
+
+    connect(m_updateTimer, &QTimer::timeout, [=]() {
+        updateStatistics();
+    });
+}
+
+Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget::~PingEngineDiagnosticsWidget() {
+    m_updateTimer->stop();
+}
+
+auto Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget::setEngine(
+        Nedrysoft::RouteAnalyser::IPingEngine *engine ) -> bool {
+
+    m_engine = engine;
+
+    if (!engineStatistics()) {
+        m_updateTimer->stop();
+
+        return false;
+    }
+
+    updateStatistics();
+
+    m_updateTimer->start();
+
+    return true;
+}
+
+auto Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget::engineStatistics() ->
+        Nedrysoft::RouteAnalyser::IPingEngineStatistics * {
+
+    return qobject_cast<Nedrysoft::RouteAnalyser::IPingEngineStatistics *>(m_engine.data());
+}
+
+auto Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget::updateStatistics() -> void {
+    auto engineStatistics = this->engineStatistics();
+
+    if (!engineStatistics) {
+        m_updateTimer->stop();
+
+        return;
+    }
+
+    auto statistics = engineStatistics->statistics();
+
+    m_sentLabel->setText(QString::number(statistics.sent));
+    m_repliesLabel->setText(QString::number(statistics.replies));
+    m_timeoutsLabel->setText(QString::number(statistics.timeouts));
+    m_lateLabel->setText(QString::number(statistics.late));
+    m_duplicatesLabel->setText(QString::number(statistics.duplicates));
+    m_inFlightLabel->setText(QString::number(statistics.inFlight));
+
+    m_transmitLagLabel->setText(tr("%1 ms / %2 ms")
+        .arg(statistics.averageTransmitLag / NanosecondsInMillisecond, 0, 'f', 2)
+        .arg(statistics.maximumTransmitLag / NanosecondsInMillisecond, 0, 'f', 2));
+
+    for (auto bucket = 0; bucket < LatencyBucketCount; bucket++) {
+        m_latencyLabels[bucket]->setText(QString::number(statistics.latencyHistogram[bucket]));
+    }
+}
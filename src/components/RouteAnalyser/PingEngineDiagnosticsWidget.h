@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINEDIAGNOSTICSWIDGET_H
+#define PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINEDIAGNOSTICSWIDGET_H
+
+#include "IPingEngineStatistics.h"
+
+#include <QPointer>
+#include <QWidget>
+#include <array>
+
+class QLabel;
+class QTimer;
+
+namespace Nedrysoft { namespace RouteAnalyser {
+    class IPingEngine;
+
+    /**
+     * @brief       The PingEngineDiagnosticsWidget shows the internal counters of a ping engine.
+     *
+     * @details     The statistics are polled from the engine once a second, engines that do not implement
+     *              Nedrysoft::RouteAnalyser::IPingEngineStatistics are not shown.
+     */
+    class PingEngineDiagnosticsWidget :
+            public QWidget {
+
+        private:
+            Q_OBJECT
+
+        public:
+            /**
+             * @brief       Constructs a new PingEngineDiagnosticsWidget.
+             *
+             * @param[in]   parent the owner widget.
+             */
+            explicit PingEngineDiagnosticsWidget(QWidget *parent=nullptr);
+
+            /**
+             * @brief       Destroys the PingEngineDiagnosticsWidget.
+             */
+            ~PingEngineDiagnosticsWidget();
+
+            /**
+             * @brief       Sets the engine whose statistics are shown.
+             *
+             * @param[in]   engine the engine; or nullptr to stop showing statistics.
+             *
+             * @returns     true if the engine provides statistics; otherwise false.
+             */
+            auto setEngine(Nedrysoft::RouteAnalyser::IPingEngine *engine) -> bool;
+
+        private:
+            /**
+             * @brief       Reads the statistics from the engine and updates the labels.
+             */
+            auto updateStatistics() -> void;
+
+            /**
+             * @brief       Returns the statistics interface of the engine.
+             *
+             * @returns     the interface; otherwise nullptr if there is no engine or it does not provide statistics.
+             */
+            auto engineStatistics() -> Nedrysoft::RouteAnalyser::IPingEngineStatistics *;
+
+        private:
+            //! @cond
+
+            QPointer<QObject> m_engine;
+
+            QTimer *m_updateTimer;
+
+            QLabel *m_sentLabel;
+            QLabel *m_repliesLabel;
+            QLabel *m_timeoutsLabel;
+            QLabel *m_lateLabel;
+            QLabel *m_duplicatesLabel;
+            QLabel *m_inFlightLabel;
+            QLabel *m_transmitLagLabel;
+
+            std::array<QLabel *, LatencyBucketCount> m_latencyLabels;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINEDIAGNOSTICSWIDGET_H
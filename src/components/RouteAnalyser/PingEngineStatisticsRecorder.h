@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINESTATISTICSRECORDER_H
+#define PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINESTATISTICSRECORDER_H
+
+#include "IPingEngineStatistics.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Nedrysoft { namespace RouteAnalyser {
+    /**
+     * @brief       The PingEngineStatisticsRecorder class holds the counters that back IPingEngineStatistics.
+     *
+     * @details     Every counter is a relaxed atomic, so recording an event costs a single uncontended increment
+     *              and the engine threads never wait for a reader.  Engines own a recorder and return its snapshot
+     *              from IPingEngineStatistics::statistics.
+     */
+    class PingEngineStatisticsRecorder {
+        public:
+            /**
+             * @brief       Constructs a new PingEngineStatisticsRecorder with every counter at zero.
+             */
+            PingEngineStatisticsRecorder() :
+                    m_inFlight(0) {
+
+                reset();
+            }
+
+            /**
+             * @brief       Records that a probe has been sent.
+             */
+            auto recordSent() -> void {
+                m_sent.fetch_add(1, std::memory_order_relaxed);
+                m_inFlight.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records that a probe has been answered.
+             *
+             * @param[in]   roundTripTime the round trip time in seconds.
+             */
+            auto recordReply(double roundTripTime) -> void {
+                auto milliseconds = roundTripTime * 1000.0;
+                auto bucket = 0;
+
+                while ((bucket < LatencyBucketCount - 1) && (milliseconds >= LatencyBucketLimits[bucket])) {
+                    bucket++;
+                }
+
+                m_replies.fetch_add(1, std::memory_order_relaxed);
+                m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+                m_latencyHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records that a probe was not answered within the timeout.
+             */
+            auto recordTimeout() -> void {
+                m_timeouts.fetch_add(1, std::memory_order_relaxed);
+                m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records that probes were abandoned without a result, for example when the engine stopped.
+             *
+             * @param[in]   count the number of probes.
+             */
+            auto recordCancelled(int count) -> void {
+                m_inFlight.fetch_sub(count, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records a reply that arrived after its probe had timed out.
+             */
+            auto recordLate() -> void {
+                m_late.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records a reply for a probe that had already been answered.
+             */
+            auto recordDuplicate() -> void {
+                m_duplicates.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief       Records how far behind its schedule a probe was sent.
+             *
+             * @param[in]   lag the lag in nanoseconds.
+             */
+            auto recordTransmitLag(int64_t lag) -> void {
+                lag = std::max<int64_t>(lag, 0);
+
+                m_transmitLagTotal.fetch_add(lag, std::memory_order_relaxed);
+                m_transmitLagCount.fetch_add(1, std::memory_order_relaxed);
+
+                auto maximumLag = m_maximumTransmitLag.load(std::memory_order_relaxed);
+
+                while ((lag > maximumLag) &&
+                       (!m_maximumTransmitLag.compare_exchange_weak(maximumLag, lag, std::memory_order_relaxed))) {
+                }
+            }
+
+            /**
+             * @brief       Returns a snapshot of the counters.
+             *
+             * @returns     the statistics.
+             */
+            auto statistics() const -> Nedrysoft::RouteAnalyser::PingEngineStatistics {
+                Nedrysoft::RouteAnalyser::PingEngineStatistics statistics = {};
+
+                statistics.sent = m_sent.load(std::memory_order_relaxed);
+                statistics.replies = m_replies.load(std::memory_order_relaxed);
+                statistics.timeouts = m_timeouts.load(std::memory_order_relaxed);
+                statistics.late = m_late.load(std::memory_order_relaxed);
+                statistics.duplicates = m_duplicates.load(std::memory_order_relaxed);
+                statistics.inFlight = std::max<int64_t>(m_inFlight.load(std::memory_order_relaxed), 0);
+                statistics.maximumTransmitLag = m_maximumTransmitLag.load(std::memory_order_relaxed);
+
+                auto lagCount = m_transmitLagCount.load(std::memory_order_relaxed);
+
+                if (lagCount) {
+                    statistics.averageTransmitLag =
+                            m_transmitLagTotal.load(std::memory_order_relaxed) / static_cast<int64_t>(lagCount);
+                }
+
+                for (auto bucket = 0; bucket < LatencyBucketCount; bucket++) {
+                    statistics.latencyHistogram[bucket] = m_latencyHistogram[bucket].load(std::memory_order_relaxed);
+                }
+
+                return statistics;
+            }
+
+            /**
+             * @brief       Resets every counter except the number of probes in flight.
+             */
+            auto reset() -> void {
+                m_sent.store(0, std::memory_order_relaxed);
+                m_replies.store(0, std::memory_order_relaxed);
+                m_timeouts.store(0, std::memory_order_relaxed);
+                m_late.store(0, std::memory_order_relaxed);
+                m_duplicates.store(0, std::memory_order_relaxed);
+                m_transmitLagTotal.store(0, std::memory_order_relaxed);
+                m_transmitLagCount.store(0, std::memory_order_relaxed);
+                m_maximumTransmitLag.store(0, std::memory_order_relaxed);
+
+                for (auto &bucket : m_latencyHistogram) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            //! @cond
+
+            std::atomic<uint64_t> m_sent;
+            std::atomic<uint64_t> m_replies;
+            std::atomic<uint64_t> m_timeouts;
+            std::atomic<uint64_t> m_late;
+            std::atomic<uint64_t> m_duplicates;
+            std::atomic<int64_t> m_inFlight;
+            std::atomic<int64_t> m_transmitLagTotal;
+            std::atomic<uint64_t> m_transmitLagCount;
+            std::atomic<int64_t> m_maximumTransmitLag;
+            std::array<std::atomic<uint64_t>, LatencyBucketCount> m_latencyHistogram;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEANALYSER_PINGENGINESTATISTICSRECORDER_H
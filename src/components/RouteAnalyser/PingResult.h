@@ -30,6 +30,7 @@
 #include <QElapsedTimer>
 #include <QHostAddress>
 #include <QObject>
+#include <QVector>
 #include <cmath>
 #include <cstdint>
 
@@ -155,6 +156,8 @@ namespace Nedrysoft { namespace RouteAnalyser {
 
             //! @endcond
     };
+
+    typedef QVector<Nedrysoft::RouteAnalyser::PingResult> PingResultList;
 }}
 
 #endif // PINGNOO_COMPONENTS_CORE_PINGRESULT_H
@@ -26,6 +26,7 @@
 #include "RouteAnalyserComponent.h"
 
 #include "ColourDialog.h"
+#include "HostNameResolver.h"
 #include "IRouteEngine.h"
 #include "LatencyRibbonGroup.h"
 #include "LatencySettings.h"
@@ -91,6 +92,7 @@ RouteAnalyserComponent::~RouteAnalyserComponent() {
 
 auto RouteAnalyserComponent::initialiseEvent() -> void {
     qRegisterMetaType<Nedrysoft::RouteAnalyser::PingResult>("Nedrysoft::RouteAnalyser::PingResult");
+    qRegisterMetaType<Nedrysoft::RouteAnalyser::PingResultList>("Nedrysoft::RouteAnalyser::PingResultList");
     qRegisterMetaType<Nedrysoft::RouteAnalyser::RouteList>("Nedrysoft::RouteAnalyser::RouteList");
     qRegisterMetaType<Nedrysoft::RouteAnalyser::IPingEngineFactory *>("Nedrysoft::RouteAnalyser::IPingEngineFactory *");
 }
@@ -139,6 +141,8 @@ auto RouteAnalyserComponent::finaliseEvent() -> void {
     }
 
     delete Nedrysoft::RouteAnalyser::TargetManager::getInstance();
+
+    delete Nedrysoft::RouteAnalyser::HostNameResolver::getInstance();
 }
 
 auto RouteAnalyserComponent::initialisationFinishedEvent() -> void {
@@ -26,6 +26,7 @@
 #include "BarChart.h"
 #include "CPAxisTickerMS.h"
 #include "GraphLatencyLayer.h"
+#include "HostNameResolver.h"
 #include "IPingEngine.h"
 #include "IPingEngineFactory.h"
 #include "IPingTarget.h"
@@ -33,6 +34,7 @@
 #include "IPlotFactory.h"
 #include "IRouteEngineFactory.h"
 #include "LatencySettings.h"
+#include "PingEngineDiagnosticsWidget.h"
 #include "PlotScrollArea.h"
 #include "RouteAnalyser.h"
 #include "RouteDiscoveryWidget.h"
@@ -47,7 +49,6 @@
 #include "IHostMaskerManager"
 #include <QDateTime>
 #include <QHostAddress>
-#include <QHostInfo>
 #include <QTimer>
 #include <cassert>
 #include <spdlog/spdlog.h>
@@ -59,6 +60,7 @@ constexpr auto DefaultGraphHeight = 300;
 constexpr auto TableRowHeight = 20;
 constexpr auto NoReplyColour = qRgb(255,0,0);
 constexpr auto PlotMargins = QMargins(80, 20, 40, 40);
+constexpr auto DefaultRouteRefreshInterval = 60000;
 
 QMap< Nedrysoft::RouteAnalyser::PingData::Fields, QPair<QString, QString> > &Nedrysoft::RouteAnalyser::RouteAnalyserWidget::headerMap() {
     static QMap<Nedrysoft::RouteAnalyser::PingData::Fields, QPair<QString, QString> > map = QMap<Nedrysoft::RouteAnalyser::PingData::Fields, QPair<QString, QString> >
@@ -122,6 +124,15 @@ Nedrysoft::RouteAnalyser::RouteAnalyserWidget::RouteAnalyserWidget(
             &RouteAnalyserWidget::onRouteResult
         );
 
+        connect(
+            routeEngine,
+            &Nedrysoft::RouteAnalyser::IRouteEngine::routeChanged,
+            this,
+            &RouteAnalyserWidget::onRouteChanged
+        );
+
+        routeEngine->setRefreshInterval(DefaultRouteRefreshInterval);
+
         m_routeDiscoveryWidget->setTarget(targetHost);
 
         routeEngine->findRoute(pingEngineFactory, targetHost, ipVersion);
@@ -142,6 +153,8 @@ Nedrysoft::RouteAnalyser::RouteAnalyserWidget::RouteAnalyserWidget(
 
     m_scrollArea = new PlotScrollArea();
 
+    m_diagnosticsWidget = new Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget();
+
     m_splitter = new QSplitter(Qt::Vertical);
 
     m_scrollArea->setWidgetResizable(true);
@@ -206,10 +219,14 @@ Nedrysoft::RouteAnalyser::RouteAnalyserWidget::RouteAnalyserWidget(
 
     m_splitter->addWidget(m_tableView);
     m_splitter->addWidget(m_scrollArea);
+    m_splitter->addWidget(m_diagnosticsWidget);
     m_splitter->addWidget(m_routeDiscoveryWidget);
 
+    m_splitter->setCollapsible(m_splitter->indexOf(m_diagnosticsWidget), true);
+
     m_routeDiscoveryWidget->setVisible(true);
     m_scrollArea->setVisible(false);
+    m_diagnosticsWidget->setVisible(false);
 
     m_splitter->setStretchFactor(1, 2);
 
@@ -250,18 +267,52 @@ Nedrysoft::RouteAnalyser::RouteAnalyserWidget::~RouteAnalyserWidget() {
 }
 
 auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onPingResult(Nedrysoft::RouteAnalyser::PingResult result) -> void {
+    if (processPingResult(result)) {
+        updateResults();
+    }
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onPingResults(
+        Nedrysoft::RouteAnalyser::PingResultList results) -> void {
+
+    auto resultsChanged = false;
+
+    // the ranges, dataset and table are refreshed once for the whole batch rather than once per result.
+
+    for (auto result : results) {
+        if (processPingResult(result)) {
+            resultsChanged = true;
+        }
+    }
+
+    if (resultsChanged) {
+        updateResults();
+    }
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::updateResults() -> void {
+    updateRanges();
+
+    Q_EMIT datasetChanged(m_startPoint, m_endPoint);
+
+    m_tableView->viewport()->update();
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::processPingResult(
+        Nedrysoft::RouteAnalyser::PingResult result) -> bool {
+
     auto pingData = static_cast<PingData *>(result.target()->userData());
 
     static QMap<Nedrysoft::RouteAnalyser::PingData::Fields, PingData *> m_maximumMap;
 
     if (!pingData) {
-        return;
+        return false;
     }
 
     auto customPlot = pingData->customPlot();
 
     if (!customPlot) {
-        return;
+        return false;
     }
 
     switch (result.code()) {
@@ -284,10 +335,6 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onPingResult(Nedrysoft::Rout
                 m_endPoint = requestTime;
             }
 
-            updateRanges();
-
-            Q_EMIT datasetChanged(m_startPoint, m_endPoint);
-
             pingData->updateItem(result);
 
             switch(m_graphScaleMode) {
@@ -342,9 +389,7 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onPingResult(Nedrysoft::Rout
                 }
             }
 
-            m_tableView->viewport()->update();
-
-            break;
+            return true;
         }
 
         case Nedrysoft::RouteAnalyser::PingResult::ResultCode::NoReply: {
@@ -359,6 +404,8 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onPingResult(Nedrysoft::Rout
             break;
         }
     }
+
+    return false;
 }
 
 auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onRouteResult(
@@ -371,15 +418,8 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onRouteResult(
     Nedrysoft::RouteAnalyser::IRouteEngine *routeEngine =
         qobject_cast<Nedrysoft::RouteAnalyser::IRouteEngine *>(this->sender());
 
-    auto hop = 1;
-    auto geoIP = Nedrysoft::ComponentSystem::getObject<Nedrysoft::Core::IGeoIPProvider>();
-
     SPDLOG_TRACE("Got route result");
 
-    auto latencySettings = Nedrysoft::RouteAnalyser::LatencySettings::getInstance();
-
-    assert(latencySettings!=nullptr);
-
     if ((completed) && (routeEngine)) {
         disconnect(
             routeEngine,
@@ -394,52 +434,8 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onRouteResult(
     }
 
     if (!completed) {
-        for (int hop=m_tableModel->rowCount();hop<route.count();hop++) {
-            auto host = route.at(hop);
-
-            auto hostAddress = host.toString();
-            auto hostName = QHostInfo::fromName(host.toString()).hostName();
-
-            auto maskedHostName = hostName;
-            auto maskedHostAddress = hostAddress;
-
-            auto pingData = new Nedrysoft::RouteAnalyser::PingData(m_tableModel, hop+1, !host.isNull());
-
-            m_pingData.append(pingData);
-
-            for (auto masker : Nedrysoft::ComponentSystem::getObjects<Nedrysoft::Core::IHostMasker>()) {
-                masker->mask(hop, hostName, hostAddress, maskedHostName, maskedHostAddress);
-            }
-
-            auto tableItem = new QStandardItem(1, headerMap().count());
-
-            tableItem->setData(QVariant::fromValue<Nedrysoft::RouteAnalyser::PingData *>(pingData));
-
-            if (host.isNull()) {
-                pingData->setHostAddress("*");
-                pingData->setHostName("*");
-                pingData->setMaskedHostAddress("*");
-                pingData->setMaskedHostName("*");
-            } else {
-                pingData->setHostName(hostName);
-                pingData->setHostAddress(hostAddress);
-                pingData->setMaskedHostName(maskedHostName);
-                pingData->setMaskedHostAddress(maskedHostAddress);
-            }
-
-            if (geoIP) {
-                geoIP->lookup(hostAddress, [pingData](const QString &, const QVariantMap &result) mutable {
-                    pingData->setLocation(result["country"].toString());
-                });
-            }
-
-            m_tableModel->appendRow(tableItem);
-
-            m_tableView->setRowHeight(tableItem->index().row(), TableRowHeight);
-
-            connect(m_tableView, &QObject::destroyed, [pingData](QObject *) {
-                delete pingData;
-            });
+        for (auto hop=m_tableModel->rowCount()+1;hop<=route.count();hop++) {
+            createHopData(hop, route.at(hop-1));
         }
 
         m_routeDiscoveryWidget->setProgress(m_tableModel->rowCount(), totalHops, maximumHops);
@@ -465,343 +461,577 @@ auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onRouteResult(
         &RouteAnalyserWidget::onPingResult
     );
 
-    auto verticalLayout = new QVBoxLayout();
+    connect(
+        m_pingEngine,
+        &Nedrysoft::RouteAnalyser::IPingEngine::results,
+        this,
+        &RouteAnalyserWidget::onPingResults
+    );
 
-    //for (const QHostAddress &host : route) {
-    for (auto hop=1;hop<=route.count();hop++) {
-        auto host = route.at(hop-1);
+    m_routeHostAddress = routeHostAddress;
+    m_route = route;
 
-        if (host.isNull()) {
+    m_plotLayout = new QVBoxLayout();
+
+    for (auto hop=1;hop<=route.count();hop++) {
+        if (route.at(hop-1).isNull()) {
             continue;
         }
 
-        auto hostAddress = host.toString();
-        auto hostName = QHostInfo::fromName(host.toString()).hostName();
+        createHopPlot(hop);
+    }
 
-        auto maskedHostName = hostName;
-        auto maskedHostAddress = hostAddress;
+    connect(
+        this,
+        &Nedrysoft::RouteAnalyser::RouteAnalyserWidget::filteredEvent,
+        [=](QObject *watched, QEvent *event) {
+
+            auto customPlot = qobject_cast<QCustomPlot *>(watched);
+
+            auto line = m_graphLines[customPlot];
 
-        for (auto masker : Nedrysoft::ComponentSystem::getObjects<Nedrysoft::Core::IHostMasker>()) {
-            masker->mask(hop, hostName, hostAddress, maskedHostName, maskedHostAddress);
+            if (event->type() == QEvent::PaletteChange) {
+                customPlot->setBackground(this->palette().brush(QPalette::Base));
+
+                customPlot->xAxis->setLabelColor(this->palette().color(QPalette::Text));
+                customPlot->yAxis->setLabelColor(this->palette().color(QPalette::Text));
+                customPlot->xAxis->setTickLabelColor(this->palette().color(QPalette::Text));
+                customPlot->yAxis->setTickLabelColor(this->palette().color(QPalette::Text));
+
+                QCPTextElement *textElement = qobject_cast<QCPTextElement *>(
+                        customPlot->plotLayout()->element(0, 0));
+
+                if (textElement) {
+                    textElement->setTextColor(this->palette().color(QPalette::Text));
+                }
+            }
+
+            if ((event->type() == QEvent::Enter) ||
+                (event->type() == QEvent::Leave)) {
+
+                /*m_pointInfoLabel->setText("");
+                m_hopInfoLabel->setText("");
+                m_hostInfoLabel->setText("");
+                m_timeInfoLabel->setText("");*/
+
+                line->setVisible(event->type() == QEvent::Enter);
+
+                customPlot->replot();
+
+                this->m_tableModel->setProperty("showHistorical", false);
+
+                auto topLeft = m_tableModel->index(0, 0);
+                auto bottomRight = topLeft.sibling(m_tableModel->rowCount() - 1,
+                                                   m_tableModel->columnCount() - 1);
+
+                m_tableModel->dataChanged(topLeft, bottomRight);
+            }
         }
+    );
 
-        auto customPlot = new QCustomPlot();
+    m_scrollArea->widget()->setLayout(m_plotLayout);
 
-        customPlot->addLayer("newBackground", customPlot->layer("grid"), QCustomPlot::limBelow);
+    m_routeDiscoveryWidget->setVisible(false);
+    m_scrollArea->setVisible(true);
 
-        auto latencyLayer = new GraphLatencyLayer(customPlot);
+    // the diagnostics panel is only shown for engines that report their internal statistics.
 
-        m_backgroundLayers.append(latencyLayer);
+    m_diagnosticsWidget->setVisible(m_diagnosticsWidget->setEngine(m_pingEngine));
 
-        connect(
-            latencySettings,
-            &Nedrysoft::RouteAnalyser::LatencySettings::gradientChanged,
-            [=](bool /*useGradient*/) {
-                latencyLayer->invalidate();
+    update();
+
+    m_pingEngine->start();
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::createHopData(
+        int hop,
+        const QHostAddress &host ) -> Nedrysoft::RouteAnalyser::PingData * {
+
+    auto pingData = new Nedrysoft::RouteAnalyser::PingData(m_tableModel, hop, !host.isNull());
+
+    m_pingData.append(pingData);
+
+    auto tableItem = new QStandardItem(1, headerMap().count());
+
+    tableItem->setData(QVariant::fromValue<Nedrysoft::RouteAnalyser::PingData *>(pingData));
+
+    setHopHost(pingData, hop, host);
+
+    m_tableModel->appendRow(tableItem);
+
+    m_tableView->setRowHeight(tableItem->index().row(), TableRowHeight);
+
+    connect(m_tableView, &QObject::destroyed, [pingData](QObject *) {
+        delete pingData;
+    });
+
+    return pingData;
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::setHopHost(
+        Nedrysoft::RouteAnalyser::PingData *pingData,
+        int hop,
+        const QHostAddress &host ) -> void {
+
+    if (host.isNull()) {
+        pingData->setHostAddress("*");
+        pingData->setHostName("*");
+        pingData->setMaskedHostAddress("*");
+        pingData->setMaskedHostName("*");
+        pingData->setLocation(QString());
+
+        return;
+    }
+
+    // the address is shown until the host name has been looked up.
+
+    auto hostAddress = host.toString();
+    auto hostName = hostAddress;
+
+    auto maskedHostName = hostName;
+    auto maskedHostAddress = hostAddress;
+
+    for (auto masker : Nedrysoft::ComponentSystem::getObjects<Nedrysoft::Core::IHostMasker>()) {
+        masker->mask(hop, hostName, hostAddress, maskedHostName, maskedHostAddress);
+    }
+
+    pingData->setHostName(hostName);
+    pingData->setHostAddress(hostAddress);
+    pingData->setMaskedHostName(maskedHostName);
+    pingData->setMaskedHostAddress(maskedHostAddress);
+
+    auto geoIP = Nedrysoft::ComponentSystem::getObject<Nedrysoft::Core::IGeoIPProvider>();
+
+    if (geoIP) {
+        geoIP->lookup(hostAddress, [pingData](const QString &, const QVariantMap &result) mutable {
+            pingData->setLocation(result["country"].toString());
+        });
+    }
+
+    Nedrysoft::RouteAnalyser::HostNameResolver::getInstance()->lookup(
+        host,
+        this,
+        [this, pingData](const QHostAddress &hostAddress, const QString &hostName) {
+            // the hop may have changed to another router while the lookup was in progress.
+
+            if (pingData->hostAddress() != hostAddress.toString()) {
+                return;
             }
-        );
 
-        customPlot->setCurrentLayer("main");
+            pingData->setHostName(hostName);
 
-        customPlot->setMinimumHeight(DefaultGraphHeight);
+            auto plotTitleLabel = m_plotTitleLabels.value(pingData);
 
-        customPlot->addGraph();
+            if (plotTitleLabel) {
+                plotTitleLabel->setText(pingData->plotTitle());
+            }
+        }
+    );
+}
 
-        // the timeout bar chart uses axis 2 which is a unit axis.  This means it will always draw to the top
-        // of the axis independently of the main axis which may scale up/down depending on latency.
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::createHopPlot(int hop) -> void {
+    auto latencySettings = Nedrysoft::RouteAnalyser::LatencySettings::getInstance();
 
-        customPlot->yAxis2->setRange(0,1);
-        customPlot->yAxis2->setVisible(true);
+    assert(latencySettings!=nullptr);
 
-        auto barChart = new BarChart(customPlot->xAxis, customPlot->yAxis2);
+    auto pingData = m_pingData.at(hop-1);
+    auto maskedHostName = pingData->maskedHostName();
 
-        barChart->setWidthType(QCPBars::wtPlotCoords);
-        barChart->setBrush(QColor(NoReplyColour));
-        barChart->setPen(QPen(QColor(NoReplyColour)));
+    // the widgets of a hop are inserted ahead of those of the next hop that has a plot, so that the plots stay in
+    // hop order when a hop is added after monitoring has started.
 
-        m_barCharts[customPlot] = barChart;
+    auto insertIndex = -1;
 
-        customPlot->yAxis->ticker()->setTickCount(1);
+    for (auto nextHop = hop+1; nextHop <= m_pingData.count(); nextHop++) {
+        auto nextTitleLabel = m_plotTitleLabels.value(m_pingData.at(nextHop-1));
 
-        QSharedPointer<CPAxisTickerMS> msTicker(new CPAxisTickerMS);
+        if (nextTitleLabel) {
+            insertIndex = m_plotLayout->indexOf(nextTitleLabel);
 
-        customPlot->yAxis->setTicker(msTicker);
-        customPlot->yAxis->setLabel(tr("Latency (ms)"));
-        customPlot->yAxis->setRange(0, DefaultMaxLatency);
+            break;
+        }
+    }
 
-        QSharedPointer<QCPAxisTickerDateTime> dateTicker(new QCPAxisTickerDateTime);
+    QList<QWidget *> hopWidgets;
 
-        auto locale = QLocale::system();
+    auto addPlotWidget = [this, &insertIndex, &hopWidgets](QWidget *widget) {
+        hopWidgets.append(widget);
 
-        dateTicker->setDateTimeFormat(
-            locale.timeFormat(QLocale::LongFormat).remove("t").trimmed() +
-            "\n" +
-            locale.dateFormat(QLocale::ShortFormat)
-        );
+        if (insertIndex == -1) {
+            m_plotLayout->addWidget(widget);
+        } else {
+            m_plotLayout->insertWidget(insertIndex++, widget);
+        }
+    };
+
+    auto customPlot = new QCustomPlot();
+
+    customPlot->addLayer("newBackground", customPlot->layer("grid"), QCustomPlot::limBelow);
+
+    auto latencyLayer = new GraphLatencyLayer(customPlot);
+
+    m_backgroundLayers.append(latencyLayer);
+
+    connect(
+        latencySettings,
+        &Nedrysoft::RouteAnalyser::LatencySettings::gradientChanged,
+        latencyLayer,
+        [=](bool /*useGradient*/) {
+            latencyLayer->invalidate();
+        }
+    );
+
+    customPlot->setCurrentLayer("main");
+
+    customPlot->setMinimumHeight(DefaultGraphHeight);
+
+    customPlot->addGraph();
+
+    // the timeout bar chart uses axis 2 which is a unit axis.  This means it will always draw to the top
+    // of the axis independently of the main axis which may scale up/down depending on latency.
+
+    customPlot->yAxis2->setRange(0,1);
+    customPlot->yAxis2->setVisible(true);
+
+    auto barChart = new BarChart(customPlot->xAxis, customPlot->yAxis2);
+
+    barChart->setWidthType(QCPBars::wtPlotCoords);
+    barChart->setBrush(QColor(NoReplyColour));
+    barChart->setPen(QPen(QColor(NoReplyColour)));
+
+    m_barCharts[customPlot] = barChart;
+
+    customPlot->yAxis->ticker()->setTickCount(1);
+
+    QSharedPointer<CPAxisTickerMS> msTicker(new CPAxisTickerMS);
+
+    customPlot->yAxis->setTicker(msTicker);
+    customPlot->yAxis->setLabel(tr("Latency (ms)"));
+    customPlot->yAxis->setRange(0, DefaultMaxLatency);
+
+    QSharedPointer<QCPAxisTickerDateTime> dateTicker(new QCPAxisTickerDateTime);
+
+    auto locale = QLocale::system();
+
+    dateTicker->setDateTimeFormat(
+        locale.timeFormat(QLocale::LongFormat).remove("t").trimmed() +
+        "\n" +
+        locale.dateFormat(QLocale::ShortFormat)
+    );
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
-        auto secondsSinceEpoch = QDateTime::currentSecsSinceEpoch();
+    auto secondsSinceEpoch = QDateTime::currentSecsSinceEpoch();
 #else
-        auto secondsSinceEpoch = abs(QDateTime::currentDateTime().secsTo(QDateTime(QDate(1970,1,1), QTime(0, 0))));
+    auto secondsSinceEpoch = abs(QDateTime::currentDateTime().secsTo(QDateTime(QDate(1970,1,1), QTime(0, 0))));
 #endif
 
-        customPlot->xAxis->setTicker(dateTicker);
-        customPlot->xAxis->setRange(
-            static_cast<double>(secondsSinceEpoch),
-            static_cast<double>(secondsSinceEpoch + m_viewportSize)
-        );
+    customPlot->xAxis->setTicker(dateTicker);
+    customPlot->xAxis->setRange(
+        static_cast<double>(secondsSinceEpoch),
+        static_cast<double>(secondsSinceEpoch + m_viewportSize)
+    );
 
-        customPlot->graph(RoundTripGraph)->setLineStyle(QCPGraph::lsStepCenter);
+    customPlot->graph(RoundTripGraph)->setLineStyle(QCPGraph::lsStepCenter);
 
-        customPlot->setBackground(this->palette().brush(QPalette::Base));
-        customPlot->xAxis->setLabelColor(this->palette().color(QPalette::Text));
-        customPlot->yAxis->setLabelColor(this->palette().color(QPalette::Text));
-        customPlot->xAxis->setTickLabelColor(this->palette().color(QPalette::Text));
-        customPlot->yAxis->setTickLabelColor(this->palette().color(QPalette::Text));
+    customPlot->setBackground(this->palette().brush(QPalette::Base));
+    customPlot->xAxis->setLabelColor(this->palette().color(QPalette::Text));
+    customPlot->yAxis->setLabelColor(this->palette().color(QPalette::Text));
+    customPlot->xAxis->setTickLabelColor(this->palette().color(QPalette::Text));
+    customPlot->yAxis->setTickLabelColor(this->palette().color(QPalette::Text));
 
-        customPlot->replot();
+    customPlot->replot();
 
-        /**
-         * scroll wheel events, by default QCustomPlot does not propagate these so this code ensures that they cause
-         * the scroll area to scroll.
-         */
+    /**
+     * scroll wheel events, by default QCustomPlot does not propagate these so this code ensures that they cause
+     * the scroll area to scroll.
+     */
 
-        connect(customPlot, &QCustomPlot::mouseWheel, [this](QWheelEvent *event) {
-            m_scrollArea->verticalScrollBar()->setValue(
-                m_scrollArea->verticalScrollBar()->value() - event->angleDelta().y()
-            );
-        });
+    connect(customPlot, &QCustomPlot::mouseWheel, [this](QWheelEvent *event) {
+        m_scrollArea->verticalScrollBar()->setValue(
+            m_scrollArea->verticalScrollBar()->value() - event->angleDelta().y()
+        );
+    });
 
-        /**
-         *  mouse over event
-         */
+    /**
+     *  mouse over event
+     */
 
-        auto graphLine = new QCPItemStraightLine(customPlot);
+    auto graphLine = new QCPItemStraightLine(customPlot);
 
-        graphLine->setPen(QPen(Qt::darkGray, 2, Qt::DotLine));
+    graphLine->setPen(QPen(Qt::darkGray, 2, Qt::DotLine));
 
-        m_graphLines[customPlot] = graphLine;
+    m_graphLines[customPlot] = graphLine;
 
-        connect(
-            customPlot,
-            &QCustomPlot::mouseMove,
-            [this, customPlot, graphLine, maskedHostName](QMouseEvent *event) {
-                auto x = customPlot->xAxis->pixelToCoord(event->pos().x());
-                auto foundRange = false;
+    connect(
+        customPlot,
+        &QCustomPlot::mouseMove,
+        [this, customPlot, graphLine, maskedHostName](QMouseEvent *event) {
+            auto x = customPlot->xAxis->pixelToCoord(event->pos().x());
+            auto foundRange = false;
 
-                auto data = customPlot->graph(RoundTripGraph)->data();
+            auto data = customPlot->graph(RoundTripGraph)->data();
 
-                if (!data) {
-                    return;
-                }
+            if (!data) {
+                return;
+            }
 
-                auto dataRange = data->keyRange(foundRange);
+            auto dataRange = data->keyRange(foundRange);
 
-                graphLine->point1->setCoords(x, 0);
-                graphLine->point2->setCoords(x, 1);
+            graphLine->point1->setCoords(x, 0);
+            graphLine->point2->setCoords(x, 1);
 
-                customPlot->replot();
+            customPlot->replot();
 
-                if (( foundRange ) &&
-                    ( x >= dataRange.lower ) &&
-                    ( x <= dataRange.upper )) {
-                    auto valueString = QString();
-                    /*auto valueResultRange = customPlot->graph(RoundTripGraph)->data()->valueRange(
-                            foundRange,
-                            QCP::sdBoth,
-                            QCPRange(x - 1, x +1) );*/
+            if (( foundRange ) &&
+                ( x >= dataRange.lower ) &&
+                ( x <= dataRange.upper )) {
+                auto valueString = QString();
+                /*auto valueResultRange = customPlot->graph(RoundTripGraph)->data()->valueRange(
+                        foundRange,
+                        QCP::sdBoth,
+                        QCPRange(x - 1, x +1) );*/
 
-                    for (auto currentItem = 0; currentItem < m_tableModel->rowCount(); currentItem++) {
-                        auto pingData = m_tableModel->item(
-                                currentItem,
-                                0
-                        )->data().value<Nedrysoft::RouteAnalyser::PingData *>();
+                for (auto currentItem = 0; currentItem < m_tableModel->rowCount(); currentItem++) {
+                    auto pingData = m_tableModel->item(
+                            currentItem,
+                            0
+                    )->data().value<Nedrysoft::RouteAnalyser::PingData *>();
 
-                        auto valueRange = QCPRange(x - 1, x + 1);
+                    auto valueRange = QCPRange(x - 1, x + 1);
 
-                        if (pingData->customPlot()) {
-                            auto tempResultRange = pingData->customPlot()->graph(
-                                    RoundTripGraph)->data()->valueRange(foundRange, QCP::sdBoth, valueRange);
+                    if (pingData->customPlot()) {
+                        auto tempResultRange = pingData->customPlot()->graph(
+                                RoundTripGraph)->data()->valueRange(foundRange, QCP::sdBoth, valueRange);
 
-                            pingData->setHistoricalLatency(tempResultRange.upper);
-                        } else {
-                            pingData->setHistoricalLatency(-1);
+                        pingData->setHistoricalLatency(tempResultRange.upper);
+                    } else {
+                        pingData->setHistoricalLatency(-1);
 
-                            auto topLeft = m_tableModel->index(0, 0);
-                            auto bottomRight = topLeft.sibling(m_tableModel->rowCount() - 1,
-                                                               m_tableModel->columnCount() - 1);
+                        auto topLeft = m_tableModel->index(0, 0);
+                        auto bottomRight = topLeft.sibling(m_tableModel->rowCount() - 1,
+                                                           m_tableModel->columnCount() - 1);
 
-                            m_tableModel->dataChanged(topLeft, bottomRight);
-                        }
+                        m_tableModel->dataChanged(topLeft, bottomRight);
                     }
+                }
 
-                    this->m_tableModel->setProperty("showHistorical", true);
+                this->m_tableModel->setProperty("showHistorical", true);
 
-                    /*
-                    auto seconds = std::chrono::duration<double>(valueResultRange.upper);
+                /*
+                auto seconds = std::chrono::duration<double>(valueResultRange.upper);
 
-                    if (seconds < std::chrono::seconds(1)) {
-                        auto milliseconds =
-                            std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(seconds);
+                if (seconds < std::chrono::seconds(1)) {
+                    auto milliseconds =
+                        std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(seconds);
 
-                        valueString = QString(tr("%1ms")).arg(milliseconds.count(), 0, 'f', 2);
-                    } else {
-                        valueString = QString(tr("%1s")).arg(seconds.count(), 0, 'f', 2);
-                    }
+                    valueString = QString(tr("%1ms")).arg(milliseconds.count(), 0, 'f', 2);
+                } else {
+                    valueString = QString(tr("%1s")).arg(seconds.count(), 0, 'f', 2);
+                }
 
-                    auto dateTime = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(x));
+                auto dateTime = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(x));
 
-                    m_pointInfoLabel->setText(FontAwesome::richText(QString("[fas fa-stopwatch] %1").arg(valueString)));
-                    m_hopInfoLabel->setText(FontAwesome::richText(QString("[fas fa-project-diagram] %1 %2").arg(tr("hop")).arg(hop)));
-                    m_hostInfoLabel->setText(FontAwesome::richText(QString("[fas fa-server] %1").arg(maskedHostName)));
-                    m_timeInfoLabel->setText(FontAwesome::richText(QString("[far fa-calendar-alt] %1").arg(dateTime.toString())));
-                    */
-                } else {
-                    /*
-                    m_pointInfoLabel->setText("");
-                    m_hopInfoLabel->setText("");
-                    m_hostInfoLabel->setText("");
-                    m_timeInfoLabel->setText("");
-                    */
+                m_pointInfoLabel->setText(FontAwesome::richText(QString("[fas fa-stopwatch] %1").arg(valueString)));
+                m_hopInfoLabel->setText(FontAwesome::richText(QString("[fas fa-project-diagram] %1 %2").arg(tr("hop")).arg(hop)));
+                m_hostInfoLabel->setText(FontAwesome::richText(QString("[fas fa-server] %1").arg(maskedHostName)));
+                m_timeInfoLabel->setText(FontAwesome::richText(QString("[far fa-calendar-alt] %1").arg(dateTime.toString())));
+                */
+            } else {
+                /*
+                m_pointInfoLabel->setText("");
+                m_hopInfoLabel->setText("");
+                m_hostInfoLabel->setText("");
+                m_timeInfoLabel->setText("");
+                */
 
-                    this->m_tableModel->setProperty("showHistorical", false);
+                this->m_tableModel->setProperty("showHistorical", false);
 
-                    auto topLeft = m_tableModel->index(0, 0);
-                    auto bottomRight = topLeft.sibling(
-                            m_tableModel->rowCount() - 1,
-                            m_tableModel->columnCount() - 1 );
+                auto topLeft = m_tableModel->index(0, 0);
+                auto bottomRight = topLeft.sibling(
+                        m_tableModel->rowCount() - 1,
+                        m_tableModel->columnCount() - 1 );
 
-                    m_tableModel->dataChanged(topLeft, bottomRight);
-                }
+                m_tableModel->dataChanged(topLeft, bottomRight);
             }
-        );
+        }
+    );
 
-        customPlot->installEventFilter(this);
+    customPlot->installEventFilter(this);
 
-        m_plotList.append(customPlot);
+    m_plotList.append(customPlot);
 
-        auto plotTitleLabel = new QLabel;
+    auto plotTitleLabel = new QLabel;
 
-        QFont labelFont = plotTitleLabel->font();
+    QFont labelFont = plotTitleLabel->font();
 
-        labelFont.setPointSize(16);
+    labelFont.setPointSize(16);
 
-        plotTitleLabel->setFont(labelFont);
+    plotTitleLabel->setFont(labelFont);
 
-        plotTitleLabel->setAlignment(Qt::AlignHCenter);
+    plotTitleLabel->setAlignment(Qt::AlignHCenter);
 
-        verticalLayout->addWidget(plotTitleLabel);
+    addPlotWidget(plotTitleLabel);
 
-        // add any pre-plots.
+    // add any pre-plots.
 
-        auto plotFactories = ComponentSystem::getObjects<Nedrysoft::RouteAnalyser::IPlotFactory>();
+    auto plotFactories = ComponentSystem::getObjects<Nedrysoft::RouteAnalyser::IPlotFactory>();
 
-        QList<Nedrysoft::RouteAnalyser::IPlot *> plots;
+    QList<Nedrysoft::RouteAnalyser::IPlot *> plots;
 
-        for (auto plotFactory : plotFactories) {
-            auto plot = plotFactory->createPlot(PlotMargins);
+    for (auto plotFactory : plotFactories) {
+        auto plot = plotFactory->createPlot(PlotMargins);
 
-            m_extraPlots.append(plot);
+        m_extraPlots.append(plot);
 
-            plots.append(plot);
+        plots.append(plot);
 
-            verticalLayout->addWidget(plot->widget());
-        }
+        addPlotWidget(plot->widget());
+    }
 
-        customPlot->axisRect()->setAutoMargins(QCP::msNone);
-        customPlot->axisRect()->setMargins(PlotMargins);
+    customPlot->axisRect()->setAutoMargins(QCP::msNone);
+    customPlot->axisRect()->setMargins(PlotMargins);
 
-        // add the main plot
+    // add the main plot
 
-        verticalLayout->addWidget(customPlot);
+    addPlotWidget(customPlot);
 
-        auto pingTarget = m_pingEngine->addTarget(routeHostAddress, hop);
+    auto pingTarget = m_pingEngine->addTarget(m_routeHostAddress, hop);
 
-        auto pingData = m_pingData.at(hop-1);
+    pingData->setHopValid(true);
+    pingData->setPlots(plots);
+    pingData->setCustomPlot(customPlot);
 
-        pingData->setHopValid(true);
-        pingData->setPlots(plots);
-        pingData->setCustomPlot(customPlot);
+    if (pingTarget) {
+        m_hopTargets[pingData] = pingTarget;
 
         pingTarget->setUserData(pingData);
+    }
 
-        if (geoIP) {
-            geoIP->lookup(hostAddress, [pingData](const QString &, const QVariantMap &result) mutable {
-                pingData->setLocation(result["country"].toString());
-            });
-        }
+    auto hostMaskerManager = Nedrysoft::Core::IHostMaskerManager::getInstance();
 
-        auto hostMaskerManager = Nedrysoft::Core::IHostMaskerManager::getInstance();
+    if (hostMaskerManager) {
+        connect(
+            hostMaskerManager,
+            &Nedrysoft::Core::IHostMaskerManager::maskStateChanged,
+            plotTitleLabel,
+            [pingData, plotTitleLabel](Nedrysoft::Core::HostMaskType type, bool state) {
+                pingData->updateModel();
+                plotTitleLabel->setText(pingData->plotTitle());
+        });
+    }
+
+    plotTitleLabel->setText(pingData->plotTitle());
+
+    m_plotTitleLabels[pingData] = plotTitleLabel;
+    m_hopWidgets[pingData] = hopWidgets;
+}
+
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::retireHop(Nedrysoft::RouteAnalyser::PingData *pingData) -> void {
+    auto pingTarget = m_hopTargets.take(pingData);
+
+    if ((pingTarget) && (m_pingEngine)) {
+        m_pingEngine->removeTarget(pingTarget);
+    }
+
+    // the plots of the hop are taken out of every list that is walked when the graphs are updated before they are
+    // deleted, results that are still in flight for the hop are ignored once it no longer has a plot.
+
+    auto customPlot = pingData->customPlot();
+
+    if (customPlot) {
+        m_plotList.removeAll(customPlot);
+        m_graphLines.remove(customPlot);
+        m_barCharts.remove(customPlot);
+
+        QMutableListIterator<Nedrysoft::RouteAnalyser::GraphLatencyLayer *> layerIterator(m_backgroundLayers);
 
-        if (hostMaskerManager) {
-            connect(
-                hostMaskerManager,
-                &Nedrysoft::Core::IHostMaskerManager::maskStateChanged,
-                [pingData, plotTitleLabel](Nedrysoft::Core::HostMaskType type, bool state) {
-                    pingData->updateModel();
-                    plotTitleLabel->setText(pingData->plotTitle());
-            });
+        while (layerIterator.hasNext()) {
+            if (layerIterator.next()->parentPlot() == customPlot) {
+                layerIterator.remove();
+            }
         }
+    }
 
-        plotTitleLabel->setText(pingData->plotTitle());
+    for (auto plot : pingData->plots()) {
+        m_extraPlots.removeAll(plot);
     }
 
-    connect(
-        this,
-        &Nedrysoft::RouteAnalyser::RouteAnalyserWidget::filteredEvent,
-        [=](QObject *watched, QEvent *event) {
+    pingData->setPlots(QList<Nedrysoft::RouteAnalyser::IPlot *>());
+    pingData->setCustomPlot(nullptr);
+    pingData->setHopValid(false);
 
-            auto customPlot = qobject_cast<QCustomPlot *>(watched);
+    m_plotTitleLabels.remove(pingData);
 
-            auto line = m_graphLines[customPlot];
+    for (auto widget : m_hopWidgets.take(pingData)) {
+        m_plotLayout->removeWidget(widget);
 
-            if (event->type() == QEvent::PaletteChange) {
-                customPlot->setBackground(this->palette().brush(QPalette::Base));
+        widget->disconnect();
+        widget->deleteLater();
+    }
+}
 
-                customPlot->xAxis->setLabelColor(this->palette().color(QPalette::Text));
-                customPlot->yAxis->setLabelColor(this->palette().color(QPalette::Text));
-                customPlot->xAxis->setTickLabelColor(this->palette().color(QPalette::Text));
-                customPlot->yAxis->setTickLabelColor(this->palette().color(QPalette::Text));
+auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::onRouteChanged(
+        const QHostAddress hostAddress,
+        const Nedrysoft::RouteAnalyser::RouteList route ) -> void {
 
-                QCPTextElement *textElement = qobject_cast<QCPTextElement *>(
-                        customPlot->plotLayout()->element(0, 0));
+    if ((!m_pingEngine) || (!m_plotLayout) || (hostAddress != m_routeHostAddress)) {
+        return;
+    }
 
-                if (textElement) {
-                    textElement->setTextColor(this->palette().color(QPalette::Text));
-                }
-            }
+    SPDLOG_INFO(QString("Route to %1 has changed, now %2 hops.")
+        .arg(hostAddress.toString())
+        .arg(route.count()).toStdString());
 
-            if ((event->type() == QEvent::Enter) ||
-                (event->type() == QEvent::Leave)) {
+    // hops beyond the end of the new route are removed from the table and are no longer monitored.
 
-                /*m_pointInfoLabel->setText("");
-                m_hopInfoLabel->setText("");
-                m_hostInfoLabel->setText("");
-                m_timeInfoLabel->setText("");*/
+    while (m_pingData.count() > route.count()) {
+        auto pingData = m_pingData.takeLast();
 
-                line->setVisible(event->type() == QEvent::Enter);
+        retireHop(pingData);
 
-                customPlot->replot();
+        m_tableModel->removeRow(m_pingData.count());
+    }
 
-                this->m_tableModel->setProperty("showHistorical", false);
+    for (auto hop=1;hop<=route.count();hop++) {
+        auto host = route.at(hop-1);
 
-                auto topLeft = m_tableModel->index(0, 0);
-                auto bottomRight = topLeft.sibling(m_tableModel->rowCount() - 1,
-                                                   m_tableModel->columnCount() - 1);
+        if (hop > m_pingData.count()) {
+            createHopData(hop, host);
 
-                m_tableModel->dataChanged(topLeft, bottomRight);
+            if (!host.isNull()) {
+                createHopPlot(hop);
             }
+
+            continue;
         }
-    );
 
-    m_scrollArea->widget()->setLayout(verticalLayout);
+        if ((hop <= m_route.count()) && (m_route.at(hop-1) == host)) {
+            continue;
+        }
 
-    m_routeDiscoveryWidget->setVisible(false);
-    m_scrollArea->setVisible(true);
+        auto pingData = m_pingData.at(hop-1);
 
-    update();
+        setHopHost(pingData, hop, host);
 
-    m_pingEngine->start();
+        // the monitoring target of a hop pings the destination with the ttl of the hop, so it remains valid when
+        // the router at that hop changes; only hops that previously did not reply need a new plot.
+
+        if (!host.isNull()) {
+            auto plotTitleLabel = m_plotTitleLabels.value(pingData);
+
+            if (!plotTitleLabel) {
+                createHopPlot(hop);
+            } else {
+                plotTitleLabel->setText(pingData->plotTitle());
+            }
+        }
+
+        pingData->updateModel();
+    }
+
+    m_route = route;
+
+    updateRanges();
 }
 
 auto Nedrysoft::RouteAnalyser::RouteAnalyserWidget::eventFilter(QObject *watched, QEvent *event) -> bool {
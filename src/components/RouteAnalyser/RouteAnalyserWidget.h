@@ -42,16 +42,19 @@ namespace Nedrysoft { namespace Core {
     class IHostMasker;
 }}
 
+class QLabel;
 class QTableView;
 class QStandardItemModel;
 class QSplitter;
 class QScrollArea;
 class Timer;
+class QVBoxLayout;
 
 namespace Nedrysoft { namespace RouteAnalyser {
     class GraphLatencyLayer;
     class IPingEngine;
     class IPingEngineFactory;
+    class PingEngineDiagnosticsWidget;
     class PlotScrollArea;
     class RouteTableItemDelegate;
     class RouteDiscoveryWidget;
@@ -106,6 +109,13 @@ namespace Nedrysoft { namespace RouteAnalyser {
              */
             Q_SLOT void onPingResult(Nedrysoft::RouteAnalyser::PingResult result);
 
+            /**
+             * @brief       Called when a batch of ping results is available.
+             *
+             * @param[in]   results the results, in the order that they completed.
+             */
+            Q_SLOT void onPingResults(Nedrysoft::RouteAnalyser::PingResultList results);
+
             /**
              * @brief       Called when a ping route is available.
              *
@@ -126,6 +136,20 @@ namespace Nedrysoft { namespace RouteAnalyser {
                 const int maximumHops
             );
 
+            /**
+             * @brief       Called when the route engine finds that the route to the target has changed.
+             *
+             * @details     Hops that have changed are updated in place so that the data that has been collected
+             *              for the route is kept, hops beyond the end of the new route stop being monitored.
+             *
+             * @param[in]   hostAddress the intended target of the route analysis.
+             * @param[in]   route the new route.
+             */
+            Q_SLOT void onRouteChanged(
+                const QHostAddress hostAddress,
+                const Nedrysoft::RouteAnalyser::RouteList route
+            );
+
             /**
              * @brief       This signal is emitted when a watched event on a child fires.
              *
@@ -212,6 +236,20 @@ namespace Nedrysoft { namespace RouteAnalyser {
              */
             auto updateRanges() -> void;
 
+            /**
+             * @brief       Adds a ping result to the graphs and table.
+             *
+             * @param[in]   result the result.
+             *
+             * @returns     true if the ranges, dataset and table need to be refreshed; otherwise false.
+             */
+            auto processPingResult(Nedrysoft::RouteAnalyser::PingResult result) -> bool;
+
+            /**
+             * @brief       Refreshes the ranges, dataset and table after results have been processed.
+             */
+            auto updateResults() -> void;
+
             /**
              * @brief       A map containing the fields that are displayed on the list.
              *
@@ -219,6 +257,48 @@ namespace Nedrysoft { namespace RouteAnalyser {
              */
             QMap<Nedrysoft::RouteAnalyser::PingData::Fields, QPair<QString, QString> > &headerMap();
 
+            /**
+             * @brief       Creates the data and table row for a hop.
+             *
+             * @param[in]   hop the hop number, starting at 1.
+             * @param[in]   host the address of the hop; or a null address if the hop did not reply.
+             *
+             * @returns     the data for the hop.
+             */
+            auto createHopData(
+                int hop,
+                const QHostAddress &host
+            ) -> Nedrysoft::RouteAnalyser::PingData *;
+
+            /**
+             * @brief       Sets the host name, address and location of a hop.
+             *
+             * @param[in]   pingData the data for the hop.
+             * @param[in]   hop the hop number, starting at 1.
+             * @param[in]   host the address of the hop; or a null address if the hop did not reply.
+             */
+            auto setHopHost(
+                Nedrysoft::RouteAnalyser::PingData *pingData,
+                int hop,
+                const QHostAddress &host
+            ) -> void;
+
+            /**
+             * @brief       Creates the plots for a hop and starts monitoring it.
+             *
+             * @note        The data for the hop must have been created with createHopData.
+             *
+             * @param[in]   hop the hop number, starting at 1.
+             */
+            auto createHopPlot(int hop) -> void;
+
+            /**
+             * @brief       Stops monitoring a hop and deletes its plots.
+             *
+             * @param[in]   pingData the data for the hop.
+             */
+            auto retireHop(Nedrysoft::RouteAnalyser::PingData *pingData) -> void;
+
             friend class Nedrysoft::RouteAnalyser::RouteAnalyserEditor;
         private:
             //! @cond
@@ -232,6 +312,7 @@ namespace Nedrysoft { namespace RouteAnalyser {
             QTableView *m_tableView;
             QSplitter *m_splitter;
             PlotScrollArea *m_scrollArea;
+            Nedrysoft::RouteAnalyser::PingEngineDiagnosticsWidget *m_diagnosticsWidget;
             Nedrysoft::RouteAnalyser::RouteDiscoveryWidget *m_routeDiscoveryWidget;
             Nedrysoft::RouteAnalyser::IPingEngineFactory *m_pingEngineFactory;
             int m_interval;
@@ -240,6 +321,12 @@ namespace Nedrysoft { namespace RouteAnalyser {
             ScaleMode m_graphScaleMode;
             QTimer *m_layerCleanupTimer;
             QList<PingData *> m_pingData;
+            QMap<Nedrysoft::RouteAnalyser::PingData *, QLabel *> m_plotTitleLabels;
+            QMap<Nedrysoft::RouteAnalyser::PingData *, QList<QWidget *> > m_hopWidgets;
+            QMap<Nedrysoft::RouteAnalyser::PingData *, Nedrysoft::RouteAnalyser::IPingTarget *> m_hopTargets;
+            QVBoxLayout *m_plotLayout = {};
+            QHostAddress m_routeHostAddress;
+            Nedrysoft::RouteAnalyser::RouteList m_route;
 
             QList<Nedrysoft::RouteAnalyser::IPlot *> m_extraPlots;
 
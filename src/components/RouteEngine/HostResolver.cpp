@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostResolver.h"
+
+#include <QHostInfo>
+
+constexpr auto MaximumActiveLookups = 16;
+constexpr auto MaximumHosts = 256;
+constexpr auto ResolvedTimeToLive = 300*1000;
+constexpr auto UnresolvedTimeToLive = 30*1000;
+
+Nedrysoft::RouteEngine::HostResolver::HostResolver() :
+        m_lookupCache(
+            MaximumHosts,
+            MaximumActiveLookups,
+            ResolvedTimeToLive,
+            UnresolvedTimeToLive,
+            [](const QString &, const QHostInfo &hostInfo) {
+                return (hostInfo.error() == QHostInfo::NoError) && (!hostInfo.addresses().isEmpty());
+            } ) {
+
+}
+
+Nedrysoft::RouteEngine::HostResolver::~HostResolver() {
+
+}
+
+auto Nedrysoft::RouteEngine::HostResolver::resolve(
+        const QString &host,
+        Nedrysoft::Core::IPVersion ipVersion,
+        QObject *context,
+        Nedrysoft::RouteEngine::HostResolverFunction function ) -> void {
+
+    QHostAddress hostAddress;
+
+    if (hostAddress.setAddress(host)) {
+        function(selectAddress(QList<QHostAddress>() << hostAddress, ipVersion));
+
+        return;
+    }
+
+    m_lookupCache.lookup(
+        host.toLower(),
+        context,
+        [ipVersion, function](const QHostInfo &hostInfo, bool isResolved) {
+            function(isResolved ? selectAddress(hostInfo.addresses(), ipVersion) : QHostAddress());
+        }
+    );
+}
+
+auto Nedrysoft::RouteEngine::HostResolver::clear() -> void {
+    m_lookupCache.clear();
+}
+
+auto Nedrysoft::RouteEngine::HostResolver::selectAddress(
+        const QList<QHostAddress> &addresses,
+        Nedrysoft::Core::IPVersion ipVersion ) -> QHostAddress {
+
+    auto protocol = QAbstractSocket::IPv4Protocol;
+
+    if (ipVersion == Nedrysoft::Core::IPVersion::V6) {
+        protocol = QAbstractSocket::IPv6Protocol;
+    }
+
+    for (auto &address : addresses) {
+        if (address.protocol() == protocol) {
+            return address;
+        }
+    }
+
+    return QHostAddress();
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEENGINE_HOSTRESOLVER_H
+#define PINGNOO_COMPONENTS_ROUTEENGINE_HOSTRESOLVER_H
+
+#include <HostLookupCache>
+#include <ICore>
+
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <functional>
+
+namespace Nedrysoft { namespace RouteEngine {
+    using HostResolverFunction = std::function<void(const QHostAddress &)>;
+
+    /**
+     * @brief       The HostResolver class resolves the targets of the route engines without blocking.
+     *
+     * @details     Each host name is looked up asynchronously, so opening many targets at once resolves several
+     *              of them concurrently rather than one after another.  Engines that ask for a host that is already
+     *              being looked up share that lookup, and the addresses of a host are cached (a failed lookup for a
+     *              shorter time) so that rediscovering a route does not go back to the resolver.
+     *
+     *              The address that is returned is the first one of the family given by the requested IP version.
+     *
+     * @note        The resolver must only be used from the main thread.
+     *
+     * @see         Nedrysoft::RouteAnalyser::HostLookupCache
+     */
+    class HostResolver :
+            public QObject {
+
+        private:
+            Q_OBJECT
+
+        public:
+            /**
+             * @brief       Constructs a new HostResolver.
+             */
+            HostResolver();
+
+            /**
+             * @brief       Destroys the HostResolver.
+             */
+            ~HostResolver();
+
+            /**
+             * @brief       Resolves a host to an address.
+             *
+             * @details     If the host is an address or its addresses are cached then the function is called before
+             *              this returns; otherwise it is called once the lookup has completed.
+             *
+             * @param[in]   host the host name or address.
+             * @param[in]   ipVersion the IP version of the address.
+             * @param[in]   context the function is not called if this object has been destroyed.
+             * @param[in]   function the function called with the address; or a null address if the host could not
+             *              be resolved to an address of the requested IP version.
+             */
+            auto resolve(
+                const QString &host,
+                Nedrysoft::Core::IPVersion ipVersion,
+                QObject *context,
+                Nedrysoft::RouteEngine::HostResolverFunction function
+            ) -> void;
+
+            /**
+             * @brief       Removes every host from the cache.
+             */
+            auto clear() -> void;
+
+        private:
+            /**
+             * @brief       Returns the first address of the family given by an IP version.
+             *
+             * @param[in]   addresses the addresses of the host.
+             * @param[in]   ipVersion the IP version.
+             *
+             * @returns     the address; or a null address if there is no address of that family.
+             */
+            static auto selectAddress(
+                const QList<QHostAddress> &addresses,
+                Nedrysoft::Core::IPVersion ipVersion
+            ) -> QHostAddress;
+
+        private:
+            //! @cond
+
+            Nedrysoft::RouteAnalyser::HostLookupCache m_lookupCache;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEENGINE_HOSTRESOLVER_H
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RouteCache.h"
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <chrono>
+
+constexpr auto DefaultTimeToLive = 300;
+constexpr auto MaximumRoutes = 256;
+constexpr auto TimeToLiveSetting = "RouteEngine/RouteCacheTimeToLive";
+
+Nedrysoft::RouteEngine::RouteCache::RouteCache() :
+        RouteCache(QSettings().value(TimeToLiveSetting, DefaultTimeToLive).toInt()) {
+
+}
+
+Nedrysoft::RouteEngine::RouteCache::RouteCache(int timeToLive, Nedrysoft::RouteEngine::RouteCacheClock clock) :
+        m_timeToLive(timeToLive),
+        m_clock(clock) {
+
+    if (!m_clock) {
+        m_clock = []() {
+            return static_cast<qint64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        };
+    }
+}
+
+Nedrysoft::RouteEngine::RouteCache::~RouteCache() {
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::lookup(
+        const QHostAddress &hostAddress,
+        Nedrysoft::Core::IPVersion ipVersion,
+        Nedrysoft::RouteAnalyser::RouteList &route ) -> bool {
+
+    QMutexLocker locker(&m_mutex);
+
+    auto entry = m_routes.find(RouteCacheKey(hostAddress, static_cast<int>(ipVersion)));
+
+    if (entry == m_routes.end()) {
+        return false;
+    }
+
+    if (m_clock() - entry->m_discovered >= static_cast<qint64>(m_timeToLive) * 1000) {
+        m_recentlyUsed.erase(entry->m_recentlyUsed);
+        m_routes.erase(entry);
+
+        return false;
+    }
+
+    m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, entry->m_recentlyUsed);
+
+    route = entry->m_route;
+
+    return true;
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::insert(
+        const QHostAddress &hostAddress,
+        Nedrysoft::Core::IPVersion ipVersion,
+        const Nedrysoft::RouteAnalyser::RouteList &route ) -> void {
+
+    QMutexLocker locker(&m_mutex);
+
+    if ((m_timeToLive <= 0) || (route.isEmpty())) {
+        return;
+    }
+
+    auto key = RouteCacheKey(hostAddress, static_cast<int>(ipVersion));
+    auto entry = m_routes.find(key);
+
+    if (entry != m_routes.end()) {
+        m_recentlyUsed.erase(entry->m_recentlyUsed);
+    } else {
+        entry = m_routes.insert(key, RouteCacheEntry());
+    }
+
+    m_recentlyUsed.push_front(key);
+
+    entry->m_route = route;
+    entry->m_discovered = m_clock();
+    entry->m_recentlyUsed = m_recentlyUsed.begin();
+
+    prune();
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::remove(
+        const QHostAddress &hostAddress,
+        Nedrysoft::Core::IPVersion ipVersion ) -> void {
+
+    QMutexLocker locker(&m_mutex);
+
+    auto entry = m_routes.find(RouteCacheKey(hostAddress, static_cast<int>(ipVersion)));
+
+    if (entry == m_routes.end()) {
+        return;
+    }
+
+    m_recentlyUsed.erase(entry->m_recentlyUsed);
+    m_routes.erase(entry);
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::clear() -> void {
+    QMutexLocker locker(&m_mutex);
+
+    m_routes.clear();
+    m_recentlyUsed.clear();
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::setTimeToLive(int timeToLive) -> void {
+    QMutexLocker locker(&m_mutex);
+
+    m_timeToLive = timeToLive;
+
+    prune();
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::timeToLive() -> int {
+    QMutexLocker locker(&m_mutex);
+
+    return m_timeToLive;
+}
+
+auto Nedrysoft::RouteEngine::RouteCache::prune() -> void {
+    auto maximumAge = static_cast<qint64>(m_timeToLive) * 1000;
+    auto currentTime = m_clock();
+
+    for (auto entry = m_routes.begin(); entry != m_routes.end();) {
+        if (currentTime - entry->m_discovered >= maximumAge) {
+            m_recentlyUsed.erase(entry->m_recentlyUsed);
+
+            entry = m_routes.erase(entry);
+        } else {
+            entry++;
+        }
+    }
+
+    while (m_routes.count() > MaximumRoutes) {
+        m_routes.remove(m_recentlyUsed.back());
+        m_recentlyUsed.pop_back();
+    }
+}
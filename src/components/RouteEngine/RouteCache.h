@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PINGNOO_COMPONENTS_ROUTEENGINE_ROUTECACHE_H
+#define PINGNOO_COMPONENTS_ROUTEENGINE_ROUTECACHE_H
+
+#include <ICore>
+#include <IRouteEngine>
+
+#include <QHash>
+#include <QHostAddress>
+#include <QMutex>
+#include <QPair>
+#include <functional>
+#include <list>
+
+namespace Nedrysoft { namespace RouteEngine {
+    using RouteCacheClock = std::function<qint64()>;
+
+    /**
+     * @brief       The RouteCache class holds the routes that have recently been discovered.
+     *
+     * @details     Routes are keyed by the resolved address of the target and the IP version that was used, so
+     *              opening the same destination again (for example from a favourite in another tab) can start
+     *              monitoring straight away from the cached hops while a background discovery validates them.
+     *
+     *              Entries expire once they are older than the time to live, which is read from the application
+     *              settings when the cache is created.  When the cache is full the least recently used route is
+     *              evicted.
+     *
+     * @note        The cache is shared by the route workers of every engine and may be used from any thread.
+     */
+    class RouteCache {
+        public:
+            /**
+             * @brief       Constructs a RouteCache, loading the time to live from the settings.
+             */
+            RouteCache();
+
+            /**
+             * @brief       Constructs a RouteCache with the given time to live, the settings are not used.
+             *
+             * @param[in]   timeToLive the time in seconds; or 0 to disable the cache.
+             * @param[in]   clock the function that returns the current time in milliseconds that the age of a
+             *              route is measured with; or nullptr to use the monotonic clock.
+             */
+            RouteCache(int timeToLive, Nedrysoft::RouteEngine::RouteCacheClock clock = nullptr);
+
+            /**
+             * @brief       Destroys the RouteCache.
+             */
+            ~RouteCache();
+
+            /**
+             * @brief       Returns the cached route to a target.
+             *
+             * @param[in]   hostAddress the resolved address of the target.
+             * @param[in]   ipVersion the IP version that the route was discovered with.
+             * @param[out]  route the cached route.
+             *
+             * @returns     true if an unexpired route was found; otherwise false.
+             */
+            auto lookup(
+                const QHostAddress &hostAddress,
+                Nedrysoft::Core::IPVersion ipVersion,
+                Nedrysoft::RouteAnalyser::RouteList &route
+            ) -> bool;
+
+            /**
+             * @brief       Adds or replaces the route to a target.
+             *
+             * @param[in]   hostAddress the resolved address of the target.
+             * @param[in]   ipVersion the IP version that the route was discovered with.
+             * @param[in]   route the route, which must end at the target.
+             */
+            auto insert(
+                const QHostAddress &hostAddress,
+                Nedrysoft::Core::IPVersion ipVersion,
+                const Nedrysoft::RouteAnalyser::RouteList &route
+            ) -> void;
+
+            /**
+             * @brief       Removes the route to a target.
+             *
+             * @param[in]   hostAddress the resolved address of the target.
+             * @param[in]   ipVersion the IP version that the route was discovered with.
+             */
+            auto remove(const QHostAddress &hostAddress, Nedrysoft::Core::IPVersion ipVersion) -> void;
+
+            /**
+             * @brief       Removes every route from the cache.
+             */
+            auto clear() -> void;
+
+            /**
+             * @brief       Sets how long a route is used for after it was discovered.
+             *
+             * @note        The value only applies to this cache, it is not written to the application settings.
+             *
+             * @param[in]   timeToLive the time in seconds; or 0 to disable the cache.
+             */
+            auto setTimeToLive(int timeToLive) -> void;
+
+            /**
+             * @brief       Returns how long a route is used for after it was discovered.
+             *
+             * @returns     the time in seconds.
+             */
+            auto timeToLive() -> int;
+
+        private:
+            typedef QPair<QHostAddress, int> RouteCacheKey;
+
+            /**
+             * @brief       A cached route and the time at which it was discovered.
+             */
+            struct RouteCacheEntry {
+                Nedrysoft::RouteAnalyser::RouteList m_route;
+                qint64 m_discovered;
+                std::list<RouteCacheKey>::iterator m_recentlyUsed;
+            };
+
+            /**
+             * @brief       Removes the expired routes, and the least recently used routes if the cache is full.
+             *
+             * @note        The cache must be locked by the caller.
+             */
+            auto prune() -> void;
+
+        private:
+            //! @cond
+
+            QMutex m_mutex;
+            QHash<RouteCacheKey, RouteCacheEntry> m_routes;
+            std::list<RouteCacheKey> m_recentlyUsed;
+
+            int m_timeToLive;
+            Nedrysoft::RouteEngine::RouteCacheClock m_clock;
+
+            //! @endcond
+    };
+}}
+
+#endif // PINGNOO_COMPONENTS_ROUTEENGINE_ROUTECACHE_H
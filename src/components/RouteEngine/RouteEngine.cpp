@@ -26,6 +26,7 @@
 #include <IPingEngine>
 #include <IPingEngineFactory>
 #include <IPingTarget>
+#include "HostResolver.h"
 #include "RouteEngineWorker.h"
 
 #include <QThread>
@@ -33,10 +34,27 @@
 
 #include <cassert>
 
-Nedrysoft::RouteEngine::RouteEngine::RouteEngine() :
+Nedrysoft::RouteEngine::RouteEngine::RouteEngine(
+        std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> routeCache,
+        std::shared_ptr<Nedrysoft::RouteEngine::HostResolver> hostResolver ) :
         m_routeWorkerThread(nullptr),
-        m_routeWorker(nullptr) {
+        m_routeWorker(nullptr),
+        m_engineFactory(nullptr),
+        m_ipVersion(Nedrysoft::Core::IPVersion::V4),
+        m_isResolving(false),
+        m_refreshTimer(new QTimer(this)),
+        m_refreshInterval(0),
+        m_routeCompleted(false),
+        m_routeCache(routeCache),
+        m_hostResolver(hostResolver) {
 
+    // a rediscovery is only started if the previous one has finished, so a slow discovery is never overlapped.
+
+    connect(m_refreshTimer, &QTimer::timeout, this, [=]() {
+        if ((!m_routeWorker) && (!m_isResolving)) {
+            resolveTarget(true);
+        }
+    });
 }
 
 auto Nedrysoft::RouteEngine::RouteEngine::findRoute(
@@ -44,29 +62,117 @@ auto Nedrysoft::RouteEngine::RouteEngine::findRoute(
         QString host,
         Nedrysoft::Core::IPVersion ipVersion) -> void {
 
-    m_routeWorker = new Nedrysoft::RouteEngine::RouteEngineWorker(host, engineFactory, ipVersion);
+    m_engineFactory = engineFactory;
+    m_host = host;
+    m_ipVersion = ipVersion;
+
+    m_route.clear();
+    m_routeCompleted = false;
+
+    m_refreshTimer->stop();
+
+    resolveTarget(false);
+}
+
+auto Nedrysoft::RouteEngine::RouteEngine::setRefreshInterval(int interval) -> void {
+    m_refreshInterval = interval;
+
+    if (m_refreshInterval <= 0) {
+        m_refreshTimer->stop();
+
+        return;
+    }
+
+    if ((m_routeCompleted) && (!m_route.isEmpty())) {
+        m_refreshTimer->start(m_refreshInterval);
+    }
+}
+
+auto Nedrysoft::RouteEngine::RouteEngine::resolveTarget(bool background) -> void {
+    m_isResolving = true;
+
+    m_hostResolver->resolve(m_host, m_ipVersion, this, [=](const QHostAddress &targetAddress) {
+        m_isResolving = false;
+
+        startWorker(targetAddress, background);
+    });
+}
+
+auto Nedrysoft::RouteEngine::RouteEngine::startWorker(const QHostAddress &targetAddress, bool background) -> void {
+    auto routeWorker = new Nedrysoft::RouteEngine::RouteEngineWorker(
+        m_host,
+        targetAddress,
+        m_engineFactory,
+        m_ipVersion,
+        m_routeCache
+    );
+
+    auto routeWorkerThread = new QThread();
+
+    routeWorker->setBackground(background);
 
-    m_routeWorkerThread = new QThread();
+    m_routeWorker = routeWorker;
+    m_routeWorkerThread = routeWorkerThread;
 
-    m_routeWorker->moveToThread(m_routeWorkerThread);
+    routeWorker->moveToThread(routeWorkerThread);
 
-    connect(m_routeWorkerThread,
+    connect(routeWorkerThread,
         &QThread::started,
-        m_routeWorker,
+        routeWorker,
         &Nedrysoft::RouteEngine::RouteEngineWorker::doWork
     );
 
     connect(
-        m_routeWorkerThread,
+        routeWorkerThread,
         &QThread::finished,
         [=]() {
-            m_routeWorkerThread->deleteLater();
+            routeWorkerThread->deleteLater();
     });
 
-    connect(m_routeWorker,
+    connect(routeWorker, &QObject::destroyed, this, [=]() {
+        if (m_routeWorker == routeWorker) {
+            m_routeWorker = nullptr;
+        }
+    });
+
+    connect(routeWorker,
             &Nedrysoft::RouteEngine::RouteEngineWorker::result,
             this,
-            &Nedrysoft::RouteEngine::RouteEngine::result );
+            &Nedrysoft::RouteEngine::RouteEngine::processWorkerResult );
+
+    routeWorkerThread->start();
+}
+
+auto Nedrysoft::RouteEngine::RouteEngine::processWorkerResult(
+        const QHostAddress &hostAddress,
+        const Nedrysoft::RouteAnalyser::RouteList &route,
+        bool completed,
+        int totalHops,
+        int maximumHops ) -> void {
+
+    if (!m_routeCompleted) {
+        Q_EMIT result(hostAddress, route, completed, totalHops, maximumHops);
+
+        if (completed) {
+            m_routeCompleted = true;
+            m_route = route;
+
+            if ((m_refreshInterval > 0) && (!m_route.isEmpty())) {
+                m_refreshTimer->start(m_refreshInterval);
+            }
+        }
+
+        return;
+    }
+
+    // once a route has been reported, later discoveries (a rediscovery, or the validation of a cached route) only
+    // replace it with a route that reached the target, so a transient loss does not truncate the route.
+
+    if ((!completed) || (totalHops == -1) || (route == m_route)) {
+        return;
+    }
+
+    m_route = route;
 
-    m_routeWorkerThread->start();
+    Q_EMIT routeChanged(hostAddress, route);
 }
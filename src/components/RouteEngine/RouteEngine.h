@@ -31,8 +31,10 @@
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QList>
+#include <memory>
 
 class QThread;
+class QTimer;
 
 namespace Nedrysoft { namespace Core {
     class IPingEngineFactory;
@@ -40,6 +42,8 @@ namespace Nedrysoft { namespace Core {
 }}
 
 namespace Nedrysoft { namespace RouteEngine {
+    class HostResolver;
+    class RouteCache;
     class RouteEngineWorker;
 
     /**
@@ -58,15 +62,22 @@ namespace Nedrysoft { namespace RouteEngine {
         public:
             /**
              * @brief       Constructs a RouteEngine.
+             *
+             * @param[in]   routeCache the cache of recently discovered routes shared by the engines.
+             * @param[in]   hostResolver the resolver for the targets shared by the engines.
              */
-            RouteEngine();
+            RouteEngine(
+                std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> routeCache,
+                std::shared_ptr<Nedrysoft::RouteEngine::HostResolver> hostResolver
+            );
 
         public:
             /**
              * @brief       Starts route discovery for a host.
              *
              * @note        Route discovery is a asynchronous operation, the result signal is emitted when the
-             *              discovery is completed.
+             *              discovery is completed.  If the route to the host is cached then it is reported
+             *              immediately and validated by a discovery that runs in the background.
              *
              * @param[in]   engineFactory the ping engine to be used for route discovery.
              * @param[in]   host the target host name or address.
@@ -78,12 +89,75 @@ namespace Nedrysoft { namespace RouteEngine {
                     Nedrysoft::Core::IPVersion ipVersion = Nedrysoft::Core::IPVersion::V4
             ) -> void override;
 
+            /**
+             * @brief       Sets how often the route is discovered again once the initial discovery has completed.
+             *
+             * @see         Nedrysoft::RouteAnalyser::IRouteEngine::setRefreshInterval
+             *
+             * @param[in]   interval the interval in milliseconds; or 0 to disable rediscovery.
+             */
+            auto setRefreshInterval(int interval) -> void override;
+
+        private:
+            /**
+             * @brief       Resolves the host and then starts a worker to discover the route to it.
+             *
+             * @param[in]   background true if the worker is a rediscovery of a route that has been reported;
+             *              otherwise false.
+             */
+            auto resolveTarget(bool background) -> void;
+
+            /**
+             * @brief       Starts a worker to discover the route to the host.
+             *
+             * @param[in]   targetAddress the resolved address of the host; or a null address if it could not be
+             *              resolved.
+             * @param[in]   background true if the worker is a rediscovery of a route that has been reported;
+             *              otherwise false.
+             */
+            auto startWorker(const QHostAddress &targetAddress, bool background) -> void;
+
+            /**
+             * @brief       Handles a route reported by a worker.
+             *
+             * @details     The results of the initial discovery are passed on to the listeners, after that a
+             *              completed route that reached the target and differs from the last one is reported
+             *              as a route change.
+             *
+             * @param[in]   hostAddress the target that was requested.
+             * @param[in]   route the route list.
+             * @param[in]   completed true if the route has been fully discovered; otherwise false.
+             * @param[in]   totalHops the total number of hops to the target if available; otherwise -1.
+             * @param[in]   maximumHops the maximum number of hops that were considered.
+             */
+            auto processWorkerResult(
+                const QHostAddress &hostAddress,
+                const Nedrysoft::RouteAnalyser::RouteList &route,
+                bool completed,
+                int totalHops,
+                int maximumHops
+            ) -> void;
+
         private:
             //! @cond
 
             Nedrysoft::RouteEngine::RouteEngineWorker *m_routeWorker;
             QThread *m_routeWorkerThread;
 
+            Nedrysoft::RouteAnalyser::IPingEngineFactory *m_engineFactory;
+            QString m_host;
+            Nedrysoft::Core::IPVersion m_ipVersion;
+            bool m_isResolving;
+
+            QTimer *m_refreshTimer;
+            int m_refreshInterval;
+
+            Nedrysoft::RouteAnalyser::RouteList m_route;
+            bool m_routeCompleted;
+
+            std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> m_routeCache;
+            std::shared_ptr<Nedrysoft::RouteEngine::HostResolver> m_hostResolver;
+
             //! @endcond
     };
 }}
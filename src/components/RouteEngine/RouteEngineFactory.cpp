@@ -25,7 +25,9 @@
 
 #include "RouteEngineFactory.h"
 
+#include "HostResolver.h"
 #include "ICMPSocket/ICMPSocket.h"
+#include "RouteCache.h"
 #include "RouteEngine.h"
 
 /**
@@ -39,7 +41,9 @@ class Nedrysoft::RouteEngine::RouteEngineFactoryData {
          * @param[in]   parent the RouteEngineFactory instance that this data belongs to.
          */
         RouteEngineFactoryData(Nedrysoft::RouteEngine::RouteEngineFactory *parent) :
-                m_factory(parent) {
+                m_factory(parent),
+                m_routeCache(std::make_shared<Nedrysoft::RouteEngine::RouteCache>()),
+                m_hostResolver(std::make_shared<Nedrysoft::RouteEngine::HostResolver>()) {
 
         }
 
@@ -49,6 +53,9 @@ class Nedrysoft::RouteEngine::RouteEngineFactoryData {
         Nedrysoft::RouteEngine::RouteEngineFactory *m_factory;
 
         QList<Nedrysoft::RouteEngine::RouteEngine *> m_engineList;
+
+        std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> m_routeCache;
+        std::shared_ptr<Nedrysoft::RouteEngine::HostResolver> m_hostResolver;
 };
 
 Nedrysoft::RouteEngine::RouteEngineFactory::RouteEngineFactory() :
@@ -63,7 +70,7 @@ Nedrysoft::RouteEngine::RouteEngineFactory::~RouteEngineFactory() {
 }
 
 auto Nedrysoft::RouteEngine::RouteEngineFactory::createEngine() -> Nedrysoft::RouteAnalyser::IRouteEngine * {
-    auto engineInstance = new Nedrysoft::RouteEngine::RouteEngine();
+    auto engineInstance = new Nedrysoft::RouteEngine::RouteEngine(d->m_routeCache, d->m_hostResolver);
 
     d->m_engineList.append(engineInstance);
 
@@ -23,28 +23,49 @@
 
 #include "RouteEngineWorker.h"
 
+#include "RouteCache.h"
+
 #include <IPingEngine>
 #include <IPingEngineFactory>
+#include <IPingTarget>
 #include "spdlog.h"
 
-#include <QHostInfo>
+#include <QTimer>
+#include <algorithm>
 
-constexpr auto DefaultDiscoveryTimeout = 1.0;
+constexpr auto DefaultDiscoveryTimeout = 1000;
+constexpr auto DefaultProbeInterval = 250;
+constexpr auto DefaultProbeWindow = 16;
 constexpr auto MaxRouteHops = 64;
 
 Nedrysoft::RouteEngine::RouteEngineWorker::RouteEngineWorker(
         QString host,
+        const QHostAddress &targetAddress,
         Nedrysoft::RouteAnalyser::IPingEngineFactory *pingEngineFactory,
-        Nedrysoft::Core::IPVersion ipVersion ) :
+        Nedrysoft::Core::IPVersion ipVersion,
+        std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> routeCache ) :
             m_host(host),
             m_ipVersion(ipVersion),
             m_pingEngineFactory(pingEngineFactory),
             m_isRunning(false),
-            m_maximumHops(MaxRouteHops) {
+            m_maximumHops(MaxRouteHops),
+            m_pingEngine(nullptr),
+            m_targetAddress(targetAddress),
+            m_windowTimer(nullptr),
+            m_windowEnd(0),
+            m_targetHop(-1),
+            m_reportedHops(0),
+            m_routeCache(routeCache),
+            m_isValidating(false),
+            m_isBackground(false) {
 
 }
 
 Nedrysoft::RouteEngine::RouteEngineWorker::~RouteEngineWorker() {
+    if (m_pingEngine) {
+        m_pingEngineFactory->deleteEngine(m_pingEngine);
+    }
+
     if (m_isRunning) {
         m_isRunning = false;
 
@@ -53,14 +74,9 @@ Nedrysoft::RouteEngine::RouteEngineWorker::~RouteEngineWorker() {
 }
 
 auto Nedrysoft::RouteEngine::RouteEngineWorker::doWork() -> void {
-    int totalHops = -1;
     m_isRunning = true;
 
-    auto pingEngine = m_pingEngineFactory->createEngine(m_ipVersion);
-
-    auto targetAddresses = QHostInfo::fromName(m_host).addresses();
-
-    if (!targetAddresses.count()) {
+    if (m_targetAddress.isNull()) {
         Q_EMIT result(QHostAddress(), Nedrysoft::RouteAnalyser::RouteList(), true, -1, m_maximumHops);
 
         SPDLOG_ERROR(QString("Failed to find address for %1.").arg(m_host).toStdString());
@@ -70,55 +86,266 @@ auto Nedrysoft::RouteEngine::RouteEngineWorker::doWork() -> void {
         return;
     }
 
-    auto route = Nedrysoft::RouteAnalyser::RouteList();
+    // a route that was discovered recently is reported straight away so that monitoring can start, the discovery
+    // below then runs in the background to validate it and refresh the cache.  A background rediscovery skips the
+    // cache, as it is there to find out whether the route has changed.
+
+    if (m_isBackground) {
+        m_isValidating = true;
+    } else if ((m_routeCache) && (m_routeCache->lookup(m_targetAddress, m_ipVersion, m_cachedRoute))) {
+        m_isValidating = true;
+
+        Q_EMIT result(m_targetAddress, m_cachedRoute, false, m_cachedRoute.count(), m_maximumHops);
+        Q_EMIT result(m_targetAddress, m_cachedRoute, true, m_cachedRoute.count(), m_maximumHops);
+    }
+
+    if (m_isValidating) {
+        thread()->setPriority(QThread::LowPriority);
+    }
+
+    for (auto hop = 0; hop < m_maximumHops; hop++) {
+        m_hops.append(QHostAddress());
+        m_settled.append(false);
+    }
+
+    m_pingEngine = m_pingEngineFactory->createEngine(m_ipVersion);
+
+    // unanswered hops are probed again every interval until their window times out, so a lost probe or a rate
+    // limited router does not leave a gap in the route.
+
+    m_pingEngine->setInterval(DefaultProbeInterval);
+    m_pingEngine->setTimeout(DefaultDiscoveryTimeout);
+
+    connect(m_pingEngine, &Nedrysoft::RouteAnalyser::IPingEngine::result, this, [=](
+            Nedrysoft::RouteAnalyser::PingResult pingResult) {
+
+        processResult(pingResult);
+        advance();
+    });
+
+    connect(m_pingEngine, &Nedrysoft::RouteAnalyser::IPingEngine::results, this, [=](
+            Nedrysoft::RouteAnalyser::PingResultList pingResults) {
+
+        for (auto pingResult : pingResults) {
+            processResult(pingResult);
+        }
+
+        advance();
+    });
+
+    m_windowTimer = new QTimer(this);
+
+    m_windowTimer->setSingleShot(true);
+
+    connect(m_windowTimer, &QTimer::timeout, this, [=]() {
+        closeWindow();
+        advance();
+    });
+
+    openWindow();
+
+    m_pingEngine->start();
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::setBackground(bool background) -> void {
+    m_isBackground = background;
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::openWindow() -> void {
+    auto firstHop = m_windowEnd + 1;
+
+    m_windowEnd = std::min(m_windowEnd + DefaultProbeWindow, m_maximumHops);
+
+    for (auto hop = firstHop; hop <= m_windowEnd; hop++) {
+        auto pingTarget = m_pingEngine->addTarget(m_targetAddress, hop);
+
+        if (pingTarget) {
+            m_probes[pingTarget] = hop;
+        }
+    }
+
+    // the probes of a window are spread across the probe interval, so the last probe is given the full timeout.
+
+    m_windowTimer->start(DefaultProbeInterval + DefaultDiscoveryTimeout);
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::closeWindow() -> void {
+    for (auto hop = 1; hop <= m_windowEnd; hop++) {
+        if (!m_settled[hop - 1]) {
+            settleHop(hop, QHostAddress());
+        }
+    }
+
+    reportProgress();
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::advance() -> void {
+    if (!m_pingEngine) {
+        return;
+    }
+
+    auto settledHops = routeLength();
+
+    for (auto hop = 1; hop <= settledHops; hop++) {
+        if (!m_settled[hop - 1]) {
+            return;
+        }
+    }
+
+    if ((m_targetHop != -1) || (m_windowEnd >= m_maximumHops)) {
+        finishDiscovery();
+    } else {
+        openWindow();
+    }
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::processResult(
+        Nedrysoft::RouteAnalyser::PingResult pingResult ) -> void {
+
+    if (!m_pingEngine) {
+        return;
+    }
 
-    auto pingResult = pingEngine->singleShot(
-        targetAddresses.at(0),
-        m_maximumHops,
-        DefaultDiscoveryTimeout
-    );
+    auto probe = m_probes.find(pingResult.target());
 
-    if (pingResult.code()==Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok) {
-        totalHops = pingResult.hops();
+    if (probe == m_probes.end()) {
+        return;
     }
 
-    for (int hop=1;hop<MaxRouteHops;hop++) {
-        if (!m_isRunning) {
-            m_pingEngineFactory->deleteEngine(pingEngine);
+    auto hop = probe.value();
+
+    switch (pingResult.code()) {
+        case Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok: {
+            // every probe at or beyond the hop of the target is answered by the target itself, so the lowest
+            // TTL that reached it is the length of the route and the probes beyond it are no longer needed.
+
+            if ((m_targetHop == -1) || (hop < m_targetHop)) {
+                m_targetHop = hop;
+
+                for (auto pingTarget : m_probes.keys()) {
+                    if (m_probes[pingTarget] > m_targetHop) {
+                        m_probes.remove(pingTarget);
+                        m_pingEngine->removeTarget(pingTarget);
+                    }
+                }
+            }
+
+            settleHop(hop, pingResult.hostAddress());
+
+            break;
+        }
+
+        case Nedrysoft::RouteAnalyser::PingResult::ResultCode::TimeExceeded: {
+            settleHop(hop, pingResult.hostAddress());
+
+            break;
+        }
+
+        default: {
+            // the hop is probed again at the next interval.
 
             return;
         }
+    }
+
+    reportProgress();
+}
 
-        pingResult = pingEngine->singleShot(targetAddresses.at(0), hop, DefaultDiscoveryTimeout);
+auto Nedrysoft::RouteEngine::RouteEngineWorker::settleHop(int hop, const QHostAddress &hostAddress) -> void {
+    m_hops[hop - 1] = hostAddress;
+    m_settled[hop - 1] = true;
+
+    for (auto probe = m_probes.begin(); probe != m_probes.end(); probe++) {
+        if (probe.value() == hop) {
+            m_pingEngine->removeTarget(probe.key());
+            m_probes.erase(probe);
 
-        if (pingResult.code()==Nedrysoft::RouteAnalyser::PingResult::ResultCode::Ok) {
-            route.append(pingResult.hostAddress());
             break;
-        } else  if (pingResult.code()==Nedrysoft::RouteAnalyser::PingResult::ResultCode::TimeExceeded) {
-            route.append(pingResult.hostAddress());
-        } else  {
-            route.append(QHostAddress());
         }
+    }
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::reportProgress() -> void {
+    if (m_isValidating) {
+        return;
+    }
+
+    auto reportedHops = m_reportedHops;
+    auto settledHops = routeLength();
+
+    while ((reportedHops < settledHops) && (m_settled[reportedHops])) {
+        reportedHops++;
+    }
+
+    if (reportedHops == m_reportedHops) {
+        return;
+    }
+
+    m_reportedHops = reportedHops;
+
+    Q_EMIT result(m_targetAddress, m_hops.mid(0, m_reportedHops), false, m_targetHop, m_maximumHops);
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::routeLength() -> int {
+    if (m_targetHop != -1) {
+        return m_targetHop;
+    }
+
+    return m_windowEnd;
+}
+
+auto Nedrysoft::RouteEngine::RouteEngineWorker::finishDiscovery() -> void {
+    if (!m_pingEngine) {
+        return;
+    }
+
+    // stopping the engine flushes its outstanding requests, which would otherwise be delivered back into the
+    // worker while the engine is being deleted, so the engine is detached from the worker first.
+
+    auto pingEngine = m_pingEngine;
 
-        Q_EMIT result(targetAddresses[0], route, false, totalHops, m_maximumHops);
-    };
+    m_pingEngine = nullptr;
+
+    m_windowTimer->stop();
+
+    disconnect(pingEngine, nullptr, this, nullptr);
+
+    m_pingEngineFactory->deleteEngine(pingEngine);
+
+    m_probes.clear();
+
+    auto route = m_hops.mid(0, routeLength());
 
     SPDLOG_TRACE(QString("Route to %1 (%2) completed, total of %3 hops.")
                          .arg(m_host)
-                         .arg(m_targetAddresses[0].toString())
+                         .arg(m_targetAddress.toString())
                          .arg(route.length())
                          .toStdString() );
 
+    // only a route that reached the target is cached.
+
+    if (m_routeCache) {
+        if (m_targetHop != -1) {
+            m_routeCache->insert(m_targetAddress, m_ipVersion, route);
+        } else {
+            m_routeCache->remove(m_targetAddress, m_ipVersion);
+        }
+    }
+
+    if ((m_isValidating) && (!m_isBackground) && (route != m_cachedRoute)) {
+        SPDLOG_INFO(QString("Cached route to %1 (%2) has changed.")
+                            .arg(m_host)
+                            .arg(m_targetAddress.toString())
+                            .toStdString() );
+    }
+
     /**
-     * we emit the final hop twice, oncce with completed set to false then true, this ensures that the
-     * behaviour to listeners is the same for each hop, i.e every hop gets a result signal with completed
-     * set to false, without the extra emit the final hop would behave differently.
+     * every hop has already been reported with completed set to false, so the behaviour to listeners is the same
+     * for each hop, the route is then emitted once more with completed set to true.  When validating a route that
+     * has already been reported only the completed route is emitted, the engine reports it if it has changed.
      */
 
-    Q_EMIT result(targetAddresses[0], route, false, totalHops, m_maximumHops);
-    Q_EMIT result(targetAddresses[0], route, true, totalHops, m_maximumHops);
-
-    m_pingEngineFactory->deleteEngine(pingEngine);
+    Q_EMIT result(m_targetAddress, route, true, m_targetHop, m_maximumHops);
 
     this->deleteLater();
 }
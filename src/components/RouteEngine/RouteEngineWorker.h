@@ -26,18 +26,42 @@
 
 #include <ICore>
 #include <IRouteEngine>
+#include <PingResult>
 
 #include <QHostAddress>
+#include <QMap>
 #include <QObject>
 #include <QThread>
+#include <QVector>
+#include <memory>
+
+class QTimer;
 
 namespace Nedrysoft { namespace Core {
     class IPingEngineFactory;
 }}
 
+namespace Nedrysoft { namespace RouteAnalyser {
+    class IPingEngine;
+    class IPingTarget;
+}}
+
 namespace Nedrysoft { namespace RouteEngine {
+    class RouteCache;
+
     /**
      * @brief       The worker object for route discovery.
+     *
+     * @details     Rather than probing one TTL at a time, the hops are probed in parallel windows: a probe for
+     *              every TTL in the window is added to a ping engine at once and the time exceeded (or echo)
+     *              replies are collected as they arrive.  A hop that has not answered is probed again each probe
+     *              interval until the window times out, so a route is normally discovered in one round trip plus
+     *              the timeout rather than one timeout per silent hop.
+     *
+     *              The next window is only opened if the target did not answer from within the current one.
+     *
+     *              If the route to the target is cached it is reported straight away and the discovery continues
+     *              at low priority to validate it, refreshing the cache and emitting only the completed route.
      */
     class RouteEngineWorker :
             public QObject {
@@ -48,10 +72,19 @@ namespace Nedrysoft { namespace RouteEngine {
     public:
         /**
          * @brief       Constructs a RouteEngineWorker.
+         *
+         * @param[in]   target the target host name or address.
+         * @param[in]   targetAddress the resolved address of the target; or a null address if it could not be
+         *              resolved.
+         * @param[in]   pingEngineFactory the factory used to create the ping engine for discovery.
+         * @param[in]   ipVersion the IP version to be used for discovery.
+         * @param[in]   routeCache the cache of recently discovered routes; or nullptr to always discover.
          */
         RouteEngineWorker(QString target,
+                          const QHostAddress &targetAddress,
                           Nedrysoft::RouteAnalyser::IPingEngineFactory *pingEngineFactory,
-                          Nedrysoft::Core::IPVersion ipVersion );
+                          Nedrysoft::Core::IPVersion ipVersion,
+                          std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> routeCache = nullptr );
 
         /**
          * @brief       Destroys the RouteEngineWorker.
@@ -63,6 +96,73 @@ namespace Nedrysoft { namespace RouteEngine {
          */
         auto doWork() -> void;
 
+        /**
+         * @brief       Sets whether the worker is a rediscovery of a route that has already been reported.
+         *
+         * @details     A background worker runs at low priority, does not use the cached route and only emits the
+         *              completed route.
+         *
+         * @note        Must be called before the worker is started.
+         *
+         * @param[in]   background true if the worker runs in the background; otherwise false.
+         */
+        auto setBackground(bool background) -> void;
+
+    private:
+        /**
+         * @brief       Adds a probe for each hop of the next window to the ping engine.
+         */
+        auto openWindow() -> void;
+
+        /**
+         * @brief       Gives up on the hops of the current window that have not answered.
+         */
+        auto closeWindow() -> void;
+
+        /**
+         * @brief       Opens the next window or completes the discovery once the current window is settled.
+         */
+        auto advance() -> void;
+
+        /**
+         * @brief       Records the hop that a reply came from.
+         *
+         * @param[in]   pingResult the result of a probe.
+         */
+        auto processResult(Nedrysoft::RouteAnalyser::PingResult pingResult) -> void;
+
+        /**
+         * @brief       Records the address of a hop and stops probing it.
+         *
+         * @param[in]   hop the hop number.
+         * @param[in]   hostAddress the address that answered; or a null address if the hop did not answer.
+         */
+        auto settleHop(int hop, const QHostAddress &hostAddress) -> void;
+
+        /**
+         * @brief       Emits the part of the route that has been settled since the last call.
+         *
+         * @details     Hops are settled out of order, but listeners expect the route to grow one hop at a time, so
+         *              only the settled hops that follow on from those already reported are emitted.
+         */
+        auto reportProgress() -> void;
+
+        /**
+         * @brief       Emits the completed route and releases the ping engine.
+         *
+         * @note        Does nothing if the discovery has already finished.
+         */
+        auto finishDiscovery() -> void;
+
+        /**
+         * @brief       Returns the number of hops that make up the route discovered so far.
+         *
+         * @returns     the hop of the target if it has answered; otherwise the last hop that has been probed.
+         */
+        auto routeLength() -> int;
+
+    public:
+
         /**
          * @brief       This signal is emitted when a route has finished discovery.
          *
@@ -91,6 +191,23 @@ namespace Nedrysoft { namespace RouteEngine {
         int m_maximumHops;
         bool m_isRunning;
 
+        Nedrysoft::RouteAnalyser::IPingEngine *m_pingEngine;
+        QHostAddress m_targetAddress;
+        QTimer *m_windowTimer;
+
+        QMap<Nedrysoft::RouteAnalyser::IPingTarget *, int> m_probes;
+        Nedrysoft::RouteAnalyser::RouteList m_hops;
+        QVector<bool> m_settled;
+
+        int m_windowEnd;
+        int m_targetHop;
+        int m_reportedHops;
+
+        std::shared_ptr<Nedrysoft::RouteEngine::RouteCache> m_routeCache;
+        Nedrysoft::RouteAnalyser::RouteList m_cachedRoute;
+        bool m_isValidating;
+        bool m_isBackground;
+
         //! @endcond
     };
 }}
@@ -26,6 +26,8 @@
 #include "Utils.h"
 
 #include <array>
+#include <climits>
+#include <cstring>
 
 #if defined(Q_OS_MACOS)
 #include <netinet/ip.h>
@@ -40,34 +42,9 @@
 #include <WS2tcpip.h>
 #endif
 
-#include <QDataStream>
 #include <QtEndian>
 #include <gsl/gsl>
 
-/**
- * @private
- */
-struct ipv6_header {
-    unsigned int version: 4;
-    unsigned int trafficClass: 8;
-    unsigned int flowLabel: 20;
-    uint16_t payloadLength;
-    uint8_t nextHeader;
-    uint8_t hopLimit;
-    uint8_t sourceAddress[16];
-    uint8_t destinationAddress[16];
-};
-
-/**
- * @private
- */
-struct icmp_header {
-    uint8_t type;
-    uint8_t code;
-    uint16_t checksum;
-    uint32_t reserved;
-};
-
 /**
  * @private
  */
@@ -89,6 +66,37 @@ struct icmp_v6 {
 
 constexpr auto ICMP6_ECHO = 128;
 constexpr auto ICMP6_ECHO_REPLY = 129;
+constexpr auto ICMPv6TimeExceeded = 3;
+constexpr auto ICMPv4EchoReply = 0;
+constexpr auto ICMPv4TimeExceeded = 11;
+
+constexpr auto ICMPHeaderLength = 8;
+constexpr auto ICMPChecksumOffset = 2;
+constexpr auto ICMPIdOffset = 4;
+constexpr auto ICMPSequenceOffset = 6;
+constexpr auto IPVersionShift = 4;
+constexpr auto IPv4Version = 4;
+constexpr auto IPv4MinimumHeaderLength = 20;
+constexpr auto IPv4TTLOffset = 8;
+constexpr auto IPv6HeaderLength = 40;
+constexpr unsigned int IPHeaderLengthMask = 0x0F;
+
+/**
+ * @private
+ *
+ * @brief       Reads an unaligned big endian 16 bit value.
+ *
+ * @param[in]   data pointer to the value.
+ *
+ * @returns     the value in host byte order.
+ */
+static inline auto readBigEndian16(const uint8_t *data) -> uint16_t {
+    uint16_t value;
+
+    memcpy(&value, data, sizeof(value));
+
+    return qFromBigEndian<uint16_t>(value);
+}
 
 Nedrysoft::ICMPPacket::ICMPPacket::ICMPPacket() :
         m_resultCode(Invalid),
@@ -117,119 +125,264 @@ auto Nedrysoft::ICMPPacket::ICMPPacket::fromData(
         const QByteArray &dataBuffer,
         Nedrysoft::ICMPPacket::IPVersion version) -> Nedrysoft::ICMPPacket::ICMPPacket {
 
-    if (version == Nedrysoft::ICMPPacket::V4) {
-        return fromData_v4(dataBuffer);
-    } else if (version == Nedrysoft::ICMPPacket::V6) {
-        return fromData_v6(dataBuffer);
-    } else {
+    auto parseResult = parse(dataBuffer.constData(), dataBuffer.length(), version);
+
+    if (parseResult.resultCode == Nedrysoft::ICMPPacket::Invalid) {
         return ICMPPacket();
     }
+
+    return ICMPPacket(
+        parseResult.id,
+        parseResult.sequence,
+        parseResult.resultCode,
+        parseResult.version,
+        parseResult.ttl
+    );
 }
 
-auto Nedrysoft::ICMPPacket::ICMPPacket::fromData_v4(const QByteArray &dataBuffer) -> Nedrysoft::ICMPPacket::ICMPPacket {
-    unsigned char ip_vhl;
-    unsigned char ip_vhl_tx;
-    unsigned char ip_header_size;
-    unsigned char ip_header_size_tx;
-    uint16_t received_id;
-    uint16_t received_sequence;
-    constexpr unsigned int IP_HEADER_LENGTH_MASK = 0x0F;
+auto Nedrysoft::ICMPPacket::ICMPPacket::parse(
+        gsl::span<const uint8_t> data,
+        Nedrysoft::ICMPPacket::IPVersion version) -> Nedrysoft::ICMPPacket::ICMPParseResult {
+
+    return parse(data.data(), static_cast<int>(data.size()), version);
+}
 
-    auto mainSpan = gsl::span<const unsigned char>(
-            reinterpret_cast<const unsigned char *>(dataBuffer.data()),
-            dataBuffer.length() );
+auto Nedrysoft::ICMPPacket::ICMPPacket::parse(
+        const void *data,
+        int length,
+        Nedrysoft::ICMPPacket::IPVersion version) -> Nedrysoft::ICMPPacket::ICMPParseResult {
 
-    ip_vhl = mainSpan[0];
-    ip_header_size = ( ip_vhl & IP_HEADER_LENGTH_MASK ) * sizeof(uint32_t);
+    auto packet = static_cast<const uint8_t *>(data);
+    auto icmpOffset = 0;
+    int requestOffset;
+
+    Nedrysoft::ICMPPacket::ICMPParseResult parseResult = {
+        Nedrysoft::ICMPPacket::Invalid, version, 0, 0, 0, 0, -1, 0, 0
+    };
+
+    if ((!packet) || (length < ICMPHeaderLength)) {
+        return parseResult;
+    }
+
+    if (version == Nedrysoft::ICMPPacket::V4) {
+        // raw sockets deliver the ip header, datagram sockets deliver only the icmp message.
 
-    auto responseSpan = mainSpan.subspan(ip_header_size);
+        if ((packet[0] >> IPVersionShift) == IPv4Version) {
+            icmpOffset = ( packet[0] & IPHeaderLengthMask ) * static_cast<int>(sizeof(uint32_t));
 
-    auto icmp_response = reinterpret_cast<const struct icmp *>(responseSpan.data());
+            if ((icmpOffset < IPv4MinimumHeaderLength) || (icmpOffset + ICMPHeaderLength > length)) {
+                return parseResult;
+            }
 
-    if (icmp_response->icmp_code == ICMP_ECHOREPLY) {
-        if (icmp_response->icmp_type == ICMP_ECHOREPLY) {
-            auto ip_response = reinterpret_cast<const struct ip *>(dataBuffer.data());
+            parseResult.ttl = packet[IPv4TTLOffset];
+        }
 
-            received_id = qFromBigEndian<uint16_t>(icmp_response->icmp_hun.ih_idseq.icd_id);
-            received_sequence = qFromBigEndian<uint16_t>(icmp_response->icmp_hun.ih_idseq.icd_seq);
+        parseResult.type = packet[icmpOffset];
+        parseResult.code = packet[icmpOffset + 1];
 
-            return ICMPPacket(received_id, received_sequence, EchoReply, V4, ip_response->ip_ttl);
+        if (parseResult.code != 0) {
+            return parseResult;
         }
 
-        if (icmp_response->icmp_type == ICMP_TIMXCEED) {
-            constexpr unsigned int IP_HEADER_OFFSET = 0x08;
+        if (parseResult.type == ICMPv4EchoReply) {
+            requestOffset = icmpOffset;
+
+            parseResult.resultCode = Nedrysoft::ICMPPacket::EchoReply;
+        } else if (parseResult.type == ICMPv4TimeExceeded) {
+            auto quotedOffset = icmpOffset + ICMPHeaderLength;
+
+            if ((quotedOffset >= length) || ((packet[quotedOffset] >> IPVersionShift) != IPv4Version)) {
+                return parseResult;
+            }
 
-            ip_vhl_tx = mainSpan[ip_header_size + IP_HEADER_OFFSET];
-            ip_header_size_tx = ( ip_vhl_tx & IP_HEADER_LENGTH_MASK ) * sizeof(uint32_t);
+            auto quotedHeaderLength =
+                    ( packet[quotedOffset] & IPHeaderLengthMask ) * static_cast<int>(sizeof(uint32_t));
 
-            auto receivedRequestSpan = mainSpan.subspan(ip_header_size + IP_HEADER_OFFSET + ip_header_size_tx);
+            if (quotedHeaderLength < IPv4MinimumHeaderLength) {
+                return parseResult;
+            }
 
-            auto received_icmp_request = reinterpret_cast<const struct icmp *>(receivedRequestSpan.data());
+            requestOffset = quotedOffset + quotedHeaderLength;
 
-            received_id = qFromBigEndian<uint16_t>(received_icmp_request->icmp_hun.ih_idseq.icd_id);
+            parseResult.ttl = -1;
+            parseResult.resultCode = Nedrysoft::ICMPPacket::TimeExceeded;
+        } else {
+            return parseResult;
+        }
+    } else if (version == Nedrysoft::ICMPPacket::V6) {
+        // ipv6 sockets never deliver the ip header, so the hop limit of the response is not available.
 
-            received_sequence = qFromBigEndian<uint16_t>(received_icmp_request->icmp_hun.ih_idseq.icd_seq);
+        parseResult.type = packet[0];
+        parseResult.code = packet[1];
 
-            return ICMPPacket(received_id, received_sequence, TimeExceeded, V4, -1);
+        if (parseResult.code != 0) {
+            return parseResult;
         }
+
+        if (parseResult.type == ICMP6_ECHO_REPLY) {
+            requestOffset = 0;
+
+            parseResult.resultCode = Nedrysoft::ICMPPacket::EchoReply;
+        } else if (parseResult.type == ICMPv6TimeExceeded) {
+            requestOffset = ICMPHeaderLength + IPv6HeaderLength;
+
+            parseResult.resultCode = Nedrysoft::ICMPPacket::TimeExceeded;
+        } else {
+            return parseResult;
+        }
+    } else {
+        return parseResult;
     }
 
-    return ICMPPacket();
-}
+    if (requestOffset + ICMPHeaderLength > length) {
+        parseResult.resultCode = Nedrysoft::ICMPPacket::Invalid;
 
-auto Nedrysoft::ICMPPacket::ICMPPacket::fromData_v6(const QByteArray &dataBuffer) -> Nedrysoft::ICMPPacket::ICMPPacket {
-    uint16_t received_id;
-    uint16_t received_sequence;
+        return parseResult;
+    }
 
-    auto responseSpan = gsl::span<const unsigned char>(
-            reinterpret_cast<const unsigned char *>(dataBuffer.data()),
-            dataBuffer.length() );
+    parseResult.id = readBigEndian16(packet + requestOffset + ICMPIdOffset);
+    parseResult.sequence = readBigEndian16(packet + requestOffset + ICMPSequenceOffset);
+    parseResult.payloadOffset = requestOffset + ICMPHeaderLength;
+    parseResult.payloadLength = length - parseResult.payloadOffset;
 
-    auto icmp_response = reinterpret_cast<const struct icmp *>(responseSpan.data());
+    return parseResult;
+}
 
-    if (icmp_response->icmp_code == 0) {
-        if (icmp_response->icmp_type == ICMP6_ECHO_REPLY) {
-            received_id = qFromBigEndian<uint16_t>(icmp_response->icmp_hun.ih_idseq.icd_id);
-            received_sequence = qFromBigEndian<uint16_t>(icmp_response->icmp_hun.ih_idseq.icd_seq);
+auto Nedrysoft::ICMPPacket::ICMPPacket::checksum(const void *buffer, int length) -> uint16_t {
+    auto data = static_cast<const uint8_t *>(buffer);
+    uint64_t checksum = 0;
 
-            return ICMPPacket(received_id, received_sequence, EchoReply, V6, -1);
-        }
+    // the ones' complement sum is independent of word size and byte order, so the buffer is summed 64 bits at a time
+    // with the end around carry folded back in, and then reduced to 16 bits.
 
-        if (icmp_response->icmp_type == 3) {
-            auto ip_response = reinterpret_cast<const struct ipv6_header *>(dataBuffer.data());
-            auto request_icmp_header = responseSpan.subspan(sizeof(icmp_header) + sizeof(ipv6_header));
+    while (length >= static_cast<int>(sizeof(uint64_t))) {
+        uint64_t word;
 
-            auto rx_icmp_request = reinterpret_cast<const struct icmp *>(request_icmp_header.data());
+        memcpy(&word, data, sizeof(word));
 
-            received_id = qFromBigEndian<uint16_t>(rx_icmp_request->icmp_hun.ih_idseq.icd_id);
-            received_sequence = qFromBigEndian<uint16_t>(rx_icmp_request->icmp_hun.ih_idseq.icd_seq);
+        checksum += word;
 
-            return ICMPPacket(received_id, received_sequence, TimeExceeded, V6, ip_response->hopLimit);
+        if (checksum < word) {
+            checksum++;
         }
+
+        data += sizeof(uint64_t);
+        length -= sizeof(uint64_t);
     }
 
-    return ICMPPacket();
-}
+    while (length >= static_cast<int>(sizeof(uint16_t))) {
+        uint16_t word;
 
-auto Nedrysoft::ICMPPacket::ICMPPacket::checksum(void *buffer, int length) -> uint16_t {
-    QByteArray dataArray(reinterpret_cast<char *>(buffer), length);
-    QDataStream dataStream(dataArray);
-    uint32_t checksum = 0;
+        memcpy(&word, data, sizeof(word));
 
-    dataStream.setByteOrder(QDataStream::LittleEndian);
+        checksum += word;
 
-    while (!dataStream.atEnd()) {
-        checksum += read<uint16_t>(dataStream);
+        if (checksum < word) {
+            checksum++;
+        }
 
-        length -= 2;
+        data += sizeof(uint16_t);
+        length -= sizeof(uint16_t);
     }
 
+    checksum = ( checksum >> 32 ) + ( checksum & UINT32_MAX );
+    checksum = ( checksum >> 32 ) + ( checksum & UINT32_MAX );
     checksum = ( checksum >> ( sizeof(uint16_t) * CHAR_BIT )) + ( checksum & UINT16_MAX );
     checksum += ( checksum >> ( sizeof(uint16_t) * CHAR_BIT ));
 
     return static_cast<uint16_t>(~checksum);
 }
 
+auto Nedrysoft::ICMPPacket::ICMPPacket::updateChecksum(
+        uint16_t checksum,
+        uint16_t oldValue,
+        uint16_t newValue) -> uint16_t {
+
+    // RFC 1624 equation 3: HC' = ~(~HC + ~m + m')
+
+    uint32_t updatedChecksum = static_cast<uint16_t>(~checksum);
+
+    updatedChecksum += static_cast<uint16_t>(~oldValue);
+    updatedChecksum += newValue;
+
+    updatedChecksum = ( updatedChecksum >> ( sizeof(uint16_t) * CHAR_BIT )) + ( updatedChecksum & UINT16_MAX );
+    updatedChecksum += ( updatedChecksum >> ( sizeof(uint16_t) * CHAR_BIT ));
+
+    return static_cast<uint16_t>(~updatedChecksum);
+}
+
+auto Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest(
+        void *packet,
+        int length,
+        uint16_t id,
+        uint16_t sequence) -> bool {
+
+    auto data = static_cast<uint8_t *>(packet);
+
+    if ((!data) || (length < ICMPHeaderLength)) {
+        return false;
+    }
+
+    uint16_t checksum, oldId, oldSequence;
+    uint16_t newId = qToBigEndian<uint16_t>(id);
+    uint16_t newSequence = qToBigEndian<uint16_t>(sequence);
+
+    memcpy(&checksum, data + ICMPChecksumOffset, sizeof(checksum));
+    memcpy(&oldId, data + ICMPIdOffset, sizeof(oldId));
+    memcpy(&oldSequence, data + ICMPSequenceOffset, sizeof(oldSequence));
+
+    checksum = updateChecksum(checksum, oldId, newId);
+    checksum = updateChecksum(checksum, oldSequence, newSequence);
+
+    memcpy(data + ICMPIdOffset, &newId, sizeof(newId));
+    memcpy(data + ICMPSequenceOffset, &newSequence, sizeof(newSequence));
+    memcpy(data + ICMPChecksumOffset, &checksum, sizeof(checksum));
+
+    return true;
+}
+
+auto Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest(
+        void *packet,
+        int length,
+        uint16_t id,
+        uint16_t sequence,
+        uint16_t tag) -> bool {
+
+    auto data = static_cast<uint8_t *>(packet);
+
+    if (length < ICMPHeaderLength + static_cast<int>(sizeof(tag))) {
+        return false;
+    }
+
+    if (!updateEchoRequest(packet, length, id, sequence)) {
+        return false;
+    }
+
+    uint16_t checksum, oldTag;
+    uint16_t newTag = qToBigEndian<uint16_t>(tag);
+
+    memcpy(&checksum, data + ICMPChecksumOffset, sizeof(checksum));
+    memcpy(&oldTag, data + ICMPHeaderLength, sizeof(oldTag));
+
+    checksum = updateChecksum(checksum, oldTag, newTag);
+
+    memcpy(data + ICMPHeaderLength, &newTag, sizeof(newTag));
+    memcpy(data + ICMPChecksumOffset, &checksum, sizeof(checksum));
+
+    return true;
+}
+
+auto Nedrysoft::ICMPPacket::ICMPPacket::payloadTag(
+        const void *data,
+        const Nedrysoft::ICMPPacket::ICMPParseResult &parseResult) -> int {
+
+    if ((!data) || (parseResult.resultCode == Nedrysoft::ICMPPacket::Invalid) || (parseResult.payloadLength < 2)) {
+        return -1;
+    }
+
+    return readBigEndian16(static_cast<const uint8_t *>(data) + parseResult.payloadOffset);
+}
+
 auto Nedrysoft::ICMPPacket::ICMPPacket::resultCode() -> Nedrysoft::ICMPPacket::ResultCode {
     return m_resultCode;
 }
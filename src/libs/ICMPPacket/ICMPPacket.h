@@ -26,9 +26,9 @@
 
 #include <QtGlobal>
 
-#include <QDataStream>
 #include <QHostAddress>
 #include <cstdint>
+#include <gsl/gsl>
 #include <vector>
 
 #if defined(Q_OS_WIN)
@@ -54,6 +54,27 @@ namespace Nedrysoft { namespace ICMPPacket {
         TimeExceeded = 2
     };
 
+    /**
+     * @brief       The ICMPParseResult structure holds the fields decoded from a received ICMP packet.
+     *
+     * @details     This is a plain structure that is returned by value from ICMPPacket::parse, decoding a packet
+     *              does not copy the packet or allocate any memory.  The payload offset is relative to the start of
+     *              the buffer that was parsed and refers to the payload of the echo request or reply that the packet
+     *              relates to, for a time exceeded message this is the payload of the quoted request which may be
+     *              truncated by the router that generated the message.
+     */
+    struct ICMPParseResult {
+        Nedrysoft::ICMPPacket::ResultCode resultCode;
+        Nedrysoft::ICMPPacket::IPVersion version;
+        uint8_t type;
+        uint8_t code;
+        uint16_t id;
+        uint16_t sequence;
+        int ttl;
+        int payloadOffset;
+        int payloadLength;
+    };
+
     /**
      * @brief       THe ICMPPacket class provides functions to decode and encode ICMP packets.
      */
@@ -70,14 +91,68 @@ namespace Nedrysoft { namespace ICMPPacket {
             static auto fromData(const QByteArray &dataBuffer, IPVersion version) -> ICMPPacket;
 
             /**
-             * @brief       Calculate ICMP crc16 from raw data.
+             * @brief       Decodes a raw ICMP packet without copying it.
+             *
+             * @details     Every field is bounds checked against the supplied buffer, a truncated or malformed
+             *              packet results in a ResultCode of Invalid rather than an out of bounds read.  For IPv4
+             *              the packet may either start with the IP header (raw sockets) or with the ICMP header
+             *              (datagram sockets), the two are distinguished by the IP version nibble.
+             *
+             * @param[in]   data the raw packet.
+             * @param[in]   version version of ICMP packet we are expecting.
+             *
+             * @returns     the decoded fields.
+             */
+            static auto parse(
+                gsl::span<const uint8_t> data,
+                Nedrysoft::ICMPPacket::IPVersion version
+            ) -> Nedrysoft::ICMPPacket::ICMPParseResult;
+
+            /**
+             * @brief       Decodes a raw ICMP packet without copying it.
+             *
+             * @see         Nedrysoft::ICMPPacket::ICMPPacket::parse
+             *
+             * @param[in]   data pointer to the raw packet.
+             * @param[in]   length the length of the raw packet.
+             * @param[in]   version version of ICMP packet we are expecting.
+             *
+             * @returns     the decoded fields.
+             */
+            static auto parse(
+                const void *data,
+                int length,
+                Nedrysoft::ICMPPacket::IPVersion version
+            ) -> Nedrysoft::ICMPPacket::ICMPParseResult;
+
+            /**
+             * @brief       Calculate the ICMP (RFC 1071 ones' complement) checksum from raw data.
+             *
+             * @details     The buffer is summed as native 16 bit words, 64 bits at a time, so the result can be
+             *              stored directly into the packet on any host.  A trailing odd byte is not included in
+             *              the sum; packets built by this class always have an even length.
              *
              * @param[in]   buffer the raw icmp packet.
              * @param[in]   length the length of the packet.
              *
-             * @returns     the crc16 result.
+             * @returns     the checksum.
              */
-            static auto checksum(void *buffer, int length) -> uint16_t;
+            static auto checksum(const void *buffer, int length) -> uint16_t;
+
+            /**
+             * @brief       Incrementally updates a checksum after a single 16 bit word in the packet has changed.
+             *
+             * @details     Implements equation 3 of RFC 1624, allowing a field such as the sequence number to be
+             *              rewritten without summing the whole packet again.  The old and new values must be in the
+             *              same byte order as they are stored in the packet.
+             *
+             * @param[in]   checksum the checksum currently stored in the packet.
+             * @param[in]   oldValue the previous value of the word.
+             * @param[in]   newValue the new value of the word.
+             *
+             * @returns     the updated checksum.
+             */
+            static auto updateChecksum(uint16_t checksum, uint16_t oldValue, uint16_t newValue) -> uint16_t;
 
             /**
              * @brief       Create a ping request packet.
@@ -100,6 +175,59 @@ namespace Nedrysoft { namespace ICMPPacket {
                 Nedrysoft::ICMPPacket::IPVersion version
             ) -> QByteArray;
 
+            /**
+             * @brief       Rewrites the id and sequence of an echo request created by pingPacket.
+             *
+             * @details     The fields are patched in place and the checksum is updated incrementally, allowing a
+             *              packet to be built once and then reused for every request without allocating.
+             *
+             * @param[in,out]   packet the echo request.
+             * @param[in]       length the length of the echo request.
+             * @param[in]       id the new packet id.
+             * @param[in]       sequence the new packet sequence.
+             *
+             * @returns     true if the packet was updated; otherwise false if it is too short.
+             */
+            static auto updateEchoRequest(void *packet, int length, uint16_t id, uint16_t sequence) -> bool;
+
+            /**
+             * @brief       Rewrites the id, sequence and tag of an echo request created by pingPacket.
+             *
+             * @details     The tag is stored in the first 16 bits of the payload, which is returned unchanged in an
+             *              echo reply (and usually in the request quoted by an error), allowing a reply to be matched
+             *              against more than the id and sequence.
+             *
+             * @param[in,out]   packet the echo request.
+             * @param[in]       length the length of the echo request.
+             * @param[in]       id the new packet id.
+             * @param[in]       sequence the new packet sequence.
+             * @param[in]       tag the new payload tag.
+             *
+             * @returns     true if the packet was updated; otherwise false if it is too short.
+             */
+            static auto updateEchoRequest(
+                void *packet,
+                int length,
+                uint16_t id,
+                uint16_t sequence,
+                uint16_t tag
+            ) -> bool;
+
+            /**
+             * @brief       Returns the payload tag of a decoded packet.
+             *
+             * @see         Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest
+             *
+             * @param[in]   data the raw packet that was passed to parse.
+             * @param[in]   parseResult the result of parsing the packet.
+             *
+             * @returns     the tag; otherwise -1 if the payload is too short to contain one.
+             */
+            static auto payloadTag(
+                const void *data,
+                const Nedrysoft::ICMPPacket::ICMPParseResult &parseResult
+            ) -> int;
+
             /**
              * @brief       Returns the result of a packet decode.
              *
@@ -152,24 +280,6 @@ namespace Nedrysoft { namespace ICMPPacket {
              */
             ICMPPacket(uint16_t id, uint16_t sequence, ResultCode resultCode, IPVersion ipVersion, int ttl);
 
-            /**
-             * @brief       Decodes an ipv4 icmp packet for from raw data.
-             *
-             * @param[in]   dataBuffer the raw data.
-             *
-             * @returns     the decoded icmp packet.
-             */
-            static auto fromData_v4(const QByteArray &dataBuffer) -> ICMPPacket;
-
-            /**
-             * @brief       Decodes a ipv6 icmp packet for from raw data.
-             *
-             * @param[in]   dataBuffer the raw data.
-             *
-             * @returns     the decoded icmp packet.
-             */
-            static auto fromData_v6(const QByteArray &dataBuffer) -> ICMPPacket;
-
             /**
              * @brief       Creates an ipv6 icmp packet.
              *
@@ -204,18 +314,6 @@ namespace Nedrysoft { namespace ICMPPacket {
                 const QHostAddress &destinationAddress
             ) -> QByteArray;
 
-            /**
-             * @brief       Template to read raw data from a data stream.
-             */
-            template<class T>
-            static auto read(QDataStream &dataStream) -> T {
-                T data;
-
-                dataStream >> data;
-
-                return data;
-            }
-
         private:
             //! @cond
 
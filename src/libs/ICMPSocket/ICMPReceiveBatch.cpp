@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ICMPReceiveBatch.h"
+
+#if defined(Q_OS_LINUX)
+constexpr auto ControlBufferSize = 128;
+#endif
+
+Nedrysoft::ICMPSocket::ICMPReceiveBatch::ICMPReceiveBatch(int capacity, int datagramSize) :
+        m_capacity(capacity),
+        m_datagramSize(datagramSize),
+        m_count(0),
+        m_arena(static_cast<size_t>(capacity) * static_cast<size_t>(datagramSize)),
+        m_lengths(capacity),
+        m_timestamps(capacity),
+        m_addresses(capacity) {
+
+#if defined(Q_OS_LINUX)
+    // the message headers point into the arena and never move, so they are only set up once.
+
+    m_controlSize = ControlBufferSize;
+
+    m_headers.resize(capacity);
+    m_vectors.resize(capacity);
+    m_control.resize(static_cast<size_t>(capacity) * static_cast<size_t>(m_controlSize));
+
+    for (auto index = 0; index < capacity; index++) {
+        m_vectors[index].iov_base = &m_arena[static_cast<size_t>(index) * static_cast<size_t>(datagramSize)];
+        m_vectors[index].iov_len = static_cast<size_t>(datagramSize);
+
+        memset(&m_headers[index], 0, sizeof(struct mmsghdr));
+
+        m_headers[index].msg_hdr.msg_iov = &m_vectors[index];
+        m_headers[index].msg_hdr.msg_iovlen = 1;
+        m_headers[index].msg_hdr.msg_control =
+                &m_control[static_cast<size_t>(index) * static_cast<size_t>(m_controlSize)];
+    }
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::capacity() const -> int {
+    return m_capacity;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::count() const -> int {
+    return m_count;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::data(int index) const -> const char * {
+    return &m_arena[static_cast<size_t>(index) * static_cast<size_t>(m_datagramSize)];
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::length(int index) const -> int {
+    return m_lengths[index];
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::timestamp(int index) const -> int64_t {
+    return m_timestamps[index];
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::hostAddress(int index) const -> QHostAddress {
+    return QHostAddress(reinterpret_cast<const sockaddr *>(&m_addresses[index]));
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::version(int index) const -> Nedrysoft::ICMPSocket::IPVersion {
+    if (m_addresses[index].ss_family == AF_INET6) {
+        return Nedrysoft::ICMPSocket::V6;
+    }
+
+    return Nedrysoft::ICMPSocket::V4;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPReceiveBatch::clear() -> void {
+    m_count = 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NEDRYSOFT_ICMPSOCKET_ICMPRECEIVEBATCH_H
+#define NEDRYSOFT_ICMPSOCKET_ICMPRECEIVEBATCH_H
+
+#include "ICMPSocket.h"
+
+#include <QHostAddress>
+#include <cstdint>
+#include <vector>
+
+namespace Nedrysoft { namespace ICMPSocket {
+    /**
+     * @brief       The ICMPReceiveBatch class holds a set of datagrams read from an ICMPSocket in a single call.
+     *
+     * @details     All storage is allocated when the batch is constructed; datagrams are read directly into a
+     *              fixed arena which is reused by every call to ICMPSocket::recvBatch, so the receive path does
+     *              not allocate.  The data pointers returned by a batch are only valid until the next receive.
+     */
+    class NEDRYSOFT_ICMPSOCKET_DLLSPEC ICMPReceiveBatch {
+        public:
+            /**
+             * @brief       Constructs a new ICMPReceiveBatch.
+             *
+             * @param[in]   capacity the maximum number of datagrams that can be read in a single call.
+             * @param[in]   datagramSize the size of the arena slot reserved for each datagram.
+             */
+            explicit ICMPReceiveBatch(int capacity = 64, int datagramSize = 4096);
+
+            /**
+             * @brief       Returns the maximum number of datagrams that the batch can hold.
+             *
+             * @returns     the capacity of the batch.
+             */
+            auto capacity() const -> int;
+
+            /**
+             * @brief       Returns the number of datagrams held in the batch.
+             *
+             * @returns     the number of datagrams.
+             */
+            auto count() const -> int;
+
+            /**
+             * @brief       Returns the data of a datagram.
+             *
+             * @param[in]   index the index of the datagram.
+             *
+             * @returns     a pointer to the datagram in the arena.
+             */
+            auto data(int index) const -> const char *;
+
+            /**
+             * @brief       Returns the length of a datagram.
+             *
+             * @param[in]   index the index of the datagram.
+             *
+             * @returns     the length in bytes.
+             */
+            auto length(int index) const -> int;
+
+            /**
+             * @brief       Returns the time at which a datagram was received.
+             *
+             * @see         Nedrysoft::ICMPSocket::ICMPSocket::timestamp
+             *
+             * @param[in]   index the index of the datagram.
+             *
+             * @returns     the receive timestamp in nanoseconds since the unix epoch.
+             */
+            auto timestamp(int index) const -> int64_t;
+
+            /**
+             * @brief       Returns the address that a datagram was received from.
+             *
+             * @note        The QHostAddress is constructed on demand, callers should only request it once they know
+             *              the datagram is of interest.
+             *
+             * @param[in]   index the index of the datagram.
+             *
+             * @returns     the source address.
+             */
+            auto hostAddress(int index) const -> QHostAddress;
+
+            /**
+             * @brief       Returns the IP version of the socket that a datagram was received on.
+             *
+             * @details     The version is taken from the family of the source address, so a batch that was drained
+             *              from sockets of both families can be decoded without constructing a QHostAddress.
+             *
+             * @param[in]   index the index of the datagram.
+             *
+             * @returns     the IP version.
+             */
+            auto version(int index) const -> Nedrysoft::ICMPSocket::IPVersion;
+
+            /**
+             * @brief       Empties the batch.
+             */
+            auto clear() -> void;
+
+            friend class ICMPSocket;
+            friend class ICMPRing;
+            friend class ICMPRingData;
+
+        private:
+            //! @cond
+
+            int m_capacity;
+            int m_datagramSize;
+            int m_count;
+
+            std::vector<char> m_arena;
+            std::vector<int> m_lengths;
+            std::vector<int64_t> m_timestamps;
+            std::vector<struct sockaddr_storage> m_addresses;
+#if defined(Q_OS_LINUX)
+            std::vector<struct mmsghdr> m_headers;
+            std::vector<struct iovec> m_vectors;
+            std::vector<char> m_control;
+            int m_controlSize;
+#endif
+
+            //! @endcond
+    };
+}}
+
+#endif // NEDRYSOFT_ICMPSOCKET_ICMPRECEIVEBATCH_H
@@ -0,0 +1,1004 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ICMPRing.h"
+
+#include "ICMPReceiveBatch.h"
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+constexpr auto BufferCount = 256u;
+constexpr auto BufferGroup = 0;
+constexpr auto DatagramSize = 4096;
+constexpr auto ControlBufferSize = 64;
+constexpr auto BufferSize = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_storage) +
+                            ControlBufferSize + DatagramSize;
+constexpr auto SendSlotsPerEntry = 4;
+constexpr auto ProbeTimeout = 100;
+constexpr auto OperationShift = 56;
+constexpr auto ValueMask = (static_cast<uint64_t>(1) << OperationShift) - 1;
+constexpr auto RequiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_SUBMIT_STABLE |
+                                  IORING_FEAT_EXT_ARG;
+
+enum Operation : uint64_t {
+    SendOperation = 1,
+    TimeoutOperation = 2,
+    ReceiveOperation = 3,
+    CancelOperation = 4,
+    WakeOperation = 5
+};
+
+constexpr auto userData(Operation operation, uint64_t value) -> uint64_t {
+    return (static_cast<uint64_t>(operation) << OperationShift) | (value & ValueMask);
+}
+#endif
+
+/**
+ * @brief       Private class to store the ring instance data.
+ */
+class Nedrysoft::ICMPSocket::ICMPRingData {
+    public:
+        /**
+         * @brief       Constructs a ICMPRingData.
+         *
+         * @param[in]   parent the ICMPRing instance that this data belongs to.
+         */
+        ICMPRingData(Nedrysoft::ICMPSocket::ICMPRing *parent) :
+                m_ring(parent) {
+
+        }
+
+        /**
+         * @brief       Destroys the ICMPRingData, releasing the kernel ring and its mappings.
+         */
+        ~ICMPRingData() {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+            if (m_bufferRing) {
+                munmap(m_bufferRing, m_bufferRingSize);
+            }
+
+            if (m_submissions) {
+                munmap(m_submissions, m_submissionsSize);
+            }
+
+            if (m_ringMemory) {
+                munmap(m_ringMemory, m_ringSize);
+            }
+
+            if (m_ringDescriptor >= 0) {
+                close(m_ringDescriptor);
+            }
+
+            if (m_wakeDescriptor >= 0) {
+                close(m_wakeDescriptor);
+            }
+#endif
+        }
+
+        friend class ICMPRing;
+
+    private:
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+        /**
+         * @brief       The storage for a send that is in flight.
+         *
+         * @details     The kernel reads the packet and the control data when it performs the send, which may be after
+         *              the caller has reused its own buffers, so the slot keeps its own copy of everything the send
+         *              refers to.  The data buffer keeps its capacity when the slot is reused.
+         */
+        struct SendSlot {
+            struct msghdr header;
+            struct iovec vector;
+            struct sockaddr_storage address;
+            alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+            std::vector<char> data;
+            QHostAddress hostAddress;
+            int ttl;
+        };
+
+        /**
+         * @brief       A socket that has a multishot receive armed.
+         */
+        struct Receiver {
+            Nedrysoft::ICMPSocket::ICMPSocket *socket;
+            int socketDescriptor;
+            struct msghdr header;
+            bool armed;
+            bool removed;
+        };
+
+        /**
+         * @brief       Maps the kernel ring and registers the receive buffers.
+         *
+         * @param[in]   entries the number of submission queue entries.
+         *
+         * @returns     true if the ring is ready for use; otherwise false.
+         */
+        auto initialise(int entries) -> bool;
+
+        /**
+         * @brief       Checks that the kernel supports multishot receives with provided buffers.
+         *
+         * @returns     true if multishot receives are supported; otherwise false.
+         */
+        auto probeMultishot() -> bool;
+
+        /**
+         * @brief       Returns the next free submission queue entry.
+         *
+         * @returns     the cleared entry; otherwise nullptr if the queue is full.
+         */
+        auto getSubmission() -> struct io_uring_sqe *;
+
+        /**
+         * @brief       Submits the queued entries, optionally waiting for completions.
+         *
+         * @param[in]   minimumComplete the number of completions to wait for.
+         * @param[in]   timeout the maximum time to wait in milliseconds.
+         */
+        auto submit(unsigned int minimumComplete, int timeout) -> void;
+
+        /**
+         * @brief       Queues a multishot receive for a receiver.
+         *
+         * @param[in]   receiverIndex the index of the receiver.
+         *
+         * @returns     true if the receive was queued; otherwise false.
+         */
+        auto armReceiver(size_t receiverIndex) -> bool;
+
+        /**
+         * @brief       Queues a read of the wake eventfd.
+         *
+         * @returns     true if the read was queued; otherwise false.
+         */
+        auto armWake() -> bool;
+
+        /**
+         * @brief       Returns a receive buffer to the kernel.
+         *
+         * @param[in]   bufferId the id of the buffer.
+         */
+        auto recycleBuffer(unsigned int bufferId) -> void;
+
+        /**
+         * @brief       Copies a received packet from a provided buffer into a batch.
+         *
+         * @param[in]   receiver the receiver that the packet arrived on.
+         * @param[in]   buffer the provided buffer.
+         * @param[in]   length the number of bytes that the kernel wrote into the buffer.
+         * @param[out]  batch the batch to append the packet to.
+         */
+        auto receivePacket(
+            const Receiver &receiver,
+            const char *buffer,
+            int length,
+            Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch
+        ) -> void;
+
+        /**
+         * @brief       Processes the available completions.
+         *
+         * @param[out]  batch the batch for received packets, if nullptr then received packets are discarded.
+         * @param[out]  expiredKeys the keys of expired timeouts.
+         */
+        auto complete(Nedrysoft::ICMPSocket::ICMPReceiveBatch *batch, std::vector<uint64_t> &expiredKeys) -> void;
+
+        /**
+         * @brief       Returns whether completions are waiting to be processed.
+         *
+         * @returns     true if the completion queue is not empty; otherwise false.
+         */
+        auto hasCompletions() -> bool;
+#endif
+
+    private:
+        Nedrysoft::ICMPSocket::ICMPRing *m_ring;
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+        int m_ringDescriptor = -1;
+
+        void *m_ringMemory = nullptr;
+        size_t m_ringSize = 0;
+
+        struct io_uring_sqe *m_submissions = nullptr;
+        size_t m_submissionsSize = 0;
+
+        unsigned int *m_submissionHead = nullptr;
+        unsigned int *m_submissionTail = nullptr;
+        unsigned int *m_submissionArray = nullptr;
+        unsigned int m_submissionMask = 0;
+        unsigned int m_submissionEntries = 0;
+
+        unsigned int *m_completionHead = nullptr;
+        unsigned int *m_completionTail = nullptr;
+        unsigned int m_completionMask = 0;
+        struct io_uring_cqe *m_completions = nullptr;
+
+        std::vector<struct __kernel_timespec> m_timeouts;
+
+        std::vector<SendSlot> m_sendSlots;
+        std::vector<size_t> m_freeSendSlots;
+
+        std::vector<std::unique_ptr<Receiver>> m_receivers;
+
+        struct io_uring_buf_ring *m_bufferRing = nullptr;
+        size_t m_bufferRingSize = 0;
+        std::vector<char> m_buffers;
+        uint16_t m_bufferTail = 0;
+
+        std::vector<uint64_t> m_deferredExpiredKeys;
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> m_failedSends;
+
+        int m_wakeDescriptor = -1;
+        uint64_t m_wakeCount = 0;
+        bool m_wakeArmed = false;
+#endif
+};
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+auto Nedrysoft::ICMPSocket::ICMPRingData::initialise(int entries) -> bool {
+    struct io_uring_params parameters = {};
+
+    parameters.flags = IORING_SETUP_CLAMP;
+
+    m_ringDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned int>(entries), &parameters));
+
+    if (m_ringDescriptor < 0) {
+        return false;
+    }
+
+    if ((parameters.features & RequiredFeatures) != RequiredFeatures) {
+        return false;
+    }
+
+    // the submission and completion rings share a single mapping.
+
+    m_ringSize = std::max(
+        parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned int),
+        parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe)
+    );
+
+    m_ringMemory = mmap(
+        nullptr,
+        m_ringSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        m_ringDescriptor,
+        IORING_OFF_SQ_RING
+    );
+
+    if (m_ringMemory == MAP_FAILED) {
+        m_ringMemory = nullptr;
+
+        return false;
+    }
+
+    m_submissionsSize = parameters.sq_entries * sizeof(struct io_uring_sqe);
+
+    auto submissions = mmap(
+        nullptr,
+        m_submissionsSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        m_ringDescriptor,
+        IORING_OFF_SQES
+    );
+
+    if (submissions == MAP_FAILED) {
+        return false;
+    }
+
+    m_submissions = static_cast<struct io_uring_sqe *>(submissions);
+
+    auto ringBase = static_cast<char *>(m_ringMemory);
+
+    m_submissionHead = reinterpret_cast<unsigned int *>(ringBase + parameters.sq_off.head);
+    m_submissionTail = reinterpret_cast<unsigned int *>(ringBase + parameters.sq_off.tail);
+    m_submissionArray = reinterpret_cast<unsigned int *>(ringBase + parameters.sq_off.array);
+    m_submissionMask = *reinterpret_cast<unsigned int *>(ringBase + parameters.sq_off.ring_mask);
+    m_submissionEntries = parameters.sq_entries;
+
+    m_completionHead = reinterpret_cast<unsigned int *>(ringBase + parameters.cq_off.head);
+    m_completionTail = reinterpret_cast<unsigned int *>(ringBase + parameters.cq_off.tail);
+    m_completionMask = *reinterpret_cast<unsigned int *>(ringBase + parameters.cq_off.ring_mask);
+    m_completions = reinterpret_cast<struct io_uring_cqe *>(ringBase + parameters.cq_off.cqes);
+
+    m_timeouts.resize(parameters.sq_entries);
+
+    m_sendSlots.resize(static_cast<size_t>(parameters.sq_entries) * SendSlotsPerEntry);
+
+    for (auto slotIndex = m_sendSlots.size(); slotIndex > 0; slotIndex--) {
+        m_freeSendSlots.push_back(slotIndex - 1);
+    }
+
+    // the receive buffers are provided through a ring shared with the kernel, which picks a buffer for each packet.
+
+    m_bufferRingSize = BufferCount * sizeof(struct io_uring_buf);
+
+    auto bufferRing = mmap(nullptr, m_bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (bufferRing == MAP_FAILED) {
+        return false;
+    }
+
+    m_bufferRing = static_cast<struct io_uring_buf_ring *>(bufferRing);
+
+    struct io_uring_buf_reg bufferRegistration = {};
+
+    bufferRegistration.ring_addr = reinterpret_cast<uint64_t>(m_bufferRing);
+    bufferRegistration.ring_entries = BufferCount;
+    bufferRegistration.bgid = BufferGroup;
+
+    if (syscall(__NR_io_uring_register, m_ringDescriptor, IORING_REGISTER_PBUF_RING, &bufferRegistration, 1) < 0) {
+        return false;
+    }
+
+    m_buffers.resize(BufferCount * BufferSize);
+
+    for (auto bufferId = 0u; bufferId < BufferCount; bufferId++) {
+        recycleBuffer(bufferId);
+    }
+
+    if (!probeMultishot()) {
+        return false;
+    }
+
+    // a read of an eventfd is kept queued so that another thread can end a wait by writing to it.
+
+    m_wakeDescriptor = eventfd(0, EFD_CLOEXEC);
+
+    if (m_wakeDescriptor < 0) {
+        return false;
+    }
+
+    return armWake();
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::probeMultishot() -> bool {
+    // multishot receives were added after provided buffer rings, so arm one on a socket pair and check that it
+    // completes with more completions to follow.
+
+    int socketPair[2];
+    std::vector<uint64_t> expiredKeys;
+
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, socketPair) < 0) {
+        return false;
+    }
+
+    auto receiver = std::make_unique<Receiver>();
+
+    memset(receiver.get(), 0, sizeof(Receiver));
+
+    receiver->socketDescriptor = socketPair[0];
+
+    m_receivers.push_back(std::move(receiver));
+
+    auto supported = false;
+
+    if ((armReceiver(0)) && (write(socketPair[1], "", 1) == 1)) {
+        submit(1, ProbeTimeout);
+
+        if (hasCompletions()) {
+            auto completion = &m_completions[*m_completionHead & m_completionMask];
+
+            supported = (completion->res >= 0) && (completion->flags & IORING_CQE_F_MORE);
+        }
+    }
+
+    m_receivers[0]->removed = true;
+
+    complete(nullptr, expiredKeys);
+
+    if ((m_receivers[0]) && (m_receivers[0]->armed)) {
+        auto submission = getSubmission();
+
+        if (submission) {
+            submission->opcode = IORING_OP_ASYNC_CANCEL;
+            submission->fd = -1;
+            submission->addr = userData(ReceiveOperation, 0);
+            submission->user_data = userData(CancelOperation, 0);
+        }
+
+        submit(1, ProbeTimeout);
+
+        complete(nullptr, expiredKeys);
+    }
+
+    close(socketPair[0]);
+    close(socketPair[1]);
+
+    return supported;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::getSubmission() -> struct io_uring_sqe * {
+    auto tail = *m_submissionTail;
+
+    if (tail - __atomic_load_n(m_submissionHead, __ATOMIC_ACQUIRE) >= m_submissionEntries) {
+        submit(0, 0);
+
+        if (tail - __atomic_load_n(m_submissionHead, __ATOMIC_ACQUIRE) >= m_submissionEntries) {
+            return nullptr;
+        }
+    }
+
+    auto index = tail & m_submissionMask;
+    auto submission = &m_submissions[index];
+
+    memset(submission, 0, sizeof(struct io_uring_sqe));
+
+    // the kernel only reads the queue during io_uring_enter, so the entry can be published before it is filled in.
+
+    m_submissionArray[index] = index;
+
+    __atomic_store_n(m_submissionTail, tail + 1, __ATOMIC_RELEASE);
+
+    return submission;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::submit(unsigned int minimumComplete, int timeout) -> void {
+    struct io_uring_getevents_arg eventsArgument = {};
+    struct __kernel_timespec waitTime = {};
+    unsigned int flags = 0;
+    void *argument = nullptr;
+    size_t argumentSize = 0;
+
+    auto pending = *m_submissionTail - __atomic_load_n(m_submissionHead, __ATOMIC_ACQUIRE);
+
+    if (minimumComplete) {
+        waitTime.tv_sec = timeout / 1000;
+        waitTime.tv_nsec = static_cast<long long>(timeout % 1000) * 1000000;
+
+        // a negative timeout waits until an operation completes, which includes the read of the wake eventfd.
+
+        eventsArgument.sigmask_sz = _NSIG / 8;
+        eventsArgument.ts = (timeout >= 0) ? reinterpret_cast<uint64_t>(&waitTime) : 0;
+
+        flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        argument = &eventsArgument;
+        argumentSize = sizeof(eventsArgument);
+    } else if (!pending) {
+        return;
+    }
+
+    // a timeout or a signal simply ends the wait, any entries that were not consumed stay queued for the next call.
+
+    syscall(__NR_io_uring_enter, m_ringDescriptor, pending, minimumComplete, flags, argument, argumentSize);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::armReceiver(size_t receiverIndex) -> bool {
+    auto &receiver = m_receivers[receiverIndex];
+    auto submission = getSubmission();
+
+    if (!submission) {
+        return false;
+    }
+
+    // the kernel lays out each buffer as a header, the source address, the control data and then the packet.
+
+    receiver->header.msg_namelen = sizeof(struct sockaddr_storage);
+    receiver->header.msg_controllen = ControlBufferSize;
+
+    submission->opcode = IORING_OP_RECVMSG;
+    submission->fd = receiver->socketDescriptor;
+    submission->addr = reinterpret_cast<uint64_t>(&receiver->header);
+    submission->len = 1;
+    submission->flags = IOSQE_BUFFER_SELECT;
+    submission->buf_group = BufferGroup;
+    submission->ioprio = IORING_RECV_MULTISHOT;
+    submission->user_data = userData(ReceiveOperation, receiverIndex);
+
+    receiver->armed = true;
+
+    return true;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::armWake() -> bool {
+    auto submission = getSubmission();
+
+    if (!submission) {
+        return false;
+    }
+
+    submission->opcode = IORING_OP_READ;
+    submission->fd = m_wakeDescriptor;
+    submission->addr = reinterpret_cast<uint64_t>(&m_wakeCount);
+    submission->len = sizeof(m_wakeCount);
+    submission->user_data = userData(WakeOperation, 0);
+
+    m_wakeArmed = true;
+
+    return true;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::recycleBuffer(unsigned int bufferId) -> void {
+    // the tail of the buffer ring overlaps the reserved field of the first entry, so only the used fields are set.
+    // the entries are addressed from the start of the ring as the flexible array member is not at offset 0 when
+    // the kernel header is compiled as C++.
+
+    auto buffer = reinterpret_cast<struct io_uring_buf *>(m_bufferRing) + (m_bufferTail & (BufferCount - 1));
+
+    buffer->addr = reinterpret_cast<uint64_t>(&m_buffers[bufferId * BufferSize]);
+    buffer->len = static_cast<uint32_t>(BufferSize);
+    buffer->bid = static_cast<uint16_t>(bufferId);
+
+    m_bufferTail++;
+
+    __atomic_store_n(&m_bufferRing->tail, m_bufferTail, __ATOMIC_RELEASE);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::receivePacket(
+        const Receiver &receiver,
+        const char *buffer,
+        int length,
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch) -> void {
+
+    struct io_uring_recvmsg_out receiveHeader = {};
+    struct msghdr controlHeader = {};
+
+    memcpy(&receiveHeader, buffer, sizeof(receiveHeader));
+
+    auto name = buffer + sizeof(receiveHeader);
+    auto control = name + receiver.header.msg_namelen;
+    auto payload = control + receiver.header.msg_controllen;
+
+    auto payloadLength = std::min(
+        static_cast<int>(receiveHeader.payloadlen),
+        std::min(length - static_cast<int>(payload - buffer), batch.m_datagramSize)
+    );
+
+    if (payloadLength < 0) {
+        return;
+    }
+
+    auto index = batch.m_count;
+
+    memcpy(&batch.m_arena[static_cast<size_t>(index) * static_cast<size_t>(batch.m_datagramSize)],
+           payload,
+           static_cast<size_t>(payloadLength));
+
+    memset(&batch.m_addresses[index], 0, sizeof(struct sockaddr_storage));
+    memcpy(&batch.m_addresses[index], name, std::min(receiveHeader.namelen, receiver.header.msg_namelen));
+
+    batch.m_lengths[index] = payloadLength;
+    batch.m_timestamps[index] = Nedrysoft::ICMPSocket::ICMPSocket::timestamp();
+
+    controlHeader.msg_control = const_cast<char *>(control);
+    controlHeader.msg_controllen = std::min(static_cast<size_t>(receiveHeader.controllen),
+                                            static_cast<size_t>(receiver.header.msg_controllen));
+
+    for (auto controlMessage = CMSG_FIRSTHDR(&controlHeader);
+         controlMessage;
+         controlMessage = CMSG_NXTHDR(&controlHeader, controlMessage)) {
+
+        if ((controlMessage->cmsg_level == SOL_SOCKET) && (controlMessage->cmsg_type == SCM_TIMESTAMPNS)) {
+            struct timespec kernelTimestamp = {};
+
+            memcpy(&kernelTimestamp, CMSG_DATA(controlMessage), sizeof(kernelTimestamp));
+
+            batch.m_timestamps[index] =
+                    static_cast<int64_t>(kernelTimestamp.tv_sec) * 1000000000 + kernelTimestamp.tv_nsec;
+        }
+    }
+
+    batch.m_count++;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::hasCompletions() -> bool {
+    return *m_completionHead != __atomic_load_n(m_completionTail, __ATOMIC_ACQUIRE);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRingData::complete(
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch *batch,
+        std::vector<uint64_t> &expiredKeys) -> void {
+
+    auto head = *m_completionHead;
+    auto tail = __atomic_load_n(m_completionTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        auto completion = &m_completions[head & m_completionMask];
+        auto operation = completion->user_data >> OperationShift;
+        auto value = completion->user_data & ValueMask;
+
+        if ((operation == ReceiveOperation) && (batch) && (batch->m_count == batch->m_capacity)) {
+            // the batch is full, leave the remaining completions for the next call.
+
+            break;
+        }
+
+        if (operation == SendOperation) {
+            auto &sendSlot = m_sendSlots[value];
+            auto length = static_cast<int>(sendSlot.data.size());
+
+            if (completion->res != length) {
+                m_failedSends.push_back(Nedrysoft::ICMPSocket::ICMPMessage {
+                    nullptr,
+                    length,
+                    sendSlot.hostAddress,
+                    sendSlot.ttl,
+                    (completion->res >= 0) ? completion->res : -1
+                });
+            }
+
+            m_freeSendSlots.push_back(value);
+        } else if (operation == TimeoutOperation) {
+            if (completion->res == -ETIME) {
+                expiredKeys.push_back(value);
+            }
+        } else if (operation == ReceiveOperation) {
+            auto &receiver = m_receivers[value];
+
+            if (completion->flags & IORING_CQE_F_BUFFER) {
+                auto bufferId = completion->flags >> IORING_CQE_BUFFER_SHIFT;
+
+                if ((completion->res >= 0) && (batch) && (!receiver->removed)) {
+                    receivePacket(*receiver, &m_buffers[bufferId * BufferSize], completion->res, *batch);
+                }
+
+                recycleBuffer(bufferId);
+            }
+
+            if (!(completion->flags & IORING_CQE_F_MORE)) {
+                receiver->armed = false;
+            }
+        } else if (operation == WakeOperation) {
+            // the read has reset the eventfd, it is queued again below.
+
+            m_wakeArmed = false;
+        }
+
+        head++;
+    }
+
+    __atomic_store_n(m_completionHead, head, __ATOMIC_RELEASE);
+
+    if ((!m_wakeArmed) && (m_wakeDescriptor >= 0)) {
+        armWake();
+    }
+
+    // a multishot receive ends on an error (for a datagram socket this is how an icmp error is signalled) or when
+    // the buffers run out, so drain any queued errors and re-arm it.
+
+    for (size_t receiverIndex = 0; receiverIndex < m_receivers.size(); receiverIndex++) {
+        auto &receiver = m_receivers[receiverIndex];
+
+        if ((!receiver) || (receiver->armed)) {
+            continue;
+        }
+
+        if (receiver->removed) {
+            receiver.reset();
+
+            continue;
+        }
+
+        if ((batch) && (receiver->socket) && (receiver->socket->isDatagram())) {
+            receiver->socket->receiveErrors(*batch);
+        }
+
+        armReceiver(receiverIndex);
+    }
+}
+#endif
+
+Nedrysoft::ICMPSocket::ICMPRing::ICMPRing() :
+        d(std::make_shared<Nedrysoft::ICMPSocket::ICMPRingData>(this)) {
+
+}
+
+Nedrysoft::ICMPSocket::ICMPRing::~ICMPRing() {
+    d.reset();
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::create(int entries) -> Nedrysoft::ICMPSocket::ICMPRing * {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    auto ring = new Nedrysoft::ICMPSocket::ICMPRing;
+
+    if (!ring->d->initialise(entries)) {
+        delete ring;
+
+        return nullptr;
+    }
+
+    return ring;
+#else
+    Q_UNUSED(entries)
+
+    return nullptr;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::queueSend(
+        Nedrysoft::ICMPSocket::ICMPSocket *socket,
+        const Nedrysoft::ICMPSocket::ICMPMessage &message) -> bool {
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    if (d->m_freeSendSlots.empty()) {
+        // every send slot is in flight, sends complete almost immediately so wait for some to be returned.
+
+        d->submit(1, ProbeTimeout);
+        d->complete(nullptr, d->m_deferredExpiredKeys);
+
+        if (d->m_freeSendSlots.empty()) {
+            return false;
+        }
+    }
+
+    auto slotIndex = d->m_freeSendSlots.back();
+    auto &sendSlot = d->m_sendSlots[slotIndex];
+
+    memset(&sendSlot.header, 0, sizeof(sendSlot.header));
+
+    sendSlot.data.assign(message.data, message.data + message.length);
+    sendSlot.hostAddress = message.hostAddress;
+    sendSlot.ttl = message.ttl;
+
+    sendSlot.vector.iov_base = sendSlot.data.data();
+    sendSlot.vector.iov_len = sendSlot.data.size();
+
+    sendSlot.header.msg_name = &sendSlot.address;
+    sendSlot.header.msg_namelen = Nedrysoft::ICMPSocket::ICMPSocket::toSocketAddress(
+        message.hostAddress,
+        sendSlot.address
+    );
+    sendSlot.header.msg_iov = &sendSlot.vector;
+    sendSlot.header.msg_iovlen = 1;
+
+    if (!sendSlot.header.msg_namelen) {
+        return false;
+    }
+
+    if (message.ttl) {
+        // as with sendBatch, the ttl (or hop limit) is attached to the packet rather than set on the socket.
+
+        sendSlot.header.msg_control = sendSlot.control;
+        sendSlot.header.msg_controllen = sizeof(sendSlot.control);
+
+        auto controlMessage = CMSG_FIRSTHDR(&sendSlot.header);
+
+        if (socket->version() == Nedrysoft::ICMPSocket::V4) {
+            controlMessage->cmsg_level = IPPROTO_IP;
+            controlMessage->cmsg_type = IP_TTL;
+        } else {
+            controlMessage->cmsg_level = IPPROTO_IPV6;
+            controlMessage->cmsg_type = IPV6_HOPLIMIT;
+        }
+
+        controlMessage->cmsg_len = CMSG_LEN(sizeof(int));
+
+        memcpy(CMSG_DATA(controlMessage), &sendSlot.ttl, sizeof(int));
+    }
+
+    auto submission = d->getSubmission();
+
+    if (!submission) {
+        return false;
+    }
+
+    d->m_freeSendSlots.pop_back();
+
+    submission->opcode = IORING_OP_SENDMSG;
+    submission->fd = socket->m_socketDescriptor;
+    submission->addr = reinterpret_cast<uint64_t>(&sendSlot.header);
+    submission->len = 1;
+    submission->user_data = userData(SendOperation, slotIndex);
+
+    return true;
+#else
+    Q_UNUSED(socket)
+    Q_UNUSED(message)
+
+    return false;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::queueTimeout(uint64_t key, int timeout) -> bool {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    auto submission = d->getSubmission();
+
+    if (!submission) {
+        return false;
+    }
+
+    // the kernel copies the timespec when the entry is submitted, so it is stored alongside the entry.
+
+    auto &timeoutValue = d->m_timeouts[static_cast<size_t>(submission - d->m_submissions)];
+
+    timeoutValue.tv_sec = timeout / 1000;
+    timeoutValue.tv_nsec = static_cast<long long>(timeout % 1000) * 1000000;
+
+    submission->opcode = IORING_OP_TIMEOUT;
+    submission->fd = -1;
+    submission->addr = reinterpret_cast<uint64_t>(&timeoutValue);
+    submission->len = 1;
+    submission->user_data = userData(TimeoutOperation, key);
+
+    return true;
+#else
+    Q_UNUSED(key)
+    Q_UNUSED(timeout)
+
+    return false;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::addReceiver(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> bool {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    auto receiverIndex = d->m_receivers.size();
+
+    for (size_t index = 0; index < d->m_receivers.size(); index++) {
+        if (!d->m_receivers[index]) {
+            receiverIndex = index;
+
+            break;
+        }
+    }
+
+    if (receiverIndex == d->m_receivers.size()) {
+        d->m_receivers.emplace_back();
+    }
+
+    auto &receiver = d->m_receivers[receiverIndex];
+
+    receiver = std::make_unique<ICMPRingData::Receiver>();
+
+    memset(receiver.get(), 0, sizeof(ICMPRingData::Receiver));
+
+    receiver->socket = socket;
+    receiver->socketDescriptor = socket->m_socketDescriptor;
+
+    if (!d->armReceiver(receiverIndex)) {
+        receiver.reset();
+
+        return false;
+    }
+
+    return true;
+#else
+    Q_UNUSED(socket)
+
+    return false;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::removeReceiver(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> void {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    for (size_t receiverIndex = 0; receiverIndex < d->m_receivers.size(); receiverIndex++) {
+        auto &receiver = d->m_receivers[receiverIndex];
+
+        if ((!receiver) || (receiver->removed) || (receiver->socket != socket)) {
+            continue;
+        }
+
+        // the receiver is kept until the kernel reports that the multishot receive has ended.
+
+        receiver->removed = true;
+        receiver->socket = nullptr;
+
+        if (!receiver->armed) {
+            receiver.reset();
+
+            continue;
+        }
+
+        auto submission = d->getSubmission();
+
+        if (submission) {
+            submission->opcode = IORING_OP_ASYNC_CANCEL;
+            submission->fd = -1;
+            submission->addr = userData(ReceiveOperation, receiverIndex);
+            submission->user_data = userData(CancelOperation, receiverIndex);
+        }
+    }
+#else
+    Q_UNUSED(socket)
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::wait(
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch,
+        std::vector<uint64_t> &expiredKeys,
+        int timeout) -> int {
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    batch.clear();
+
+    expiredKeys.swap(d->m_deferredExpiredKeys);
+
+    d->m_deferredExpiredKeys.clear();
+
+    if (d->hasCompletions()) {
+        d->submit(0, 0);
+    } else {
+        d->submit(1, timeout);
+    }
+
+    d->complete(&batch, expiredKeys);
+
+    // re-armed receives are submitted straight away rather than waiting for the next call.
+
+    d->submit(0, 0);
+
+    return batch.count();
+#else
+    Q_UNUSED(batch)
+    Q_UNUSED(expiredKeys)
+    Q_UNUSED(timeout)
+
+    return -1;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::wait(std::vector<uint64_t> &expiredKeys, int timeout) -> int {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    expiredKeys.swap(d->m_deferredExpiredKeys);
+
+    d->m_deferredExpiredKeys.clear();
+
+    if (d->hasCompletions()) {
+        d->submit(0, 0);
+    } else {
+        d->submit(1, timeout);
+    }
+
+    d->complete(nullptr, expiredKeys);
+
+    return 0;
+#else
+    Q_UNUSED(expiredKeys)
+    Q_UNUSED(timeout)
+
+    return -1;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::takeFailedSends(
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> &failedSends) -> void {
+
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    failedSends.insert(failedSends.end(), d->m_failedSends.begin(), d->m_failedSends.end());
+
+    d->m_failedSends.clear();
+#else
+    Q_UNUSED(failedSends)
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPRing::wake() -> void {
+#if defined(NEDRYSOFT_ICMPSOCKET_IO_URING)
+    uint64_t wakeCount = 1;
+
+    if (write(d->m_wakeDescriptor, &wakeCount, sizeof(wakeCount)) < 0) {
+        // the counter is already non-zero, so the wait has been woken anyway.
+    }
+#endif
+}
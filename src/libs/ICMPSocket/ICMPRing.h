@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NEDRYSOFT_ICMPSOCKET_ICMPRING_H
+#define NEDRYSOFT_ICMPSOCKET_ICMPRING_H
+
+#include "ICMPSocket.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Nedrysoft { namespace ICMPSocket {
+    class ICMPReceiveBatch;
+    class ICMPRingData;
+
+    /**
+     * @brief       The ICMPRing class drives ICMP sockets through a Linux io_uring instance.
+     *
+     * @details     Sends are queued as submission entries and handed to the kernel together, receives are armed once
+     *              per socket as multishot requests that complete into a ring of kernel selected buffers, and reply
+     *              expiry is tracked with kernel timeouts.  A single call to wait submits all of the queued work and
+     *              collects replies and expired probes, so one thread can drive a large number of probes with very
+     *              few system calls.
+     *
+     *              The ring is only available when the library is built with NEDRYSOFT_ICMPSOCKET_IO_URING and the
+     *              running kernel supports the features used, otherwise create returns nullptr and callers should
+     *              continue to use the ICMPSocket batch functions.
+     *
+     * @note        A ring is not thread safe, it must only be used by one thread at a time.  The exception is wake,
+     *              which may be called from any thread.
+     */
+    class NEDRYSOFT_ICMPSOCKET_DLLSPEC ICMPRing {
+        private:
+            /**
+             * @brief       Constructs a new ICMPRing.
+             *
+             * @note        Hidden, instances are created by calling create().
+             */
+            ICMPRing();
+
+        public:
+            /**
+             * @brief       Destroys the ICMPRing.
+             */
+            ~ICMPRing();
+
+            /**
+             * @brief       Creates a ring.
+             *
+             * @param[in]   entries the number of submission queue entries.
+             *
+             * @returns     the ring; otherwise nullptr if io_uring is unavailable.
+             */
+            static auto create(int entries = 256) -> ICMPRing *;
+
+            /**
+             * @brief       Queues a packet to be sent.
+             *
+             * @details     The packet data, address and ttl are copied into storage owned by the ring, so the message
+             *              may be reused as soon as this function returns.  The send completes during a later call to
+             *              wait, a send that fails is then returned by takeFailedSends.  If the submission queue is
+             *              full the queued entries are submitted first.
+             *
+             * @param[in]   socket the socket to send the packet from.
+             * @param[in]   message the packet to send, the result field is not used.
+             *
+             * @returns     true if the packet was queued; otherwise false.
+             */
+            auto queueSend(
+                Nedrysoft::ICMPSocket::ICMPSocket *socket,
+                const Nedrysoft::ICMPSocket::ICMPMessage &message
+            ) -> bool;
+
+            /**
+             * @brief       Queues a timeout that expires after the given time.
+             *
+             * @param[in]   key the value returned by wait when the timeout expires.
+             * @param[in]   timeout the timeout in milliseconds.
+             *
+             * @returns     true if the timeout was queued; otherwise false.
+             */
+            auto queueTimeout(uint64_t key, int timeout) -> bool;
+
+            /**
+             * @brief       Starts receiving packets from a socket.
+             *
+             * @details     The socket must remain valid until removeReceiver is called.  Packets are returned by
+             *              wait, for datagram sockets the error queue is also drained.
+             *
+             * @param[in]   socket the socket to receive from.
+             *
+             * @returns     true if the receive was armed; otherwise false.
+             */
+            auto addReceiver(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> bool;
+
+            /**
+             * @brief       Stops receiving packets from a socket.
+             *
+             * @param[in]   socket the socket that was passed to addReceiver.
+             */
+            auto removeReceiver(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> void;
+
+            /**
+             * @brief       Submits any queued work and waits for completions.
+             *
+             * @details     Waits until at least one operation has completed or the timeout elapses, then collects
+             *              every available completion.  Received packets are placed in the batch, failed sends are
+             *              recorded for takeFailedSends and the keys of expired timeouts are returned.
+             *
+             * @param[out]  batch the batch that receives the packets.
+             * @param[out]  expiredKeys the keys of the timeouts that expired.
+             * @param[in]   timeout the maximum time to wait in milliseconds, or -1 to wait until an operation
+             *              completes or the ring is woken.
+             *
+             * @returns     the number of packets in the batch; otherwise -1 on error.
+             */
+            auto wait(
+                Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch,
+                std::vector<uint64_t> &expiredKeys,
+                int timeout
+            ) -> int;
+
+            /**
+             * @brief       Submits any queued work and waits for send and timeout completions.
+             *
+             * @note        Only for rings that have no receivers.
+             *
+             * @param[out]  expiredKeys the keys of the timeouts that expired.
+             * @param[in]   timeout the maximum time to wait in milliseconds.
+             *
+             * @returns     0 on success; otherwise -1 on error.
+             */
+            auto wait(std::vector<uint64_t> &expiredKeys, int timeout) -> int;
+
+            /**
+             * @brief       Returns the sends that have failed since the last call.
+             *
+             * @details     Each message holds the length, address and ttl of the packet and the error result of the
+             *              send, the data field is nullptr as the packet storage has already been reused.
+             *
+             * @param[out]  failedSends the list that the failed sends are appended to.
+             */
+            auto takeFailedSends(std::vector<Nedrysoft::ICMPSocket::ICMPMessage> &failedSends) -> void;
+
+            /**
+             * @brief       Ends the current (or next) wait early.
+             *
+             * @details     The ring keeps a read of an eventfd queued, writing to the eventfd completes the read and
+             *              so ends the wait, which lets the waiting thread block until there is work rather than
+             *              polling.
+             *
+             * @note        May be called from any thread.
+             */
+            auto wake() -> void;
+
+        private:
+            //! @cond
+
+            std::shared_ptr<ICMPRingData> d;
+
+            //! @endcond
+    };
+}}
+
+#endif // NEDRYSOFT_ICMPSOCKET_ICMPRING_H
@@ -23,8 +23,16 @@
 
 #include "ICMPSocket.h"
 
+#include "ICMPReceiveBatch.h"
+
 #if defined(Q_OS_UNIX)
+#include <cerrno>
 #include <fcntl.h>
+#if defined(Q_OS_LINUX)
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <ctime>
+#endif
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/socket.h>
@@ -35,7 +43,9 @@
 #include <WinSock2.h>
 #endif
 
+#include <QFile>
 #include <QtEndian>
+#include <chrono>
 
 #if defined(Q_OS_WIN)
 constexpr int SocketError = SOCKET_ERROR;
@@ -45,10 +55,32 @@ constexpr int SocketError = -1;
 
 constexpr auto ReceiveBufferSize = 4096;
 
+#if defined(Q_OS_LINUX)
+constexpr auto MaximumFilterIdentifiers = 200u;
+constexpr auto FilterProgramLength = 13;
+constexpr auto ICMPv4EchoReply = 0;
+constexpr auto ICMPv4Unreachable = 3;
+constexpr auto ICMPv4TimeExceeded = 11;
+constexpr auto ICMPv6Unreachable = 1;
+constexpr auto ICMPv6TimeExceeded = 3;
+constexpr auto ICMPv6EchoReply = 129;
+constexpr auto IPv4QuotedHeader = 0x45;
+constexpr auto IPv4HeaderLength = 20;
+constexpr auto IPv4ProtocolOffset = 9;
+constexpr auto IPv6HeaderLength = 40;
+constexpr auto IPv6NextHeaderOffset = 6;
+constexpr auto IPv6Version = 0x60;
+constexpr auto ICMPHeaderLength = 8;
+constexpr auto PingGroupRangeFile = "/proc/sys/net/ipv4/ping_group_range";
+#endif
+
 Nedrysoft::ICMPSocket::ICMPSocket::ICMPSocket(Nedrysoft::ICMPSocket::ICMPSocket::socket_t socket, IPVersion version) :
         m_socketDescriptor(socket),
         m_version(version),
-        m_ttl(64) {
+        m_ttl(64),
+        m_defaultTtl(64),
+        m_ttlControlMessages(true),
+        m_datagram(false) {
 
 }
 
@@ -150,6 +182,16 @@ auto Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(
     }
 #endif
 
+#if defined(Q_OS_LINUX)
+    // ask the kernel to stamp each packet as it arrives, the timestamp is returned as ancillary data by recvBatch.
+
+    int enableTimestamps = 1;
+
+    if (setsockopt(socketDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, &enableTimestamps, sizeof(enableTimestamps)) < 0) {
+        qWarning() << QObject::tr("Unable to enable receive timestamps on socket.");
+    }
+#endif
+
     return new Nedrysoft::ICMPSocket::ICMPSocket(socketDescriptor, version);
 }
 
@@ -222,7 +264,26 @@ auto Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(
             } else  {
                 socketInstance->setHopLimit(ttl);
             }
+        } else {
+            int socketTtl = 0;
+            socklen_t socketTtlLength = sizeof(socketTtl);
+
+            auto result = getsockopt(
+                socketDescriptor,
+                (version == V4) ? IPPROTO_IP : IPPROTO_IPV6,
+                (version == V4) ? IP_TTL : IPV6_UNICAST_HOPS,
+                reinterpret_cast<char *>(&socketTtl),
+                &socketTtlLength
+            );
+
+            if ((result != SocketError) && (socketTtl > 0)) {
+                socketInstance->m_ttl = socketTtl;
+            }
         }
+
+        // packets that do not set their own ttl are sent with the one that the socket was created with.
+
+        socketInstance->m_defaultTtl = socketInstance->m_ttl;
     } else {
         qWarning() << QObject::tr("Error creating socket descriptor.");
     }
@@ -230,6 +291,186 @@ auto Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(
     return socketInstance;
 }
 
+auto Nedrysoft::ICMPSocket::ICMPSocket::createDatagramSocket(
+        Nedrysoft::ICMPSocket::IPVersion version ) -> Nedrysoft::ICMPSocket::ICMPSocket * {
+
+#if defined(Q_OS_LINUX)
+    Nedrysoft::ICMPSocket::ICMPSocket::socket_t socketDescriptor;
+    struct sockaddr_storage localAddress = {};
+    socklen_t localAddressLength;
+    int enableOption = 1;
+    int result;
+
+    initialiseSockets();
+
+    if (version==Nedrysoft::ICMPSocket::V4) {
+        socketDescriptor = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_ICMP);
+    } else if (version==Nedrysoft::ICMPSocket::V6) {
+        socketDescriptor = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_ICMPV6);
+    } else {
+        qWarning() << QObject::tr("Unknown IP version");
+
+        return nullptr;
+    }
+
+    if (!isValid(socketDescriptor)) {
+        qWarning() << QObject::tr("Error creating datagram socket descriptor.");
+
+        return nullptr;
+    }
+
+    // without an error queue the kernel drops time exceeded and unreachable messages for datagram sockets.
+
+    if (version==Nedrysoft::ICMPSocket::V4) {
+        result = setsockopt(socketDescriptor, IPPROTO_IP, IP_RECVERR, &enableOption, sizeof(enableOption));
+    } else {
+        result = setsockopt(socketDescriptor, IPPROTO_IPV6, IPV6_RECVERR, &enableOption, sizeof(enableOption));
+    }
+
+    if (result < 0) {
+        qWarning() << QObject::tr("Unable to enable the error queue on socket.");
+    }
+
+    if (setsockopt(socketDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, &enableOption, sizeof(enableOption)) < 0) {
+        qWarning() << QObject::tr("Unable to enable receive timestamps on socket.");
+    }
+
+    // binding to identifier 0 makes the kernel allocate a free identifier now rather than on the first send.
+
+    if (version==Nedrysoft::ICMPSocket::V4) {
+        localAddress.ss_family = AF_INET;
+        localAddressLength = sizeof(struct sockaddr_in);
+    } else {
+        localAddress.ss_family = AF_INET6;
+        localAddressLength = sizeof(struct sockaddr_in6);
+    }
+
+    if (bind(socketDescriptor, reinterpret_cast<struct sockaddr *>(&localAddress), localAddressLength) < 0) {
+        qWarning() << QObject::tr("Error binding socket.");
+
+        close(socketDescriptor);
+
+        return nullptr;
+    }
+
+    auto socketInstance = new Nedrysoft::ICMPSocket::ICMPSocket(socketDescriptor, version);
+
+    socketInstance->m_datagram = true;
+
+    return socketInstance;
+#else
+    Q_UNUSED(version)
+
+    return nullptr;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable() -> bool {
+#if defined(Q_OS_LINUX)
+    QFile rangeFile(PingGroupRangeFile);
+    unsigned long lowGroup, highGroup;
+
+    if (!rangeFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    auto range = rangeFile.readAll();
+
+    if (sscanf(range.constData(), "%lu %lu", &lowGroup, &highGroup) != 2) {
+        return false;
+    }
+
+    // the default range of "1 0" is empty, which disables datagram sockets entirely.
+
+    if (lowGroup > highGroup) {
+        return false;
+    }
+
+    std::vector<gid_t> groups(1, getegid());
+
+    auto groupCount = getgroups(0, nullptr);
+
+    if (groupCount > 0) {
+        groups.resize(static_cast<size_t>(groupCount) + 1);
+
+        groupCount = getgroups(groupCount, &groups[1]);
+
+        groups.resize(static_cast<size_t>(qMax(groupCount, 0)) + 1);
+    }
+
+    for (auto group : groups) {
+        if ((group >= lowGroup) && (group <= highGroup)) {
+            return true;
+        }
+    }
+
+    return false;
+#else
+    return false;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::waitForReadyRead(
+        const std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> &sockets,
+        std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> &readySockets,
+        int timeout) -> int {
+
+#if defined(Q_OS_WIN)
+    int (WSAAPI *poll)(struct pollfd *, ulong , int ) = WSAPoll;
+#endif
+    std::vector<struct pollfd> descriptorSet(sockets.size());
+
+    readySockets.clear();
+
+    for (size_t index = 0; index < sockets.size(); index++) {
+        descriptorSet[index].fd = sockets[index]->m_socketDescriptor;
+        descriptorSet[index].events = POLLIN;
+    }
+
+    auto numberOfReadyDescriptors = poll(descriptorSet.data(), static_cast<nfds_t>(descriptorSet.size()), timeout);
+
+    if (numberOfReadyDescriptors <= 0) {
+        return numberOfReadyDescriptors;
+    }
+
+    for (size_t index = 0; index < sockets.size(); index++) {
+        if (descriptorSet[index].revents & (POLLIN | POLLERR)) {
+            readySockets.push_back(sockets[index]);
+        }
+    }
+
+    return static_cast<int>(readySockets.size());
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::isDatagram() -> bool {
+    return m_datagram;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::identifier() -> uint16_t {
+    struct sockaddr_storage localAddress = {};
+#if defined(Q_OS_WIN)
+    int localAddressLength = sizeof(localAddress);
+#else
+    socklen_t localAddressLength = sizeof(localAddress);
+#endif
+
+    if (!m_datagram) {
+        return 0;
+    }
+
+    if (getsockname(m_socketDescriptor, reinterpret_cast<struct sockaddr *>(&localAddress), &localAddressLength) < 0) {
+        return 0;
+    }
+
+    // the kernel stores the identifier of a datagram icmp socket as its local port.
+
+    if (localAddress.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<struct sockaddr_in *>(&localAddress)->sin_port);
+    }
+
+    return ntohs(reinterpret_cast<struct sockaddr_in6 *>(&localAddress)->sin6_port);
+}
+
 auto Nedrysoft::ICMPSocket::ICMPSocket::recvfrom(
         QByteArray &buffer,
         QHostAddress &receiveAddress,
@@ -292,30 +533,511 @@ auto Nedrysoft::ICMPSocket::ICMPSocket::recvfrom(
     return -1;
 }
 
+auto Nedrysoft::ICMPSocket::ICMPSocket::recvBatch(Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch, int timeout) -> int {
+#if defined(Q_OS_WIN)
+    int (WSAAPI *poll)(struct pollfd *, ulong , int ) = WSAPoll;
+#endif
+    struct pollfd descriptorSet = {};
+
+    batch.clear();
+
+    descriptorSet.fd = m_socketDescriptor;
+    descriptorSet.events = POLLIN;
+
+    auto numberOfReadyDescriptors = poll(&descriptorSet, 1, timeout);
+
+    if ((numberOfReadyDescriptors <= 0) || (!(descriptorSet.revents & (POLLIN | POLLERR)))) {
+        return -1;
+    }
+
+#if defined(Q_OS_LINUX)
+    if (m_datagram) {
+        // the error queue is drained first, a pending error would otherwise fail the read of the replies.
+
+        receiveErrors(batch);
+    }
+
+    auto firstIndex = batch.m_count;
+
+    for (auto index = firstIndex; index < batch.m_capacity; index++) {
+        batch.m_headers[index].msg_hdr.msg_name = &batch.m_addresses[index];
+        batch.m_headers[index].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        batch.m_headers[index].msg_hdr.msg_controllen = static_cast<size_t>(batch.m_controlSize);
+    }
+
+    int result = 0;
+
+    while (firstIndex < batch.m_capacity) {
+        result = recvmmsg(
+            m_socketDescriptor,
+            &batch.m_headers[firstIndex],
+            static_cast<unsigned int>(batch.m_capacity - firstIndex),
+            MSG_DONTWAIT,
+            nullptr
+        );
+
+        if ((result >= 0) || (errno != EINTR)) {
+            break;
+        }
+    }
+
+    if (result < 0) {
+        result = 0;
+    }
+
+    if (!(batch.m_count + result)) {
+        return -1;
+    }
+
+    // if the kernel did not stamp a packet then fall back to the time that the read completed.
+
+    auto receiveTimestamp = timestamp();
+
+    for (auto index = firstIndex; index < firstIndex + result; index++) {
+        auto messageHeader = &batch.m_headers[index].msg_hdr;
+
+        batch.m_lengths[index] = static_cast<int>(batch.m_headers[index].msg_len);
+        batch.m_timestamps[index] = receiveTimestamp;
+
+        for (auto controlMessage = CMSG_FIRSTHDR(messageHeader);
+             controlMessage;
+             controlMessage = CMSG_NXTHDR(messageHeader, controlMessage)) {
+
+            if ((controlMessage->cmsg_level == SOL_SOCKET) && (controlMessage->cmsg_type == SCM_TIMESTAMPNS)) {
+                struct timespec kernelTimestamp = {};
+
+                memcpy(&kernelTimestamp, CMSG_DATA(controlMessage), sizeof(kernelTimestamp));
+
+                batch.m_timestamps[index] =
+                        static_cast<int64_t>(kernelTimestamp.tv_sec) * 1000000000 + kernelTimestamp.tv_nsec;
+            }
+        }
+    }
+
+    batch.m_count += result;
+#else
+    // the socket is non blocking, so keep reading until there is nothing left or the batch is full.
+
+    while (batch.m_count < batch.m_capacity) {
+#if defined(Q_OS_UNIX)
+        socklen_t addressLength;
+#elif defined(Q_OS_WIN)
+        int addressLength;
+#endif
+        auto index = batch.m_count;
+
+        addressLength = sizeof(struct sockaddr_storage);
+
+        auto result = ::recvfrom(
+            m_socketDescriptor,
+            &batch.m_arena[static_cast<size_t>(index) * static_cast<size_t>(batch.m_datagramSize)],
+            batch.m_datagramSize,
+            0,
+            reinterpret_cast<sockaddr *>(&batch.m_addresses[index]),
+            &addressLength
+        );
+
+        if (result < 0) {
+            break;
+        }
+
+        batch.m_lengths[index] = static_cast<int>(result);
+        batch.m_timestamps[index] = timestamp();
+        batch.m_count++;
+    }
+
+    if (!batch.m_count) {
+        return -1;
+    }
+#endif
+
+    return batch.m_count;
+}
+
+#if defined(Q_OS_LINUX)
+auto Nedrysoft::ICMPSocket::ICMPSocket::receiveErrors(Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch) -> void {
+    auto quotedHeaderLength = (m_version == V4) ? IPv4HeaderLength : IPv6HeaderLength;
+    auto headerLength = ICMPHeaderLength + quotedHeaderLength;
+
+    while (batch.m_count < batch.m_capacity) {
+        auto index = batch.m_count;
+        auto packet = reinterpret_cast<uint8_t *>(
+            &batch.m_arena[static_cast<size_t>(index) * static_cast<size_t>(batch.m_datagramSize)]
+        );
+        struct iovec vector = {};
+        struct msghdr messageHeader = {};
+
+        // the queued request is read in after space for the icmp error header and the quoted ip header.
+
+        vector.iov_base = packet + headerLength;
+        vector.iov_len = static_cast<size_t>(batch.m_datagramSize - headerLength);
+
+        messageHeader.msg_iov = &vector;
+        messageHeader.msg_iovlen = 1;
+        messageHeader.msg_control = batch.m_headers[index].msg_hdr.msg_control;
+        messageHeader.msg_controllen = static_cast<size_t>(batch.m_controlSize);
+
+        auto result = recvmsg(m_socketDescriptor, &messageHeader, MSG_ERRQUEUE | MSG_DONTWAIT);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        struct sock_extended_err *extendedError = nullptr;
+
+        batch.m_timestamps[index] = timestamp();
+
+        for (auto controlMessage = CMSG_FIRSTHDR(&messageHeader);
+             controlMessage;
+             controlMessage = CMSG_NXTHDR(&messageHeader, controlMessage)) {
+
+            if ((controlMessage->cmsg_level == SOL_SOCKET) && (controlMessage->cmsg_type == SCM_TIMESTAMPNS)) {
+                struct timespec kernelTimestamp = {};
+
+                memcpy(&kernelTimestamp, CMSG_DATA(controlMessage), sizeof(kernelTimestamp));
+
+                batch.m_timestamps[index] =
+                        static_cast<int64_t>(kernelTimestamp.tv_sec) * 1000000000 + kernelTimestamp.tv_nsec;
+            } else if (((controlMessage->cmsg_level == IPPROTO_IP) && (controlMessage->cmsg_type == IP_RECVERR)) ||
+                       ((controlMessage->cmsg_level == IPPROTO_IPV6) && (controlMessage->cmsg_type == IPV6_RECVERR))) {
+
+                extendedError = reinterpret_cast<struct sock_extended_err *>(CMSG_DATA(controlMessage));
+            }
+        }
+
+        if ((!extendedError) ||
+            ((extendedError->ee_origin != SO_EE_ORIGIN_ICMP) && (extendedError->ee_origin != SO_EE_ORIGIN_ICMP6))) {
+            continue;
+        }
+
+        // rebuild the icmp error as the router sent it, the header followed by the quoted ip header and request.
+
+        memset(packet, 0, static_cast<size_t>(headerLength));
+
+        packet[0] = extendedError->ee_type;
+        packet[1] = extendedError->ee_code;
+
+        if (m_version == V4) {
+            packet[ICMPHeaderLength] = IPv4QuotedHeader;
+            packet[ICMPHeaderLength + IPv4ProtocolOffset] = IPPROTO_ICMP;
+        } else {
+            packet[ICMPHeaderLength] = IPv6Version;
+            packet[ICMPHeaderLength + IPv6NextHeaderOffset] = IPPROTO_ICMPV6;
+        }
+
+        if (m_version == V4) {
+            memcpy(&batch.m_addresses[index], SO_EE_OFFENDER(extendedError), sizeof(struct sockaddr_in));
+        } else {
+            memcpy(&batch.m_addresses[index], SO_EE_OFFENDER(extendedError), sizeof(struct sockaddr_in6));
+        }
+
+        batch.m_lengths[index] = headerLength + static_cast<int>(result);
+        batch.m_count++;
+    }
+}
+#endif
+
 auto Nedrysoft::ICMPSocket::ICMPSocket::sendto(QByteArray &buffer, const QHostAddress &hostAddress) -> int {
-    if (m_version == V4) {
-        struct sockaddr_in toAddress = {};
+    struct sockaddr_storage toAddress = {};
+
+    auto addressLength = toSocketAddress(hostAddress, toAddress);
+
+    if (!addressLength) {
+        return -1;
+    }
+
+    return ::sendto(m_socketDescriptor, buffer.data(), buffer.length(), 0,
+                    reinterpret_cast<struct sockaddr *>(&toAddress), addressLength);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::sendBatch(std::vector<Nedrysoft::ICMPSocket::ICMPMessage> &messages) -> int {
+    return sendBatch(messages.data(), static_cast<int>(messages.size()));
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::sendBatch(
+        Nedrysoft::ICMPSocket::ICMPMessage *messages,
+        int messageCount) -> int {
+
+    auto sentCount = 0;
+    auto messageIndex = 0;
+
+#if defined(Q_OS_LINUX)
+    if (m_ttlControlMessages) {
+        // the header, vector, address and control arrays are kept between calls so that a steady state round does
+        // not allocate.
+
+        auto controlSize = static_cast<size_t>(CMSG_SPACE(sizeof(int)));
+
+        if (static_cast<int>(m_sendHeaders.size()) < messageCount) {
+            m_sendHeaders.resize(messageCount);
+            m_sendVectors.resize(messageCount);
+            m_sendAddresses.resize(messageCount);
+            m_sendControl.resize(static_cast<size_t>(messageCount) * controlSize);
+        }
+
+        for (messageIndex = 0; messageIndex < messageCount; messageIndex++) {
+            auto &message = messages[messageIndex];
+            auto &header = m_sendHeaders[messageIndex];
+            auto &vector = m_sendVectors[messageIndex];
+
+            message.result = -1;
+
+            vector.iov_base = const_cast<char *>(message.data);
+            vector.iov_len = static_cast<size_t>(message.length);
+
+            memset(&header, 0, sizeof(header));
+
+            header.msg_hdr.msg_name = &m_sendAddresses[messageIndex];
+            header.msg_hdr.msg_namelen = toSocketAddress(message.hostAddress, m_sendAddresses[messageIndex]);
+            header.msg_hdr.msg_iov = &vector;
+            header.msg_hdr.msg_iovlen = 1;
+
+            if (message.ttl) {
+                // the ttl (or hop limit) is attached to the packet, so a single socket can serve every hop.
+
+                header.msg_hdr.msg_control = &m_sendControl[static_cast<size_t>(messageIndex) * controlSize];
+                header.msg_hdr.msg_controllen = controlSize;
+
+                auto controlMessage = CMSG_FIRSTHDR(&header.msg_hdr);
+
+                if (m_version == V4) {
+                    controlMessage->cmsg_level = IPPROTO_IP;
+                    controlMessage->cmsg_type = IP_TTL;
+                } else {
+                    controlMessage->cmsg_level = IPPROTO_IPV6;
+                    controlMessage->cmsg_type = IPV6_HOPLIMIT;
+                }
+
+                controlMessage->cmsg_len = CMSG_LEN(sizeof(int));
+
+                memcpy(CMSG_DATA(controlMessage), &message.ttl, sizeof(int));
+            }
+        }
+
+        messageIndex = 0;
+
+        while (messageIndex < messageCount) {
+            auto result = sendmmsg(
+                m_socketDescriptor,
+                &m_sendHeaders[messageIndex],
+                static_cast<unsigned int>(messageCount - messageIndex),
+                0
+            );
+
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                if ((errno == EINVAL) && (messages[messageIndex].ttl)) {
+                    // the kernel does not accept a per packet ttl, send the rest of the batch one packet at a time.
+
+                    qWarning() << QObject::tr("Per packet TTL is not supported, falling back to setting socket TTL.");
+
+                    m_ttlControlMessages = false;
+
+                    break;
+                }
+
+                // sendmmsg only fails outright when the first message in the batch cannot be sent, so skip over
+                // that message and carry on with the remainder of the batch.
+
+                messageIndex++;
+
+                continue;
+            }
+
+            for (auto sentIndex = messageIndex; sentIndex < messageIndex + result; sentIndex++) {
+                messages[sentIndex].result = static_cast<int>(m_sendHeaders[sentIndex].msg_len);
+            }
+
+            sentCount += result;
+            messageIndex += result;
+        }
+
+        if (messageIndex == messageCount) {
+            return sentCount;
+        }
+    }
+#endif
+    // send each packet individually, changing the socket ttl when a packet requires a different one and restoring
+    // the default ttl of the socket for a packet that does not set one.
+
+    for (; messageIndex < messageCount; messageIndex++) {
+        auto &message = messages[messageIndex];
+        struct sockaddr_storage toAddress = {};
+
+        message.result = -1;
+
+        auto addressLength = toSocketAddress(message.hostAddress, toAddress);
+
+        if (!addressLength) {
+            continue;
+        }
+
+        auto messageTtl = (message.ttl) ? message.ttl : m_defaultTtl;
+
+        if (messageTtl != m_ttl) {
+            if (m_version == V4) {
+                setTTL(messageTtl);
+            } else {
+                setHopLimit(messageTtl);
+            }
+        }
+
+        message.result = ::sendto(m_socketDescriptor, message.data, message.length, 0,
+                                  reinterpret_cast<struct sockaddr *>(&toAddress), addressLength);
+
+        if (message.result >= 0) {
+            sentCount++;
+        }
+    }
+
+    return sentCount;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::toSocketAddress(
+        const QHostAddress &hostAddress,
+        sockaddr_storage &socketAddress) -> int {
+
+    memset(&socketAddress, 0, sizeof(socketAddress));
 
-        memset(&toAddress, 0, sizeof(toAddress));
+    if (hostAddress.protocol() == QAbstractSocket::IPv4Protocol) {
+        auto toAddress = reinterpret_cast<struct sockaddr_in *>(&socketAddress);
 
-        toAddress.sin_family = AF_INET;
-        toAddress.sin_addr.s_addr = qToBigEndian<uint32_t>(hostAddress.toIPv4Address());
+        toAddress->sin_family = AF_INET;
+        toAddress->sin_addr.s_addr = qToBigEndian<uint32_t>(hostAddress.toIPv4Address());
 
-        return ::sendto(m_socketDescriptor, buffer.data(), buffer.length(), 0,
-                        reinterpret_cast<struct sockaddr *>(&toAddress), sizeof(toAddress));
-    } else if (m_version == V6) {
-        struct sockaddr_in6 toAddress = {};
+        return sizeof(struct sockaddr_in);
+    } else if (hostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
+        auto toAddress = reinterpret_cast<struct sockaddr_in6 *>(&socketAddress);
 
         auto destinationAddress = hostAddress.toIPv6Address();
 
-        toAddress.sin6_family = AF_INET6;
-        memcpy(toAddress.sin6_addr.s6_addr, &destinationAddress, 16);
+        toAddress->sin6_family = AF_INET6;
+        memcpy(toAddress->sin6_addr.s6_addr, &destinationAddress, 16);
 
-        return ::sendto(m_socketDescriptor, buffer.data(), buffer.length(), 0,
-                        reinterpret_cast<struct sockaddr *>(&toAddress), sizeof(toAddress));
+        return sizeof(struct sockaddr_in6);
     }
 
-    return -1;
+    return 0;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::setIdentifierFilter(const std::vector<uint16_t> &identifiers) -> bool {
+#if defined(Q_OS_LINUX)
+    std::vector<struct sock_filter> program;
+
+    // the jump offsets in a classic BPF program are 8 bits wide, which limits how many identifiers can be matched.
+
+    auto matchIdentifiers = identifiers.size() <= MaximumFilterIdentifiers;
+    auto identifierCount = matchIdentifiers ? static_cast<uint8_t>(identifiers.size()) : static_cast<uint8_t>(0);
+
+    // the number of instructions between the identifier comparisons and the reject instruction.
+
+    auto rejectOffset = matchIdentifiers ? identifierCount : static_cast<uint8_t>(1);
+
+    program.reserve(identifierCount + FilterProgramLength);
+
+    if (m_version == V4) {
+        // raw ipv4 sockets see the ip header, X is loaded with its length so that the icmp message can be indexed.
+        // time exceeded and unreachable messages quote our request, which is sent without ip options, so the
+        // quoted identifier is at a fixed offset into the quoted packet.
+
+        constexpr uint8_t identifierLabel = 10;
+        constexpr uint8_t rejectLabel = identifierLabel;
+
+        program = {
+            /*  0 */ BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0),
+            /*  1 */ BPF_STMT(BPF_LD | BPF_B | BPF_IND, 0),
+            /*  2 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv4EchoReply, 0, 2),
+            /*  3 */ BPF_STMT(BPF_LD | BPF_H | BPF_IND, 4),
+            /*  4 */ BPF_STMT(BPF_JMP | BPF_JA, identifierLabel - 5),
+            /*  5 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv4TimeExceeded, 1, 0),
+            /*  6 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv4Unreachable, 0, static_cast<uint8_t>(rejectLabel - 7 + rejectOffset)),
+            /*  7 */ BPF_STMT(BPF_LD | BPF_B | BPF_IND, 8),
+            /*  8 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPv4QuotedHeader, 0, static_cast<uint8_t>(rejectLabel - 9 + rejectOffset)),
+            /*  9 */ BPF_STMT(BPF_LD | BPF_H | BPF_IND, 32),
+        };
+    } else {
+        // raw ipv6 sockets see only the icmp message.
+
+        constexpr uint8_t identifierLabel = 9;
+        constexpr uint8_t rejectLabel = identifierLabel;
+
+        program = {
+            /*  0 */ BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+            /*  1 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv6EchoReply, 0, 2),
+            /*  2 */ BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 4),
+            /*  3 */ BPF_STMT(BPF_JMP | BPF_JA, identifierLabel - 4),
+            /*  4 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv6TimeExceeded, 1, 0),
+            /*  5 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMPv6Unreachable, 0, static_cast<uint8_t>(rejectLabel - 6 + rejectOffset)),
+            /*  6 */ BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 14),
+            /*  7 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_ICMPV6, 0, static_cast<uint8_t>(rejectLabel - 8 + rejectOffset)),
+            /*  8 */ BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 52),
+        };
+    }
+
+    if (matchIdentifiers) {
+        for (auto identifierIndex = 0; identifierIndex < identifierCount; identifierIndex++) {
+            // on a match jump over the remaining comparisons and the reject instruction to the accept instruction.
+
+            program.push_back(BPF_JUMP(
+                BPF_JMP | BPF_JEQ | BPF_K,
+                identifiers[identifierIndex],
+                static_cast<uint8_t>(identifierCount - identifierIndex),
+                0
+            ));
+        }
+
+        program.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+    } else {
+        // too many identifiers to match, so pass every message of the right type.
+
+        program.push_back(BPF_STMT(BPF_JMP | BPF_JA, 1));
+        program.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+    }
+
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, UINT32_MAX));
+
+    struct sock_fprog filter = {};
+
+    filter.len = static_cast<unsigned short>(program.size());
+    filter.filter = program.data();
+
+    if (setsockopt(m_socketDescriptor, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) < 0) {
+        qWarning() << QObject::tr("Unable to attach packet filter to socket.");
+
+        return false;
+    }
+
+    return true;
+#else
+    Q_UNUSED(identifiers)
+
+    return false;
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::timestamp() -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp() -> int64_t {
+#if defined(Q_OS_LINUX)
+    struct timespec currentTime = {};
+
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+    return (static_cast<int64_t>(currentTime.tv_sec) * 1000000000) + currentTime.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
 }
 
 auto Nedrysoft::ICMPSocket::ICMPSocket::isValid(Nedrysoft::ICMPSocket::ICMPSocket::socket_t socket) -> bool {
@@ -355,6 +1077,8 @@ auto Nedrysoft::ICMPSocket::ICMPSocket::setHopLimit(int hopLimit) -> void {
     auto result = setsockopt(m_socketDescriptor, IPPROTO_IPV6, IPV6_UNICAST_HOPS, reinterpret_cast<char *>(&hopLimit),
                              sizeof(hopLimit));
 
+    m_ttl = hopLimit;
+
     if (result == SocketError) {
         qWarning() << QObject::tr("Error setting Hop Limit.");
     }
@@ -46,6 +46,8 @@
 
 #include <QByteArray>
 #include <QHostAddress>
+#include <cstdint>
+#include <vector>
 
 #if ( defined(NEDRYSOFT_LIBRARY_ICMPSOCKET_EXPORT))
 #define NEDRYSOFT_ICMPSOCKET_DLLSPEC Q_DECL_EXPORT
@@ -54,11 +56,28 @@
 #endif
 
 namespace Nedrysoft { namespace ICMPSocket {
+    class ICMPReceiveBatch;
+
     enum IPVersion {
         V4 = 4,
         V6 = 6
     };
 
+    /**
+     * @brief       The ICMPMessage structure describes a single packet in a batched transmit.
+     *
+     * @details     The caller owns the packet data, it must remain valid until sendBatch returns.  The ttl field
+     *              sets the TTL (or hop limit) of this packet alone, 0 uses the socket default.  On return the
+     *              result field holds the number of bytes written for this packet, or -1 if it could not be sent.
+     */
+    struct ICMPMessage {
+        const char *data;
+        int length;
+        QHostAddress hostAddress;
+        int ttl;
+        int result;
+    };
+
     /**
      * @brief           The ICMPSocket class abstracts the platform specific code for ICMP sockets.
      */
@@ -95,6 +114,30 @@ namespace Nedrysoft { namespace ICMPSocket {
              */
             static auto initialiseSockets() -> void;
 
+            /**
+             * @brief       Converts a host address into a platform socket address.
+             *
+             * @param[in]   hostAddress the address to convert.
+             * @param[out]  socketAddress the socket address to fill in.
+             *
+             * @returns     the length of the socket address; otherwise 0 if the address could not be converted.
+             */
+            static auto toSocketAddress(const QHostAddress &hostAddress, sockaddr_storage &socketAddress) -> int;
+
+#if defined(Q_OS_LINUX)
+            /**
+             * @brief       Drains the error queue of a datagram socket into a receive batch.
+             *
+             * @details     ICMP errors for a datagram socket are not delivered as packets, the kernel queues the
+             *              request that caused the error along with the ICMP type, code and the address of the
+             *              router that sent it.  A time exceeded or destination unreachable message is rebuilt
+             *              from this information so that it can be parsed in the same way as a raw socket packet.
+             *
+             * @param[in]   batch the batch to append the rebuilt messages to.
+             */
+            auto receiveErrors(Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch) -> void;
+#endif
+
         public:
             /**
              * @brief       Destroys the ICMPSocket.
@@ -123,6 +166,65 @@ namespace Nedrysoft { namespace ICMPSocket {
                 Nedrysoft::ICMPSocket::IPVersion version = Nedrysoft::ICMPSocket::V4
              ) -> ICMPSocket *;
 
+            /**
+             * @brief       Creates an unprivileged datagram socket for both sending and receiving ICMP echo packets.
+             *
+             * @details     Linux allows ICMP echo requests to be sent from SOCK_DGRAM sockets without root or
+             *              CAP_NET_RAW if the process belongs to a group in net.ipv4.ping_group_range.  The kernel
+             *              assigns the socket an ICMP identifier, overwrites the identifier of each request with
+             *              it and only delivers replies carrying that identifier, so no filtering is required in
+             *              user space.  Time exceeded and unreachable messages are delivered through the socket
+             *              error queue and are returned by recvBatch as regular ICMP messages.
+             *
+             * @param[in]   version the IP version of the created socket.
+             *
+             * @returns     the socket instance; otherwise nullptr if datagram sockets are unavailable.
+             */
+            static auto createDatagramSocket(
+                Nedrysoft::ICMPSocket::IPVersion version = Nedrysoft::ICMPSocket::V4
+            ) -> ICMPSocket *;
+
+            /**
+             * @brief       Returns whether the process is allowed to create datagram ICMP sockets.
+             *
+             * @details     On Linux this checks the real and supplementary groups of the process against the range
+             *              configured in net.ipv4.ping_group_range, which governs both IPv4 and IPv6.
+             *
+             * @returns     true if datagram sockets are available; otherwise false.
+             */
+            static auto isDatagramAvailable() -> bool;
+
+            /**
+             * @brief       Waits until one or more sockets have data (or errors) to read.
+             *
+             * @param[in]   sockets the sockets to wait on.
+             * @param[out]  readySockets the sockets that are ready to be read.
+             * @param[in]   timeout the timeout in milliseconds.
+             *
+             * @returns     the number of ready sockets; otherwise 0 on timeout or -1 on error.
+             */
+            static auto waitForReadyRead(
+                const std::vector<ICMPSocket *> &sockets,
+                std::vector<ICMPSocket *> &readySockets,
+                int timeout
+            ) -> int;
+
+            /**
+             * @brief       Returns whether this is a datagram socket.
+             *
+             * @returns     true if the socket was created by createDatagramSocket; otherwise false.
+             */
+            auto isDatagram() -> bool;
+
+            /**
+             * @brief       Returns the ICMP identifier that the kernel assigned to a datagram socket.
+             *
+             * @note        Requests sent from a datagram socket always carry this identifier.
+             *
+             * @returns     the identifier; otherwise 0 for raw sockets.
+             */
+            auto identifier() -> uint16_t;
+
             /**
              * @brief       Receives data from a read or write socket.
              *
@@ -144,6 +246,89 @@ namespace Nedrysoft { namespace ICMPSocket {
              */
             auto sendto(QByteArray &buffer, const QHostAddress &hostAddress) -> int;
 
+            /**
+             * @brief       Receives a batch of packets on a read socket.
+             *
+             * @details     Waits until the socket becomes readable (or the timeout expires) and then drains as many
+             *              queued datagrams as will fit into the batch.  On Linux the datagrams are read with a
+             *              single recvmmsg call, on other platforms the socket is read until it would block.
+             *
+             *              Each packet is given a receive timestamp, on Linux this is the time the kernel received
+             *              the packet (SO_TIMESTAMPNS); otherwise it is the time that the packet was read.
+             *
+             * @param[in,out]   batch the batch to receive into, any previous contents are discarded.
+             * @param[in]       timeout the time in milliseconds to wait for the first packet.
+             *
+             * @returns     the number of packets received; or -1 on error or timeout.
+             */
+            auto recvBatch(Nedrysoft::ICMPSocket::ICMPReceiveBatch &batch, int timeout) -> int;
+
+            /**
+             * @brief       Restricts a read socket to the replies for the given ICMP identifiers.
+             *
+             * @details     On Linux a classic BPF program is attached to the socket so that the kernel discards
+             *              every ICMP message other than echo replies, time exceeded and destination unreachable
+             *              messages that carry one of the identifiers, before they are copied to user space.  If
+             *              there are more identifiers than fit in a single program, the filter falls back to
+             *              passing those message types regardless of identifier.  Calling this again replaces the
+             *              existing filter.
+             *
+             * @param[in]   identifiers the ICMP identifiers to accept.
+             *
+             * @returns     true if the filter was attached; otherwise false (including unsupported platforms).
+             */
+            auto setIdentifierFilter(const std::vector<uint16_t> &identifiers) -> bool;
+
+            /**
+             * @brief       Returns the current time as a timestamp.
+             *
+             * @details     Timestamps are nanoseconds since the unix epoch, they use the same clock as the kernel
+             *              receive timestamps attached to packets by recvBatch so that the two can be subtracted
+             *              to give a round trip time.
+             *
+             * @returns     the current timestamp in nanoseconds.
+             */
+            static auto timestamp() -> int64_t;
+
+            /**
+             * @brief       Returns the current time of the monotonic clock.
+             *
+             * @details     Unlike timestamp(), the monotonic clock is not stepped when the wall clock is changed, so
+             *              it is used for deadlines and timeouts.  Its values are not related to the unix epoch and
+             *              cannot be compared with packet timestamps.
+             *
+             * @returns     the current monotonic time in nanoseconds.
+             */
+            static auto monotonicTimestamp() -> int64_t;
+
+            /**
+             * @brief       Sends a batch of packets on a write socket.
+             *
+             * @details     On Linux the whole batch is handed to the kernel with sendmmsg, so a round of pings
+             *              costs a single system call, and each packet carries its own TTL as ancillary data so a
+             *              single socket can serve every hop of a route.  On other platforms (or if the kernel
+             *              rejects per packet TTLs) each packet is sent individually and the socket TTL is changed
+             *              whenever a packet requires a different value, a packet with a ttl of 0 is sent with the
+             *              TTL that the socket was created with.
+             *
+             * @param[in,out]   messages the packets to send, the result field of each message is updated.
+             *
+             * @returns     the number of packets that were sent.
+             */
+            auto sendBatch(std::vector<Nedrysoft::ICMPSocket::ICMPMessage> &messages) -> int;
+
+            /**
+             * @brief       Sends a batch of packets on a write socket.
+             *
+             * @see         Nedrysoft::ICMPSocket::ICMPSocket::sendBatch
+             *
+             * @param[in,out]   messages pointer to the first packet to send.
+             * @param[in]       messageCount the number of packets to send.
+             *
+             * @returns     the number of packets that were sent.
+             */
+            auto sendBatch(Nedrysoft::ICMPSocket::ICMPMessage *messages, int messageCount) -> int;
+
             /**
              * @brief       Sets the TTL on a write socket.
              *
@@ -172,12 +357,25 @@ namespace Nedrysoft { namespace ICMPSocket {
              */
             auto version() -> Nedrysoft::ICMPSocket::IPVersion;
 
+            friend class ICMPRing;
+            friend class ICMPRingData;
+            friend class ICMPSocketSet;
+
         private:
             //! @cond
 
             ICMPSocket::socket_t m_socketDescriptor;
             Nedrysoft::ICMPSocket::IPVersion m_version;
             int m_ttl;
+            int m_defaultTtl;
+#if defined(Q_OS_LINUX)
+            std::vector<struct mmsghdr> m_sendHeaders;
+            std::vector<struct iovec> m_sendVectors;
+            std::vector<struct sockaddr_storage> m_sendAddresses;
+            std::vector<char> m_sendControl;
+#endif
+            bool m_ttlControlMessages;
+            bool m_datagram;
 
             //! @endcond
     };
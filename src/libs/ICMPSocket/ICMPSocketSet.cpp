@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ICMPSocketSet.h"
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+constexpr auto MaximumEvents = 16;
+#endif
+
+/**
+ * @brief       Private class to store the socket set instance data.
+ */
+class Nedrysoft::ICMPSocket::ICMPSocketSetData {
+    public:
+        /**
+         * @brief       Constructs a ICMPSocketSetData.
+         *
+         * @param[in]   parent the ICMPSocketSet instance that this data belongs to.
+         */
+        ICMPSocketSetData(Nedrysoft::ICMPSocket::ICMPSocketSet *parent) :
+                m_socketSet(parent) {
+
+#if defined(Q_OS_LINUX)
+            m_events.resize(MaximumEvents);
+
+            m_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+
+            if (m_epollDescriptor >= 0) {
+                m_wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+                if (m_wakeDescriptor >= 0) {
+                    struct epoll_event event = {};
+
+                    // the wake event is told apart from the sockets by its null pointer.
+
+                    event.events = EPOLLIN;
+                    event.data.ptr = nullptr;
+
+                    if (epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, m_wakeDescriptor, &event) < 0) {
+                        close(m_wakeDescriptor);
+
+                        m_wakeDescriptor = -1;
+                    }
+                }
+            }
+#endif
+        }
+
+        /**
+         * @brief       Destroys the ICMPSocketSetData, closing the epoll instance.
+         */
+        ~ICMPSocketSetData() {
+#if defined(Q_OS_LINUX)
+            if (m_epollDescriptor >= 0) {
+                close(m_epollDescriptor);
+            }
+
+            if (m_wakeDescriptor >= 0) {
+                close(m_wakeDescriptor);
+            }
+#endif
+        }
+
+        friend class ICMPSocketSet;
+
+    private:
+        Nedrysoft::ICMPSocket::ICMPSocketSet *m_socketSet;
+
+        std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> m_sockets;
+
+#if defined(Q_OS_LINUX)
+        int m_epollDescriptor = -1;
+        int m_wakeDescriptor = -1;
+
+        std::vector<struct epoll_event> m_events;
+#endif
+};
+
+Nedrysoft::ICMPSocket::ICMPSocketSet::ICMPSocketSet() :
+        d(std::make_shared<Nedrysoft::ICMPSocket::ICMPSocketSetData>(this)) {
+
+}
+
+Nedrysoft::ICMPSocket::ICMPSocketSet::~ICMPSocketSet() {
+    d.reset();
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocketSet::add(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> bool {
+    if ((!socket) || (std::find(d->m_sockets.begin(), d->m_sockets.end(), socket) != d->m_sockets.end())) {
+        return false;
+    }
+
+#if defined(Q_OS_LINUX)
+    if (d->m_epollDescriptor >= 0) {
+        struct epoll_event event = {};
+
+        // errors are reported as readable, datagram sockets deliver time exceeded messages through the error queue.
+
+        event.events = EPOLLIN | EPOLLERR;
+        event.data.ptr = socket;
+
+        if (epoll_ctl(d->m_epollDescriptor, EPOLL_CTL_ADD, socket->m_socketDescriptor, &event) < 0) {
+            return false;
+        }
+    }
+#endif
+
+    d->m_sockets.push_back(socket);
+
+    return true;
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocketSet::remove(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> void {
+    auto it = std::find(d->m_sockets.begin(), d->m_sockets.end(), socket);
+
+    if (it == d->m_sockets.end()) {
+        return;
+    }
+
+#if defined(Q_OS_LINUX)
+    if (d->m_epollDescriptor >= 0) {
+        epoll_ctl(d->m_epollDescriptor, EPOLL_CTL_DEL, socket->m_socketDescriptor, nullptr);
+    }
+#endif
+
+    d->m_sockets.erase(it);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocketSet::wait(
+        std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> &readySockets,
+        int timeout) -> int {
+
+#if defined(Q_OS_LINUX)
+    if (d->m_epollDescriptor >= 0) {
+        readySockets.clear();
+
+        auto numberOfEvents = epoll_wait(
+            d->m_epollDescriptor,
+            d->m_events.data(),
+            static_cast<int>(d->m_events.size()),
+            timeout
+        );
+
+        if (numberOfEvents < 0) {
+            return (errno == EINTR) ? 0 : -1;
+        }
+
+        for (auto eventIndex = 0; eventIndex < numberOfEvents; eventIndex++) {
+            auto socket = static_cast<Nedrysoft::ICMPSocket::ICMPSocket *>(d->m_events[eventIndex].data.ptr);
+
+            if (!socket) {
+                uint64_t wakeCount;
+
+                // reading the eventfd resets it, so the next wait blocks until the set is woken again.
+
+                if (read(d->m_wakeDescriptor, &wakeCount, sizeof(wakeCount)) < 0) {
+                    // another wait has already reset the counter.
+                }
+
+                continue;
+            }
+
+            readySockets.push_back(socket);
+        }
+
+        return static_cast<int>(readySockets.size());
+    }
+#endif
+
+    return Nedrysoft::ICMPSocket::ICMPSocket::waitForReadyRead(d->m_sockets, readySockets, timeout);
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocketSet::wake() -> void {
+#if defined(Q_OS_LINUX)
+    if (d->m_wakeDescriptor >= 0) {
+        uint64_t wakeCount = 1;
+
+        if (write(d->m_wakeDescriptor, &wakeCount, sizeof(wakeCount)) < 0) {
+            // the counter is already non-zero, so the wait has been woken anyway.
+        }
+    }
+#endif
+}
+
+auto Nedrysoft::ICMPSocket::ICMPSocketSet::isWakeable() -> bool {
+#if defined(Q_OS_LINUX)
+    return d->m_wakeDescriptor >= 0;
+#else
+    return false;
+#endif
+}
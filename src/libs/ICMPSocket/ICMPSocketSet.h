@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NEDRYSOFT_ICMPSOCKET_ICMPSOCKETSET_H
+#define NEDRYSOFT_ICMPSOCKET_ICMPSOCKETSET_H
+
+#include "ICMPSocket.h"
+
+#include <memory>
+#include <vector>
+
+namespace Nedrysoft { namespace ICMPSocket {
+    class ICMPSocketSetData;
+
+    /**
+     * @brief       The ICMPSocketSet class waits for any of a set of ICMP sockets to become readable.
+     *
+     * @details     On Linux the sockets are registered once with an epoll instance, so a wait costs the same
+     *              regardless of how many sockets are in the set and sockets of both address families can be
+     *              waited on from a single thread.  On other platforms (or if epoll cannot be created) the set
+     *              falls back to polling the sockets with ICMPSocket::waitForReadyRead.
+     *
+     *              On Linux an eventfd is registered alongside the sockets, so another thread can end a wait early by
+     *              calling wake, which lets the waiting thread block until there is work rather than polling.
+     *
+     * @note        A set is not thread safe, it must only be used by one thread at a time.  The exception is wake,
+     *              which may be called from any thread.
+     */
+    class NEDRYSOFT_ICMPSOCKET_DLLSPEC ICMPSocketSet {
+        public:
+            /**
+             * @brief       Constructs a new empty ICMPSocketSet.
+             */
+            ICMPSocketSet();
+
+            /**
+             * @brief       Destroys the ICMPSocketSet.
+             *
+             * @note        The sockets in the set are not closed.
+             */
+            ~ICMPSocketSet();
+
+            /**
+             * @brief       Adds a socket to the set.
+             *
+             * @note        The socket must remain valid until it has been removed from the set.
+             *
+             * @param[in]   socket the socket to add.
+             *
+             * @returns     true if the socket was added; otherwise false.
+             */
+            auto add(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> bool;
+
+            /**
+             * @brief       Removes a socket from the set.
+             *
+             * @param[in]   socket the socket that was passed to add.
+             */
+            auto remove(Nedrysoft::ICMPSocket::ICMPSocket *socket) -> void;
+
+            /**
+             * @brief       Waits until one or more sockets in the set have data (or errors) to read.
+             *
+             * @param[out]  readySockets the sockets that are ready to be read.
+             * @param[in]   timeout the timeout in milliseconds, or -1 to wait until a socket is ready or the set
+             *              is woken.
+             *
+             * @returns     the number of ready sockets; otherwise 0 on timeout (or wake) or -1 on error.
+             */
+            auto wait(std::vector<Nedrysoft::ICMPSocket::ICMPSocket *> &readySockets, int timeout) -> int;
+
+            /**
+             * @brief       Ends the current (or next) wait early.
+             *
+             * @note        May be called from any thread, does nothing if the set cannot be woken.
+             */
+            auto wake() -> void;
+
+            /**
+             * @brief       Returns whether a wait can be ended early by calling wake.
+             *
+             * @details     If the set cannot be woken, callers should wait with a bounded timeout so that changes
+             *              made by other threads are noticed.
+             *
+             * @returns     true if the set can be woken; otherwise false.
+             */
+            auto isWakeable() -> bool;
+
+        private:
+            //! @cond
+
+            std::shared_ptr<ICMPSocketSetData> d;
+
+            //! @endcond
+    };
+}}
+
+#endif // NEDRYSOFT_ICMPSOCKET_ICMPSOCKETSET_H
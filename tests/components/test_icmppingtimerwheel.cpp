@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "ICMPPingEngine/ICMPPingTimerWheel.h"
+#include "ICMPSocket/ICMPSocket.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+constexpr auto NsPerMs = static_cast<int64_t>(1000000);
+constexpr auto WheelLength = 4096 * NsPerMs;
+
+TEST_CASE("ICMPPingTimerWheel Tests", "[app][components]") {
+    // the wheel never dereferences the engines, so distinct addresses are enough to tell them apart.
+
+    int firstTag, secondTag;
+
+    auto firstEngine = reinterpret_cast<Nedrysoft::ICMPPingEngine::ICMPPingEngine *>(&firstTag);
+    auto secondEngine = reinterpret_cast<Nedrysoft::ICMPPingEngine::ICMPPingEngine *>(&secondTag);
+
+    std::vector<std::pair<Nedrysoft::ICMPPingEngine::ICMPPingEngine *, uint32_t>> expired;
+
+    Nedrysoft::ICMPPingEngine::ICMPPingTimerWheel timerWheel(
+            [&expired](Nedrysoft::ICMPPingEngine::ICMPPingEngine *engine, uint32_t id) {
+        expired.emplace_back(engine, id);
+    });
+
+    auto baseTime = Nedrysoft::ICMPSocket::ICMPSocket::monotonicTimestamp();
+
+    SECTION("check expiry across wheel wraparound") {
+        // the second and third deadlines are one and two revolutions after the first, so all three share a slot.
+
+        REQUIRE(timerWheel.schedule(firstEngine, 1, baseTime + 10 * NsPerMs));
+        REQUIRE_FALSE(timerWheel.schedule(firstEngine, 2, baseTime + 10 * NsPerMs + WheelLength));
+        REQUIRE_FALSE(timerWheel.schedule(firstEngine, 3, baseTime + 10 * NsPerMs + 2 * WheelLength));
+
+        REQUIRE(timerWheel.waitTime(baseTime, -1) <= 11);
+
+        timerWheel.advance(baseTime + 5 * NsPerMs);
+
+        REQUIRE(expired.empty());
+
+        timerWheel.advance(baseTime + 12 * NsPerMs);
+
+        REQUIRE(expired.size()==1);
+        REQUIRE(expired[0].second==1);
+
+        // the remaining entries are found when their revolution comes round, not on the next pass over the slot.
+
+        auto waitTime = timerWheel.waitTime(baseTime + 12 * NsPerMs, -1);
+
+        REQUIRE(waitTime > 4000);
+        REQUIRE(waitTime <= 4096);
+
+        timerWheel.advance(baseTime + 20 * NsPerMs);
+
+        REQUIRE(expired.size()==1);
+
+        timerWheel.advance(baseTime + 12 * NsPerMs + WheelLength);
+
+        REQUIRE(expired.size()==2);
+        REQUIRE(expired[1].second==2);
+
+        // a jump of more than a revolution visits each slot once and still finds the last entry.
+
+        timerWheel.advance(baseTime + 12 * NsPerMs + 3 * WheelLength);
+
+        REQUIRE(expired.size()==3);
+        REQUIRE(expired[2].second==3);
+
+        REQUIRE(timerWheel.waitTime(baseTime + 12 * NsPerMs + 3 * WheelLength, -1)==-1);
+    }
+
+    SECTION("check cancel before expiry") {
+        timerWheel.schedule(firstEngine, 1, baseTime + 10 * NsPerMs);
+        timerWheel.schedule(secondEngine, 2, baseTime + 10 * NsPerMs);
+        timerWheel.schedule(firstEngine, 3, baseTime + 20 * NsPerMs + WheelLength);
+
+        timerWheel.cancel(firstEngine);
+
+        timerWheel.advance(baseTime + 30 * NsPerMs + 2 * WheelLength);
+
+        REQUIRE(expired.size()==1);
+        REQUIRE(expired[0].first==secondEngine);
+        REQUIRE(expired[0].second==2);
+
+        timerWheel.cancel(secondEngine);
+
+        REQUIRE(timerWheel.waitTime(baseTime, 100)==100);
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "RouteAnalyser/PingEngineStatisticsRecorder.h"
+
+TEST_CASE("PingEngineStatisticsRecorder Tests", "[app][components]") {
+    Nedrysoft::RouteAnalyser::PingEngineStatisticsRecorder recorder;
+
+    SECTION("check counter snapshots") {
+        auto statistics = recorder.statistics();
+
+        REQUIRE(statistics.sent==0);
+        REQUIRE(statistics.inFlight==0);
+        REQUIRE(statistics.averageTransmitLag==0);
+
+        for (auto sampleIndex = 0; sampleIndex < 4; sampleIndex++) {
+            recorder.recordSent();
+        }
+
+        recorder.recordReply(0.0005);
+        recorder.recordReply(10.0);
+        recorder.recordTimeout();
+        recorder.recordLate();
+        recorder.recordDuplicate();
+        recorder.recordDuplicate();
+
+        statistics = recorder.statistics();
+
+        REQUIRE(statistics.sent==4);
+        REQUIRE(statistics.replies==2);
+        REQUIRE(statistics.timeouts==1);
+        REQUIRE(statistics.late==1);
+        REQUIRE(statistics.duplicates==2);
+        REQUIRE(statistics.inFlight==1);
+
+        // the first bucket holds replies under a millisecond, the last holds everything above the final bound.
+
+        REQUIRE(statistics.latencyHistogram[0]==1);
+        REQUIRE(statistics.latencyHistogram[Nedrysoft::RouteAnalyser::LatencyBucketCount-1]==1);
+
+        // a snapshot is a copy, later events do not change it.
+
+        recorder.recordSent();
+
+        REQUIRE(statistics.sent==4);
+        REQUIRE(recorder.statistics().sent==5);
+        REQUIRE(recorder.statistics().inFlight==2);
+
+        recorder.recordCancelled(2);
+
+        REQUIRE(recorder.statistics().inFlight==0);
+    }
+
+    SECTION("check transmit lag") {
+        recorder.recordTransmitLag(-50);
+        recorder.recordTransmitLag(100);
+        recorder.recordTransmitLag(350);
+
+        auto statistics = recorder.statistics();
+
+        // a probe sent ahead of its schedule counts as no lag.
+
+        REQUIRE(statistics.averageTransmitLag==150);
+        REQUIRE(statistics.maximumTransmitLag==350);
+    }
+
+    SECTION("check reset") {
+        recorder.recordSent();
+        recorder.recordSent();
+        recorder.recordReply(0.002);
+        recorder.recordTransmitLag(1000);
+
+        recorder.reset();
+
+        auto statistics = recorder.statistics();
+
+        REQUIRE(statistics.sent==0);
+        REQUIRE(statistics.replies==0);
+        REQUIRE(statistics.maximumTransmitLag==0);
+        REQUIRE(statistics.averageTransmitLag==0);
+        REQUIRE(statistics.latencyHistogram[2]==0);
+
+        // the probe that is still outstanding is not forgotten by a reset.
+
+        REQUIRE(statistics.inFlight==1);
+    }
+}
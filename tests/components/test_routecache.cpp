@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Adrian Carpenter
+ *
+ * This file is part of Pingnoo (https://github.com/nedrysoft/pingnoo)
+ *
+ * An open-source cross-platform traceroute analyser.
+ *
+ * Created by Adrian Carpenter on 16/10/2026.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "RouteEngine/RouteCache.h"
+
+#include <QHostAddress>
+
+constexpr auto MaximumRoutes = 256;
+
+auto testAddress(int index) -> QHostAddress {
+    return QHostAddress(QString("10.0.%1.%2").arg(index / 256).arg(index % 256));
+}
+
+TEST_CASE("RouteCache Tests", "[app][components]") {
+    // the cache is given its own clock, so the expiry of a route can be tested without waiting for it.
+
+    qint64 currentTime = 0;
+
+    Nedrysoft::RouteEngine::RouteCache routeCache(300, [&currentTime]() {
+        return currentTime;
+    });
+
+    Nedrysoft::RouteAnalyser::RouteList route;
+
+    SECTION("check time to live expiry") {
+        routeCache.setTimeToLive(1);
+
+        routeCache.insert(testAddress(1), Nedrysoft::Core::IPVersion::V4, {testAddress(0), testAddress(1)});
+
+        REQUIRE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V4, route));
+        REQUIRE(route.count()==2);
+        REQUIRE(route.last()==testAddress(1));
+
+        REQUIRE_FALSE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V6, route));
+
+        currentTime += 999;
+
+        REQUIRE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V4, route));
+
+        currentTime += 1;
+
+        REQUIRE_FALSE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V4, route));
+
+        // a time to live of 0 disables the cache.
+
+        routeCache.setTimeToLive(0);
+
+        routeCache.insert(testAddress(1), Nedrysoft::Core::IPVersion::V4, {testAddress(1)});
+
+        REQUIRE_FALSE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V4, route));
+    }
+
+    SECTION("check eviction of the least recently used route") {
+
+        for (auto routeIndex = 0; routeIndex < MaximumRoutes; routeIndex++) {
+            routeCache.insert(testAddress(routeIndex), Nedrysoft::Core::IPVersion::V4, {testAddress(routeIndex)});
+        }
+
+        // replacing a route that is already cached does not evict anything.
+
+        routeCache.insert(testAddress(1), Nedrysoft::Core::IPVersion::V4, {testAddress(1)});
+
+        for (auto routeIndex = 0; routeIndex < MaximumRoutes; routeIndex++) {
+            REQUIRE(routeCache.lookup(testAddress(routeIndex), Nedrysoft::Core::IPVersion::V4, route));
+        }
+
+        // the lookups above used the routes in order, so once the first has been used again the second is the
+        // least recently used.
+
+        REQUIRE(routeCache.lookup(testAddress(0), Nedrysoft::Core::IPVersion::V4, route));
+
+        routeCache.insert(testAddress(MaximumRoutes), Nedrysoft::Core::IPVersion::V4, {testAddress(MaximumRoutes)});
+
+        REQUIRE(routeCache.lookup(testAddress(0), Nedrysoft::Core::IPVersion::V4, route));
+        REQUIRE_FALSE(routeCache.lookup(testAddress(1), Nedrysoft::Core::IPVersion::V4, route));
+        REQUIRE(routeCache.lookup(testAddress(2), Nedrysoft::Core::IPVersion::V4, route));
+        REQUIRE(routeCache.lookup(testAddress(MaximumRoutes), Nedrysoft::Core::IPVersion::V4, route));
+
+        routeCache.remove(testAddress(2), Nedrysoft::Core::IPVersion::V4);
+
+        REQUIRE_FALSE(routeCache.lookup(testAddress(2), Nedrysoft::Core::IPVersion::V4, route));
+
+        routeCache.clear();
+    }
+}
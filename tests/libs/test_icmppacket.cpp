@@ -24,8 +24,74 @@
 #include "catch.hpp"
 #include "ICMPPacket/ICMPPacket.h"
 
-#include <QString>
+#include <QDataStream>
 #include <QHostAddress>
+#include <QRandomGenerator>
+#include <QString>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief       The original QDataStream based checksum, kept to verify and benchmark the current implementation.
+ */
+static auto legacyChecksum(void *buffer, int length) -> uint16_t {
+    QByteArray dataArray(reinterpret_cast<char *>(buffer), length);
+    QDataStream dataStream(dataArray);
+    uint32_t checksum = 0;
+
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    while (!dataStream.atEnd()) {
+        uint16_t data;
+
+        dataStream >> data;
+
+        checksum += data;
+    }
+
+    checksum = ( checksum >> ( sizeof(uint16_t) * CHAR_BIT )) + ( checksum & UINT16_MAX );
+    checksum += ( checksum >> ( sizeof(uint16_t) * CHAR_BIT ));
+
+    return static_cast<uint16_t>(~checksum);
+}
+
+/**
+ * @brief       Builds an IPv4 echo reply as delivered by a raw socket (IP header followed by the ICMP message).
+ */
+static auto echoReplyV4(uint16_t id, uint16_t sequence, uint8_t ttl) -> std::vector<uint8_t> {
+    std::vector<uint8_t> packet(20 + 8 + 52, 0);
+
+    packet[0] = 0x45;
+    packet[8] = ttl;
+    packet[20] = 0;
+    packet[24] = static_cast<uint8_t>(id >> 8);
+    packet[25] = static_cast<uint8_t>(id);
+    packet[26] = static_cast<uint8_t>(sequence >> 8);
+    packet[27] = static_cast<uint8_t>(sequence);
+
+    return packet;
+}
+
+/**
+ * @brief       Builds an IPv4 time exceeded message quoting an echo request.
+ */
+static auto timeExceededV4(uint16_t id, uint16_t sequence) -> std::vector<uint8_t> {
+    std::vector<uint8_t> packet(20 + 8 + 20 + 8, 0);
+
+    packet[0] = 0x45;
+    packet[8] = 250;
+    packet[20] = 11;
+    packet[28] = 0x45;
+    packet[48] = 8;
+    packet[52] = static_cast<uint8_t>(id >> 8);
+    packet[53] = static_cast<uint8_t>(id);
+    packet[54] = static_cast<uint8_t>(sequence >> 8);
+    packet[55] = static_cast<uint8_t>(sequence);
+
+    return packet;
+}
 
 TEST_CASE("ICMPPacket Tests", "[app][libs][network]") {
     QByteArray testData = QString("This Is A Test Of The ICMP Checksum Routine").toLatin1();
@@ -35,4 +101,208 @@ TEST_CASE("ICMPPacket Tests", "[app][libs][network]") {
 
         REQUIRE_MESSAGE(checksum==0x38D1, "ICMP checksum was calculated incorrectly.");
     }
+
+    SECTION("checksum matches the original implementation") {
+        std::vector<uint8_t> buffer(1500);
+
+        for (auto &byte : buffer) {
+            byte = static_cast<uint8_t>(QRandomGenerator::global()->bounded(256));
+        }
+
+        for (auto length = 0; length <= static_cast<int>(buffer.size()); length += 7) {
+            REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::checksum(buffer.data(), length) ==
+                    legacyChecksum(buffer.data(), length));
+        }
+    }
+
+    SECTION("incremental checksum update matches a full recalculation") {
+        auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+            0x1234,
+            1,
+            52,
+            QHostAddress(QHostAddress::LocalHost),
+            Nedrysoft::ICMPPacket::V4
+        );
+
+        auto data = reinterpret_cast<uint8_t *>(packet.data());
+
+        for (uint32_t sequence = 2; sequence < 0x10000; sequence += 251) {
+            uint16_t storedChecksum, oldSequence, newSequence = qToBigEndian<uint16_t>(sequence);
+
+            memcpy(&storedChecksum, data + 2, sizeof(storedChecksum));
+            memcpy(&oldSequence, data + 6, sizeof(oldSequence));
+            memcpy(data + 6, &newSequence, sizeof(newSequence));
+
+            auto updatedChecksum = Nedrysoft::ICMPPacket::ICMPPacket::updateChecksum(
+                storedChecksum,
+                oldSequence,
+                newSequence
+            );
+
+            memcpy(data + 2, &updatedChecksum, sizeof(updatedChecksum));
+
+            REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::checksum(data, packet.length()) == 0);
+        }
+    }
+
+    SECTION("updateEchoRequest produces the same packet as pingPacket") {
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(0, 0, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest(packet.data(), packet.length(), 0xbeef, 0x1234));
+
+        auto expectedPacket = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+            0xbeef,
+            0x1234,
+            52,
+            localHost,
+            Nedrysoft::ICMPPacket::V4
+        );
+
+        REQUIRE(packet.length()==expectedPacket.length());
+        REQUIRE(memcmp(packet.constData(), expectedPacket.constData(), packet.length())==0);
+    }
+
+    SECTION("updateEchoRequest stores a payload tag that is returned by payloadTag") {
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(0, 0, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::updateEchoRequest(
+            packet.data(),
+            packet.length(),
+            0xbeef,
+            0x1234,
+            0xa55a
+        ));
+
+        REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::checksum(packet.data(), packet.length())==0);
+
+        auto reply = echoReplyV4(0xbeef, 0x1234, 57);
+
+        memcpy(reply.data() + 28, packet.constData() + 8, 52);
+
+        auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(reply, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::payloadTag(reply.data(), result)==0xa55a);
+
+        auto truncatedReply = timeExceededV4(0xbeef, 0x1234);
+
+        result = Nedrysoft::ICMPPacket::ICMPPacket::parse(truncatedReply, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(Nedrysoft::ICMPPacket::ICMPPacket::payloadTag(truncatedReply.data(), result)==-1);
+    }
+}
+
+TEST_CASE("ICMPPacket Parser Tests", "[app][libs][network]") {
+    SECTION("parse decodes an IPv4 echo reply") {
+        auto packet = echoReplyV4(0x1234, 0x5678, 57);
+
+        auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(packet, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(result.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+        REQUIRE(result.id==0x1234);
+        REQUIRE(result.sequence==0x5678);
+        REQUIRE(result.ttl==57);
+        REQUIRE(result.payloadOffset==28);
+        REQUIRE(result.payloadLength==52);
+    }
+
+    SECTION("parse decodes an IPv4 echo reply without an IP header") {
+        auto packet = echoReplyV4(0x1234, 0x5678, 57);
+
+        auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+            gsl::span<const uint8_t>(packet).subspan(20),
+            Nedrysoft::ICMPPacket::V4
+        );
+
+        REQUIRE(result.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+        REQUIRE(result.id==0x1234);
+        REQUIRE(result.sequence==0x5678);
+        REQUIRE(result.ttl==-1);
+    }
+
+    SECTION("parse decodes an IPv4 time exceeded message") {
+        auto packet = timeExceededV4(0xabcd, 0x0102);
+
+        auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(packet, Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(result.resultCode==Nedrysoft::ICMPPacket::TimeExceeded);
+        REQUIRE(result.id==0xabcd);
+        REQUIRE(result.sequence==0x0102);
+    }
+
+    SECTION("parse rejects every truncation of a packet") {
+        auto packet = timeExceededV4(0xabcd, 0x0102);
+
+        for (auto length = 0; length < static_cast<int>(packet.size()); length++) {
+            auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(packet.data(), length, Nedrysoft::ICMPPacket::V4);
+
+            REQUIRE(result.resultCode==Nedrysoft::ICMPPacket::Invalid);
+        }
+    }
+
+    SECTION("parse decodes an IPv6 echo reply") {
+        std::vector<uint8_t> packet = {129, 0, 0, 0, 0x12, 0x34, 0x56, 0x78};
+
+        auto result = Nedrysoft::ICMPPacket::ICMPPacket::parse(packet, Nedrysoft::ICMPPacket::V6);
+
+        REQUIRE(result.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+        REQUIRE(result.id==0x1234);
+        REQUIRE(result.sequence==0x5678);
+    }
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE("ICMPPacket Checksum Benchmarks", "[!benchmark][libs][network]") {
+    auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+        0x1234,
+        1,
+        52,
+        QHostAddress(QHostAddress::LocalHost),
+        Nedrysoft::ICMPPacket::V4
+    );
+
+    std::vector<uint8_t> largeBuffer(1500, 0xa5);
+
+    BENCHMARK("legacy checksum (echo request)") {
+        return legacyChecksum(packet.data(), packet.length());
+    };
+
+    BENCHMARK("checksum (echo request)") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::checksum(packet.data(), packet.length());
+    };
+
+    BENCHMARK("legacy checksum (1500 bytes)") {
+        return legacyChecksum(largeBuffer.data(), static_cast<int>(largeBuffer.size()));
+    };
+
+    BENCHMARK("checksum (1500 bytes)") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::checksum(largeBuffer.data(), static_cast<int>(largeBuffer.size()));
+    };
+
+    BENCHMARK("incremental checksum update") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::updateChecksum(0x1234, 0x0100, 0x0200);
+    };
+}
+
+TEST_CASE("ICMPPacket Parser Benchmarks", "[!benchmark][libs][network]") {
+    auto echoReply = echoReplyV4(0x1234, 0x5678, 57);
+    auto timeExceeded = timeExceededV4(0xabcd, 0x0102);
+
+    auto echoReplyBuffer = QByteArray(reinterpret_cast<const char *>(echoReply.data()), echoReply.size());
+
+    BENCHMARK("parse echo reply") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::parse(echoReply, Nedrysoft::ICMPPacket::V4);
+    };
+
+    BENCHMARK("parse time exceeded") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::parse(timeExceeded, Nedrysoft::ICMPPacket::V4);
+    };
+
+    BENCHMARK("fromData echo reply") {
+        return Nedrysoft::ICMPPacket::ICMPPacket::fromData(echoReplyBuffer, Nedrysoft::ICMPPacket::V4).id();
+    };
 }
+#endif
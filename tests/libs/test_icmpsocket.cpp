@@ -22,9 +22,13 @@
  */
 
 #include "catch.hpp"
+#include "ICMPPacket/ICMPPacket.h"
+#include "ICMPSocket/ICMPReceiveBatch.h"
+#include "ICMPSocket/ICMPRing.h"
 #include "ICMPSocket/ICMPSocket.h"
 
 #include <QString>
+#include <vector>
 
 TEST_CASE("ICMPSocket Tests", "[app][libs][network]") {
     Nedrysoft::ICMPSocket::ICMPSocket *readSocket;
@@ -41,4 +45,171 @@ TEST_CASE("ICMPSocket Tests", "[app][libs][network]") {
 
         REQUIRE_MESSAGE(writeSocket!=nullptr, "Unable to create a IPv4 ICMP write socket.");
     }
+
+    SECTION("check IPv4 batched send") {
+        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(0, Nedrysoft::ICMPSocket::V4);
+
+        REQUIRE_MESSAGE(writeSocket!=nullptr, "Unable to create a IPv4 ICMP write socket.");
+
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        auto firstPacket = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(1, 1, 52, localHost, Nedrysoft::ICMPPacket::V4);
+        auto secondPacket = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(1, 2, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> messages = {
+            {firstPacket.constData(), firstPacket.length(), localHost, 0, -1},
+            {secondPacket.constData(), secondPacket.length(), localHost, 0, -1}
+        };
+
+        REQUIRE_MESSAGE(writeSocket->sendBatch(messages)==2, "Unable to send a batch of ICMP packets.");
+
+        REQUIRE(messages[0].result==firstPacket.length());
+        REQUIRE(messages[1].result==secondPacket.length());
+
+        delete writeSocket;
+    }
+
+#if defined(Q_OS_LINUX)
+    SECTION("check IPv4 identifier filter") {
+        readSocket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
+        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(0, Nedrysoft::ICMPSocket::V4);
+
+        REQUIRE_MESSAGE(readSocket->setIdentifierFilter({0x1234}), "Unable to attach an identifier filter.");
+
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        auto matchedPacket = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+                0x1234, 1, 52, localHost, Nedrysoft::ICMPPacket::V4);
+        auto filteredPacket = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+                0x4321, 1, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> messages = {
+            {filteredPacket.constData(), filteredPacket.length(), localHost, 0, -1},
+            {matchedPacket.constData(), matchedPacket.length(), localHost, 0, -1}
+        };
+
+        REQUIRE(writeSocket->sendBatch(messages)==2);
+
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch receiveBatch;
+
+        // only the echo reply to the matched request should pass the filter, the echo requests seen on the
+        // loopback interface and the reply to the filtered request are discarded by the kernel.
+
+        REQUIRE(readSocket->recvBatch(receiveBatch, 1000)==1);
+
+        auto parseResult = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+                receiveBatch.data(0), receiveBatch.length(0), Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(parseResult.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+        REQUIRE(parseResult.id==0x1234);
+
+        delete readSocket;
+        delete writeSocket;
+    }
+
+    SECTION("check IPv4 datagram socket") {
+        if (!Nedrysoft::ICMPSocket::ICMPSocket::isDatagramAvailable()) {
+            WARN("Datagram ICMP sockets are not permitted by net.ipv4.ping_group_range.");
+
+            return;
+        }
+
+        auto datagramSocket = Nedrysoft::ICMPSocket::ICMPSocket::createDatagramSocket(Nedrysoft::ICMPSocket::V4);
+
+        REQUIRE_MESSAGE(datagramSocket!=nullptr, "Unable to create a IPv4 ICMP datagram socket.");
+
+        auto identifier = datagramSocket->identifier();
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        REQUIRE(identifier!=0);
+
+        auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(
+                identifier, 1, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> messages = {
+            {packet.constData(), packet.length(), localHost, 0, -1}
+        };
+
+        REQUIRE(datagramSocket->sendBatch(messages)==1);
+
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch receiveBatch;
+
+        // the kernel delivers the reply without an ip header, only to the socket that owns the identifier.
+
+        REQUIRE(datagramSocket->recvBatch(receiveBatch, 1000)==1);
+
+        auto parseResult = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+                receiveBatch.data(0), receiveBatch.length(0), Nedrysoft::ICMPPacket::V4);
+
+        REQUIRE(parseResult.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+        REQUIRE(parseResult.id==identifier);
+
+        delete datagramSocket;
+    }
+
+    SECTION("check IPv4 io_uring send and receive") {
+        auto ring = Nedrysoft::ICMPSocket::ICMPRing::create();
+
+        if (!ring) {
+            WARN("io_uring is not available.");
+
+            return;
+        }
+
+        readSocket = Nedrysoft::ICMPSocket::ICMPSocket::createReadSocket(Nedrysoft::ICMPSocket::V4);
+        writeSocket = Nedrysoft::ICMPSocket::ICMPSocket::createWriteSocket(0, Nedrysoft::ICMPSocket::V4);
+
+        REQUIRE_MESSAGE(readSocket!=nullptr, "Unable to create a IPv4 ICMP read socket.");
+        REQUIRE_MESSAGE(writeSocket!=nullptr, "Unable to create a IPv4 ICMP write socket.");
+
+        REQUIRE(readSocket->setIdentifierFilter({0x2468}));
+        REQUIRE(ring->addReceiver(readSocket));
+
+        auto localHost = QHostAddress(QHostAddress::LocalHost);
+
+        auto packet = Nedrysoft::ICMPPacket::ICMPPacket::pingPacket(0x2468, 1, 52, localHost, Nedrysoft::ICMPPacket::V4);
+
+        Nedrysoft::ICMPSocket::ICMPMessage message = {packet.constData(), packet.length(), localHost, 0, -1};
+
+        REQUIRE(ring->queueSend(writeSocket, message));
+        REQUIRE(ring->queueTimeout(1, 50));
+
+        Nedrysoft::ICMPSocket::ICMPReceiveBatch receiveBatch;
+        std::vector<uint64_t> expiredKeys;
+        auto replyCount = 0;
+        auto expired = false;
+
+        // the reply and the expired timeout arrive from separate waits.
+
+        for (auto attempt = 0; (attempt < 10) && ((!replyCount) || (!expired)); attempt++) {
+            auto result = ring->wait(receiveBatch, expiredKeys, 100);
+
+            for (auto packetIndex = 0; packetIndex < result; packetIndex++) {
+                auto parseResult = Nedrysoft::ICMPPacket::ICMPPacket::parse(
+                        receiveBatch.data(packetIndex), receiveBatch.length(packetIndex), Nedrysoft::ICMPPacket::V4);
+
+                REQUIRE(parseResult.resultCode==Nedrysoft::ICMPPacket::EchoReply);
+                REQUIRE(parseResult.id==0x2468);
+
+                replyCount++;
+            }
+
+            expired = expired || ((expiredKeys.size()==1) && (expiredKeys[0]==1));
+        }
+
+        std::vector<Nedrysoft::ICMPSocket::ICMPMessage> failedSends;
+
+        ring->takeFailedSends(failedSends);
+
+        REQUIRE(failedSends.empty());
+        REQUIRE(replyCount==1);
+        REQUIRE(expired);
+
+        ring->removeReceiver(readSocket);
+
+        delete ring;
+        delete readSocket;
+        delete writeSocket;
+    }
+#endif
 }